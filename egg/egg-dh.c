@@ -34,6 +34,7 @@ EGG_SECURE_DECLARE (dh);
 typedef struct _DHGroup {
 	const gchar *name;
 	guint bits;
+	guint exponent_bits;
 	const guchar *prime;
 	gsize n_prime;
 	const guchar base[1];
@@ -173,37 +174,37 @@ static const guchar dh_group_8192_prime[] = {
 
 static const DHGroup dh_groups[] = {
 	{
-		"ietf-ike-grp-modp-768", 768,
+		"ietf-ike-grp-modp-768", 768, 160,
 		dh_group_768_prime, G_N_ELEMENTS (dh_group_768_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-1024", 1024,
+		"ietf-ike-grp-modp-1024", 1024, 160,
 		dh_group_1024_prime, G_N_ELEMENTS (dh_group_1024_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-1536", 1536,
+		"ietf-ike-grp-modp-1536", 1536, 224,
 		dh_group_1536_prime, G_N_ELEMENTS (dh_group_1536_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-2048", 2048,
+		"ietf-ike-grp-modp-2048", 2048, 224,
 		dh_group_2048_prime, G_N_ELEMENTS (dh_group_2048_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-3072", 3072,
+		"ietf-ike-grp-modp-3072", 3072, 256,
 		dh_group_3072_prime, G_N_ELEMENTS (dh_group_3072_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-4096", 4096,
+		"ietf-ike-grp-modp-4096", 4096, 304,
 		dh_group_4096_prime, G_N_ELEMENTS (dh_group_4096_prime),
 		{ 0x02 }, 1
 	},
 	{
-		"ietf-ike-grp-modp-8192", 8192,
+		"ietf-ike-grp-modp-8192", 8192, 400,
 		dh_group_8192_prime, G_N_ELEMENTS (dh_group_8192_prime),
 		{ 0x02 }, 1
 	},
@@ -237,42 +238,97 @@ egg_dh_default_params_raw (const gchar *name, gconstpointer *prime,
 	return FALSE;
 }
 
-gboolean
-egg_dh_default_params (const gchar *name, gcry_mpi_t *prime, gcry_mpi_t *base)
+/* Number of ephemeral key pairs kept ready per group */
+#define DH_POOL_SIZE 4
+
+typedef struct {
+	gcry_mpi_t pub;
+	gcry_mpi_t priv;
+} DHPair;
+
+typedef struct {
+	/* Parsed once, never change afterwards */
+	gcry_mpi_t prime;
+	gcry_mpi_t base;
+
+	/* Protected by dh_cache lock */
+	GQueue pairs;
+	guint pair_bits;
+	gboolean filling;
+} DHCache;
+
+G_LOCK_DEFINE_STATIC (dh_cache);
+static DHCache dh_cache[G_N_ELEMENTS (dh_groups)];
+static GThreadPool *dh_pool_threads = NULL;
+
+static DHCache *
+lookup_cache (const gchar *name)
 {
 	const DHGroup *group;
+	DHCache *cache;
+	gcry_mpi_t prime, base;
 	gcry_error_t gcry;
 
-	g_return_val_if_fail (name, FALSE);
-
 	for (group = dh_groups; group->name; ++group) {
-		if (g_str_equal (group->name, name)) {
-			if (prime) {
-				gcry = gcry_mpi_scan (prime, GCRYMPI_FMT_USG, group->prime, group->n_prime, NULL);
-				g_return_val_if_fail (gcry == 0, FALSE);
-				g_return_val_if_fail (gcry_mpi_get_nbits (*prime) == group->bits, FALSE);
-			}
-			if (base) {
-				gcry = gcry_mpi_scan (base, GCRYMPI_FMT_USG, group->base, group->n_base, NULL);
-				g_return_val_if_fail (gcry == 0, FALSE);
-			}
-			return TRUE;
-		}
+		if (g_str_equal (group->name, name))
+			break;
 	}
 
-	return FALSE;
+	if (!group->name)
+		return NULL;
+
+	cache = &dh_cache[group - dh_groups];
+
+	G_LOCK (dh_cache);
+	prime = cache->prime;
+	G_UNLOCK (dh_cache);
+
+	if (prime != NULL)
+		return cache;
+
+	gcry = gcry_mpi_scan (&prime, GCRYMPI_FMT_USG, group->prime, group->n_prime, NULL);
+	g_return_val_if_fail (gcry == 0, NULL);
+	g_return_val_if_fail (gcry_mpi_get_nbits (prime) == group->bits, NULL);
+	gcry = gcry_mpi_scan (&base, GCRYMPI_FMT_USG, group->base, group->n_base, NULL);
+	g_return_val_if_fail (gcry == 0, NULL);
+
+	/* Another thread may have beaten us to it */
+	G_LOCK (dh_cache);
+	if (cache->prime == NULL) {
+		cache->prime = prime;
+		cache->base = base;
+		prime = base = NULL;
+	}
+	G_UNLOCK (dh_cache);
+
+	gcry_mpi_release (prime);
+	gcry_mpi_release (base);
+
+	return cache;
 }
 
 gboolean
-egg_dh_gen_pair (gcry_mpi_t prime, gcry_mpi_t base, guint bits,
-                 gcry_mpi_t *pub, gcry_mpi_t *priv)
+egg_dh_default_params (const gchar *name, gcry_mpi_t *prime, gcry_mpi_t *base)
 {
-	guint pbits;
+	DHCache *cache;
 
-	g_return_val_if_fail (prime, FALSE);
-	g_return_val_if_fail (base, FALSE);
-	g_return_val_if_fail (pub, FALSE);
-	g_return_val_if_fail (priv, FALSE);
+	g_return_val_if_fail (name, FALSE);
+
+	cache = lookup_cache (name);
+	if (cache == NULL)
+		return FALSE;
+
+	if (prime)
+		*prime = gcry_mpi_copy (cache->prime);
+	if (base)
+		*base = gcry_mpi_copy (cache->base);
+	return TRUE;
+}
+
+static gboolean
+gen_private (gcry_mpi_t prime, guint bits, gcry_mpi_t *priv)
+{
+	guint pbits;
 
 	pbits = gcry_mpi_get_nbits (prime);
 	g_return_val_if_fail (pbits > 1, FALSE);
@@ -301,6 +357,151 @@ egg_dh_gen_pair (gcry_mpi_t prime, gcry_mpi_t base, guint bits,
 		gcry_mpi_clear_highbit (*priv, pbits - 1);
 	g_assert (gcry_mpi_cmp (prime, *priv) > 0);
 
+	return TRUE;
+}
+
+static gboolean
+gen_cached_pair (DHCache *cache, guint bits,
+                 gcry_mpi_t *pub, gcry_mpi_t *priv)
+{
+	if (!gen_private (cache->prime, bits, priv))
+		return FALSE;
+
+	/* Only the parsing of the group parameters is cached */
+	*pub = gcry_mpi_new (gcry_mpi_get_nbits (cache->prime));
+	g_return_val_if_fail (*pub, FALSE);
+	gcry_mpi_powm (*pub, cache->base, *priv, cache->prime);
+
+	return TRUE;
+}
+
+static void
+pair_free (gpointer data)
+{
+	DHPair *pair = data;
+	gcry_mpi_release (pair->pub);
+	gcry_mpi_release (pair->priv);
+	g_slice_free (DHPair, pair);
+}
+
+static void
+pool_fill_thread (gpointer data,
+                  gpointer unused)
+{
+	DHCache *cache = data;
+	DHPair *pair;
+	gboolean failed;
+	gboolean full;
+	guint bits;
+
+	G_LOCK (dh_cache);
+	bits = cache->pair_bits;
+	G_UNLOCK (dh_cache);
+
+	for (;;) {
+		pair = g_slice_new0 (DHPair);
+		failed = !gen_cached_pair (cache, bits, &pair->pub, &pair->priv);
+		if (failed) {
+			g_slice_free (DHPair, pair);
+			pair = NULL;
+		}
+
+		G_LOCK (dh_cache);
+		if (pair != NULL && cache->pair_bits == bits) {
+			g_queue_push_tail (&cache->pairs, pair);
+			pair = NULL;
+		}
+		full = (failed || cache->pair_bits != bits || cache->pairs.length >= DH_POOL_SIZE);
+		if (full)
+			cache->filling = FALSE;
+		G_UNLOCK (dh_cache);
+
+		/* Generated with different settings than now wanted */
+		if (pair != NULL)
+			pair_free (pair);
+
+		if (full)
+			break;
+	}
+}
+
+gboolean
+egg_dh_pool_take_pair (const gchar *name, guint bits,
+                       gcry_mpi_t *pub, gcry_mpi_t *priv)
+{
+	DHCache *cache;
+	DHPair *pair;
+	GQueue stale = G_QUEUE_INIT;
+	gboolean fill = FALSE;
+
+	g_return_val_if_fail (name, FALSE);
+	g_return_val_if_fail (pub, FALSE);
+	g_return_val_if_fail (priv, FALSE);
+
+	cache = lookup_cache (name);
+	if (cache == NULL)
+		return FALSE;
+
+	G_LOCK (dh_cache);
+	if (cache->pair_bits != bits) {
+		stale = cache->pairs;
+		g_queue_init (&cache->pairs);
+		cache->pair_bits = bits;
+	}
+	pair = g_queue_pop_head (&cache->pairs);
+	if (!cache->filling) {
+		cache->filling = fill = TRUE;
+		if (dh_pool_threads == NULL)
+			dh_pool_threads = g_thread_pool_new (pool_fill_thread, NULL, 1, FALSE, NULL);
+	}
+	G_UNLOCK (dh_cache);
+
+	g_queue_foreach (&stale, (GFunc)pair_free, NULL);
+	g_queue_clear (&stale);
+
+	/* Refill in the background, each pair is only ever handed out once */
+	if (fill)
+		g_thread_pool_push (dh_pool_threads, cache, NULL);
+
+	if (pair != NULL) {
+		*pub = pair->pub;
+		*priv = pair->priv;
+		g_slice_free (DHPair, pair);
+		return TRUE;
+	}
+
+	/* Pool was empty, generate one on this thread */
+	return gen_cached_pair (cache, bits, pub, priv);
+}
+
+guint
+egg_dh_short_exponent_bits (const gchar *name)
+{
+	const DHGroup *group;
+
+	g_return_val_if_fail (name, 0);
+
+	/* Twice the security level of the group, see RFC 3526 */
+	for (group = dh_groups; group->name; ++group) {
+		if (g_str_equal (group->name, name))
+			return group->exponent_bits;
+	}
+
+	return 0;
+}
+
+gboolean
+egg_dh_gen_pair (gcry_mpi_t prime, gcry_mpi_t base, guint bits,
+                 gcry_mpi_t *pub, gcry_mpi_t *priv)
+{
+	g_return_val_if_fail (prime, FALSE);
+	g_return_val_if_fail (base, FALSE);
+	g_return_val_if_fail (pub, FALSE);
+	g_return_val_if_fail (priv, FALSE);
+
+	if (!gen_private (prime, bits, priv))
+		return FALSE;
+
 	*pub = gcry_mpi_new (gcry_mpi_get_nbits (*priv));
 	g_return_val_if_fail (*pub, FALSE);
 	gcry_mpi_powm (*pub, base, *priv, prime);
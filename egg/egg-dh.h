@@ -44,6 +44,13 @@ gboolean   egg_dh_gen_pair                                    (gcry_mpi_t prime,
                                                                gcry_mpi_t *pub,
                                                                gcry_mpi_t *priv);
 
+gboolean   egg_dh_pool_take_pair                              (const gchar *name,
+                                                               guint bits,
+                                                               gcry_mpi_t *pub,
+                                                               gcry_mpi_t *priv);
+
+guint      egg_dh_short_exponent_bits                         (const gchar *name);
+
 gpointer   egg_dh_gen_secret                                  (gcry_mpi_t peer,
                                                                gcry_mpi_t priv,
                                                                gcry_mpi_t prime,
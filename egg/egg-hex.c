@@ -27,9 +27,105 @@
 
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 static const char HEXC_UPPER[] = "0123456789ABCDEF";
 static const char HEXC_LOWER[] = "0123456789abcdef";
 
+/* Value of each hex digit, or -1 for anything else */
+static const gint8 HEXV[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+#ifdef __SSE2__
+
+/*
+ * Decode 32 hex characters into 16 bytes. Returns FALSE if any of
+ * the characters is not a hex digit.
+ */
+static gboolean
+decode_block_sse2 (const gchar *data,
+                   guchar *decoded)
+{
+	const __m128i zero = _mm_set1_epi8 ('0');
+	const __m128i nine = _mm_set1_epi8 (9);
+	const __m128i lower = _mm_set1_epi8 (0x20);
+	const __m128i alpha = _mm_set1_epi8 ('a');
+	const __m128i five = _mm_set1_epi8 (5);
+	const __m128i ten = _mm_set1_epi8 (10);
+	const __m128i low_byte = _mm_set1_epi16 (0x00FF);
+	__m128i chars, digit, letter, is_digit, is_letter;
+	__m128i values[2];
+	gint i;
+
+	for (i = 0; i < 2; i++) {
+		chars = _mm_loadu_si128 ((const __m128i *)(data + i * 16));
+
+		/* Unsigned range checks: '0'..'9' and 'a'..'f' after folding case */
+		digit = _mm_sub_epi8 (chars, zero);
+		is_digit = _mm_cmpeq_epi8 (_mm_min_epu8 (digit, nine), digit);
+		letter = _mm_sub_epi8 (_mm_or_si128 (chars, lower), alpha);
+		is_letter = _mm_cmpeq_epi8 (_mm_min_epu8 (letter, five), letter);
+
+		if (_mm_movemask_epi8 (_mm_or_si128 (is_digit, is_letter)) != 0xFFFF)
+			return FALSE;
+
+		values[i] = _mm_or_si128 (_mm_and_si128 (is_digit, digit),
+		                          _mm_and_si128 (is_letter, _mm_add_epi8 (letter, ten)));
+
+		/* Each 16-bit lane holds the high nibble, then the low nibble */
+		values[i] = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (values[i], low_byte), 4),
+		                          _mm_srli_epi16 (values[i], 8));
+	}
+
+	_mm_storeu_si128 ((__m128i *)decoded, _mm_packus_epi16 (values[0], values[1]));
+	return TRUE;
+}
+
+/* Encode 16 bytes into 32 hex characters */
+static void
+encode_block_sse2 (const guchar *input,
+                   gchar *encoded,
+                   gboolean upper_case)
+{
+	const __m128i mask = _mm_set1_epi8 (0x0F);
+	const __m128i zero = _mm_set1_epi8 ('0');
+	const __m128i nine = _mm_set1_epi8 (9);
+	const __m128i letters = _mm_set1_epi8 ((upper_case ? 'A' : 'a') - '0' - 10);
+	__m128i bytes, high, low;
+
+	bytes = _mm_loadu_si128 ((const __m128i *)input);
+	high = _mm_and_si128 (_mm_srli_epi16 (bytes, 4), mask);
+	low = _mm_and_si128 (bytes, mask);
+
+	high = _mm_add_epi8 (_mm_add_epi8 (high, zero),
+	                     _mm_and_si128 (_mm_cmpgt_epi8 (high, nine), letters));
+	low = _mm_add_epi8 (_mm_add_epi8 (low, zero),
+	                    _mm_and_si128 (_mm_cmpgt_epi8 (low, nine), letters));
+
+	_mm_storeu_si128 ((__m128i *)encoded, _mm_unpacklo_epi8 (high, low));
+	_mm_storeu_si128 ((__m128i *)(encoded + 16), _mm_unpackhi_epi8 (high, low));
+}
+
+#endif /* __SSE2__ */
+
 gpointer
 egg_hex_decode (const gchar *data, gssize n_data, gsize *n_decoded)
 {
@@ -46,10 +142,9 @@ egg_hex_decode_full (const gchar *data,
 	guchar *result;
 	guchar *decoded;
 	gsize n_delim;
-	gushort j;
+	gint8 j;
 	gint state = 0;
 	gint part = 0;
-	const gchar* pos;
 
 	g_return_val_if_fail (data || !n_data, NULL);
 	g_return_val_if_fail (n_decoded, NULL);
@@ -61,6 +156,23 @@ egg_hex_decode_full (const gchar *data,
 	decoded = result = g_malloc0 ((n_data / 2) + 1);
 	*n_decoded = 0;
 
+#ifdef __SSE2__
+	/* Without delimiters the groups make no difference, go in big blocks */
+	if (!delim) {
+		while (n_data >= 32) {
+			if (!decode_block_sse2 (data, decoded)) {
+				g_free (result);
+				return NULL;
+			}
+
+			data += 32;
+			n_data -= 32;
+			decoded += 16;
+			(*n_decoded) += 16;
+		}
+	}
+#endif
+
 	while (n_data > 0 && state == 0) {
 
 		if (decoded != result && delim) {
@@ -75,20 +187,18 @@ egg_hex_decode_full (const gchar *data,
 
 		while (part < group && n_data > 0) {
 
-			/* Find the position */
-			pos = strchr (HEXC_UPPER, g_ascii_toupper (*data));
-			if (pos == 0) {
-				if (n_data > 0)
-					state = -1;
+			/* Find the value */
+			j = HEXV[(guchar)*data];
+			if (j < 0) {
+				state = -1;
 				break;
 			}
 
-			j = pos - HEXC_UPPER;
 			if(!state) {
-				*decoded = (j & 0xf) << 4;
+				*decoded = j << 4;
 				state = 1;
 			} else {
-				*decoded |= (j & 0xf);
+				*decoded |= j;
 				(*n_decoded)++;
 				decoded++;
 				state = 0;
@@ -124,36 +234,55 @@ egg_hex_encode_full (gconstpointer data,
                      const gchar *delim,
                      guint group)
 {
-	GString *result;
-	const gchar *input;
+	const guchar *input;
 	const char *hexc;
+	gchar *result;
+	gchar *encoded;
+	gsize n_delim;
 	gsize bytes;
-	guchar j;
 
 	g_return_val_if_fail (data || !n_data, NULL);
 
 	input = data;
 	hexc = upper_case ? HEXC_UPPER : HEXC_LOWER;
 
-	result = g_string_sized_new (n_data * 2 + 1);
-	bytes = 0;
+	/* A delimiter goes between each group */
+	if (!delim || !group)
+		delim = NULL;
+	n_delim = delim ? strlen (delim) : 0;
 
-	while (n_data > 0) {
+	bytes = n_data * 2 + 1;
+	if (delim && n_data > 0)
+		bytes += ((n_data - 1) / group) * n_delim;
+	encoded = result = g_malloc (bytes);
+
+#ifdef __SSE2__
+	if (!delim) {
+		while (n_data >= 16) {
+			encode_block_sse2 (input, encoded, upper_case);
+			input += 16;
+			n_data -= 16;
+			encoded += 32;
+		}
+	}
+#endif
 
-		if (delim && group && bytes && (bytes % group) == 0)
-			g_string_append (result, delim);
+	bytes = 0;
+	while (n_data > 0) {
 
-		j = *(input) >> 4 & 0xf;
-		g_string_append_c (result, hexc[j]);
+		if (delim && bytes && (bytes % group) == 0) {
+			memcpy (encoded, delim, n_delim);
+			encoded += n_delim;
+		}
 
-		j = *(input++) & 0xf;
-		g_string_append_c (result, hexc[j]);
+		*(encoded++) = hexc[*input >> 4 & 0xf];
+		*(encoded++) = hexc[*(input++) & 0xf];
 
 		++bytes;
 		--n_data;
 	}
 
 	/* Make sure still null terminated */
-	return g_string_free (result, FALSE);
+	*encoded = '\0';
+	return result;
 }
-
@@ -30,81 +30,165 @@
 
 #include <string.h>
 
-gboolean
-egg_hkdf_perform (const gchar *hash_algo, gconstpointer input, gsize n_input,
-                  gconstpointer salt, gsize n_salt, gconstpointer info,
-                  gsize n_info, gpointer output, gsize n_output)
-{
-	gpointer alloc = NULL;
-	gpointer buffer = NULL;
-	gcry_md_hd_t md1, md2;
+struct _EggHkdfCtx {
+	gint algo;
 	guint hash_len;
-	gint i;
-	gint flags, algo;
+	gboolean secure;
+	gcry_md_hd_t extract;
+	gcry_md_hd_t expand;
+	gpointer buffer;
+	gpointer zeros;
+	gboolean have_key;
+};
+
+static void
+hkdf_expand (gcry_md_hd_t md, gint algo, guint hash_len, gpointer buffer,
+             gconstpointer info, gsize n_info, gpointer output, gsize n_output)
+{
 	gsize step, n_buffer;
 	guchar *at;
-	gcry_error_t gcry;
+	gint i;
+
+	n_buffer = 0;
+	at = output;
+	for (i = 1; i < 256; ++i) {
+		gcry_md_reset (md);
+		gcry_md_write (md, buffer, n_buffer);
+		gcry_md_write (md, info, n_info);
+		gcry_md_putc (md, i);
+
+		n_buffer = hash_len;
+		memcpy (buffer, gcry_md_read (md, algo), n_buffer);
+
+		step = MIN (n_buffer, n_output);
+		memcpy (at, buffer, step);
+		n_output -= step;
+		at += step;
+
+		if (!n_output)
+			break;
+	}
+}
+
+EggHkdfCtx *
+egg_hkdf_ctx_new (const gchar *hash_algo, gboolean secure)
+{
+	EggHkdfCtx *ctx;
+	guint hash_len;
+	gint flags;
+	gint algo;
 
 	algo = gcry_md_map_name (hash_algo);
-	g_return_val_if_fail (algo != 0, FALSE);
+	g_return_val_if_fail (algo != 0, NULL);
 
 	hash_len = gcry_md_get_algo_dlen (algo);
-	g_return_val_if_fail (hash_len != 0, FALSE);
-	g_return_val_if_fail (n_output <= 255 * hash_len, FALSE);
+	g_return_val_if_fail (hash_len != 0, NULL);
+
+	ctx = g_slice_new0 (EggHkdfCtx);
+	ctx->algo = algo;
+	ctx->hash_len = hash_len;
 
-	/* Buffer we need to for intermediate stuff */
-	if (gcry_is_secure (input)) {
+	/* Everything derived from the input key lives in secure memory */
+	ctx->secure = secure;
+	if (secure) {
 		flags = GCRY_MD_FLAG_SECURE;
-		buffer = gcry_malloc_secure (hash_len);
+		ctx->buffer = gcry_malloc_secure (ctx->hash_len);
 	} else {
 		flags = 0;
-		buffer = gcry_malloc (hash_len);
+		ctx->buffer = gcry_malloc (ctx->hash_len);
 	}
 
-	g_return_val_if_fail (buffer, FALSE);
-	n_buffer = 0;
+	ctx->zeros = g_malloc0 (ctx->hash_len);
+
+	/* Anything that fails from here on is freed along with the context */
+	if (ctx->buffer == NULL ||
+	    gcry_md_open (&ctx->extract, ctx->algo, GCRY_MD_FLAG_HMAC | flags) != 0 ||
+	    gcry_md_open (&ctx->expand, ctx->algo, GCRY_MD_FLAG_HMAC | flags) != 0) {
+		egg_hkdf_ctx_free (ctx);
+		g_return_val_if_reached (NULL);
+	}
+
+	return ctx;
+}
+
+gboolean
+egg_hkdf_ctx_extract (EggHkdfCtx *ctx, gconstpointer input, gsize n_input,
+                      gconstpointer salt, gsize n_salt)
+{
+	gcry_error_t gcry;
+
+	g_return_val_if_fail (ctx != NULL, FALSE);
+	g_return_val_if_fail (ctx->secure || !gcry_is_secure (input), FALSE);
 
 	/* Salt defaults to hash_len zeros */
 	if (!salt) {
-		salt = alloc = g_malloc0 (hash_len);
-		n_salt = hash_len;
+		salt = ctx->zeros;
+		n_salt = ctx->hash_len;
 	}
 
-	/* Step 1: Extract */
-	gcry = gcry_md_open (&md1, algo, GCRY_MD_FLAG_HMAC | flags);
+	/* Setting the key also resets any previous state */
+	gcry = gcry_md_setkey (ctx->extract, salt, n_salt);
 	g_return_val_if_fail (gcry == 0, FALSE);
-	gcry = gcry_md_setkey (md1, salt, n_salt);
-	g_return_val_if_fail (gcry == 0, FALSE);
-	gcry_md_write (md1, input, n_input);
+	gcry_md_write (ctx->extract, input, n_input);
 
-	/* Step 2: Expand */
-	gcry = gcry_md_open (&md2, algo, GCRY_MD_FLAG_HMAC | flags);
-	g_return_val_if_fail (gcry == 0, FALSE);
-	gcry = gcry_md_setkey (md2, gcry_md_read (md1, algo), hash_len);
+	gcry = gcry_md_setkey (ctx->expand, gcry_md_read (ctx->extract, ctx->algo), ctx->hash_len);
 	g_return_val_if_fail (gcry == 0, FALSE);
-	gcry_md_close (md1);
+	gcry_md_reset (ctx->extract);
 
-	at = output;
-	for (i = 1; i < 256; ++i) {
-		gcry_md_reset (md2);
-		gcry_md_write (md2, buffer, n_buffer);
-		gcry_md_write (md2, info, n_info);
-		gcry_md_putc (md2, i);
+	ctx->have_key = TRUE;
+	return TRUE;
+}
 
-		n_buffer = hash_len;
-		memcpy (buffer, gcry_md_read (md2, algo), n_buffer);
+gboolean
+egg_hkdf_ctx_expand (EggHkdfCtx *ctx, gconstpointer info, gsize n_info,
+                     gpointer output, gsize n_output)
+{
+	g_return_val_if_fail (ctx != NULL, FALSE);
+	g_return_val_if_fail (ctx->have_key, FALSE);
+	g_return_val_if_fail (n_output <= 255 * ctx->hash_len, FALSE);
 
-		step = MIN (n_buffer, n_output);
-		memcpy (at, buffer, step);
-		n_output -= step;
-		at += step;
+	hkdf_expand (ctx->expand, ctx->algo, ctx->hash_len, ctx->buffer,
+	             info, n_info, output, n_output);
+	return TRUE;
+}
 
-		if (!n_output)
-			break;
-	}
+gboolean
+egg_hkdf_ctx_perform (EggHkdfCtx *ctx, gconstpointer input, gsize n_input,
+                      gconstpointer salt, gsize n_salt, gconstpointer info,
+                      gsize n_info, gpointer output, gsize n_output)
+{
+	if (!egg_hkdf_ctx_extract (ctx, input, n_input, salt, n_salt))
+		return FALSE;
+	return egg_hkdf_ctx_expand (ctx, info, n_info, output, n_output);
+}
 
-	g_free (alloc);
-	gcry_free (buffer);
-	gcry_md_close (md2);
-	return TRUE;
+void
+egg_hkdf_ctx_free (EggHkdfCtx *ctx)
+{
+	if (ctx == NULL)
+		return;
+
+	gcry_md_close (ctx->extract);
+	gcry_md_close (ctx->expand);
+	gcry_free (ctx->buffer);
+	g_free (ctx->zeros);
+	g_slice_free (EggHkdfCtx, ctx);
+}
+
+gboolean
+egg_hkdf_perform (const gchar *hash_algo, gconstpointer input, gsize n_input,
+                  gconstpointer salt, gsize n_salt, gconstpointer info,
+                  gsize n_info, gpointer output, gsize n_output)
+{
+	EggHkdfCtx *ctx;
+	gboolean ret;
+
+	ctx = egg_hkdf_ctx_new (hash_algo, gcry_is_secure (input));
+	g_return_val_if_fail (ctx != NULL, FALSE);
+
+	ret = egg_hkdf_ctx_perform (ctx, input, n_input, salt, n_salt,
+	                            info, n_info, output, n_output);
+
+	egg_hkdf_ctx_free (ctx);
+	return ret;
 }
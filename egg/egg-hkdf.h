@@ -36,4 +36,33 @@ gboolean   egg_hkdf_perform                                   (const gchar *hash
                                                                gpointer output,
                                                                gsize n_output);
 
+typedef struct _EggHkdfCtx EggHkdfCtx;
+
+EggHkdfCtx * egg_hkdf_ctx_new                                 (const gchar *hash_algo,
+                                                               gboolean secure);
+
+gboolean   egg_hkdf_ctx_extract                               (EggHkdfCtx *ctx,
+                                                               gconstpointer input,
+                                                               gsize n_input,
+                                                               gconstpointer salt,
+                                                               gsize n_salt);
+
+gboolean   egg_hkdf_ctx_expand                                (EggHkdfCtx *ctx,
+                                                               gconstpointer info,
+                                                               gsize n_info,
+                                                               gpointer output,
+                                                               gsize n_output);
+
+gboolean   egg_hkdf_ctx_perform                               (EggHkdfCtx *ctx,
+                                                               gconstpointer input,
+                                                               gsize n_input,
+                                                               gconstpointer salt,
+                                                               gsize n_salt,
+                                                               gconstpointer info,
+                                                               gsize n_info,
+                                                               gpointer output,
+                                                               gsize n_output);
+
+void       egg_hkdf_ctx_free                                  (EggHkdfCtx *ctx);
+
 #endif /* EGG_HKDF_H_ */
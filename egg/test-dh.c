@@ -98,6 +98,154 @@ test_short_pair (void)
 	gcry_mpi_release (X1);
 }
 
+static void
+test_pool_pair (void)
+{
+	gcry_mpi_t p, g;
+	gcry_mpi_t x1, X1;
+	gcry_mpi_t x2, X2;
+	gcry_mpi_t check;
+	gpointer k1, k2;
+	gboolean ret;
+	gsize n1, n2;
+
+	ret = egg_dh_default_params ("ietf-ike-grp-modp-768", &p, &g);
+	g_assert (ret);
+
+	/* First one is generated inline, second may come from the pool */
+	ret = egg_dh_pool_take_pair ("ietf-ike-grp-modp-768", 0, &X1, &x1);
+	g_assert (ret);
+	ret = egg_dh_pool_take_pair ("ietf-ike-grp-modp-768", 0, &X2, &x2);
+	g_assert (ret);
+
+	/* Never the same pair twice */
+	g_assert (gcry_mpi_cmp (x1, x2) != 0);
+
+	/* Public key must match the private one */
+	check = gcry_mpi_new (gcry_mpi_get_nbits (p));
+	gcry_mpi_powm (check, g, x2, p);
+	g_assert (gcry_mpi_cmp (check, X2) == 0);
+	gcry_mpi_release (check);
+
+	k1 = egg_dh_gen_secret (X2, x1, p, &n1);
+	g_assert (k1);
+	k2 = egg_dh_gen_secret (X1, x2, p, &n2);
+	g_assert (k2);
+
+	egg_assert_cmpsize (n1, ==, n2);
+	g_assert (memcmp (k1, k2, n1) == 0);
+
+	ret = egg_dh_pool_take_pair ("bad-name", 0, &X1, &x1);
+	g_assert (!ret);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (x1);
+	gcry_mpi_release (X1);
+	egg_secure_free (k1);
+	gcry_mpi_release (x2);
+	gcry_mpi_release (X2);
+	egg_secure_free (k2);
+}
+
+static void
+check_short_exponent (const gchar *name)
+{
+	gcry_mpi_t p, g;
+	gcry_mpi_t x1, X1;
+	gcry_mpi_t x2, X2;
+	gpointer k1, k2;
+	gsize n1, n2;
+	gboolean ret;
+	guint bits;
+
+	bits = egg_dh_short_exponent_bits (name);
+	g_assert_cmpuint (bits, >=, 160);
+
+	ret = egg_dh_default_params (name, &p, &g);
+	g_assert (ret);
+	g_assert_cmpuint (bits, <, gcry_mpi_get_nbits (p) / 2);
+
+	/* A short exponent on one side, a full one on the other */
+	ret = egg_dh_gen_pair (p, g, bits, &X1, &x1);
+	g_assert (ret);
+	g_assert_cmpuint (gcry_mpi_get_nbits (x1), <=, bits);
+	ret = egg_dh_pool_take_pair (name, 0, &X2, &x2);
+	g_assert (ret);
+
+	k1 = egg_dh_gen_secret (X2, x1, p, &n1);
+	g_assert (k1);
+	k2 = egg_dh_gen_secret (X1, x2, p, &n2);
+	g_assert (k2);
+
+	egg_assert_cmpsize (n1, ==, n2);
+	g_assert (memcmp (k1, k2, n1) == 0);
+
+	/* And the pool can hand out short ones too */
+	gcry_mpi_release (x2);
+	gcry_mpi_release (X2);
+	ret = egg_dh_pool_take_pair (name, bits, &X2, &x2);
+	g_assert (ret);
+	g_assert_cmpuint (gcry_mpi_get_nbits (x2), <=, bits);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (x1);
+	gcry_mpi_release (X1);
+	gcry_mpi_release (x2);
+	gcry_mpi_release (X2);
+	egg_secure_free (k1);
+	egg_secure_free (k2);
+}
+
+static void
+test_short_exponent (void)
+{
+	check_short_exponent ("ietf-ike-grp-modp-768");
+	check_short_exponent ("ietf-ike-grp-modp-1024");
+	check_short_exponent ("ietf-ike-grp-modp-2048");
+
+	g_assert_cmpuint (egg_dh_short_exponent_bits ("bad-name"), ==, 0);
+}
+
+static void
+test_perf_session (gconstpointer data)
+{
+	gboolean short_exponent = GPOINTER_TO_INT (data);
+	gcry_mpi_t p, g, peer, peer_priv;
+	gcry_mpi_t x, X;
+	gpointer k;
+	gsize n_k;
+	gdouble elapsed;
+	guint bits;
+	gint i;
+
+	egg_dh_default_params ("ietf-ike-grp-modp-1024", &p, &g);
+	bits = short_exponent ? egg_dh_short_exponent_bits ("ietf-ike-grp-modp-1024") : 0;
+
+	/* The other side of the exchange is not what is measured here */
+	egg_dh_gen_pair (p, g, 0, &peer, &peer_priv);
+
+	/* What the client does to open a session, without the pool */
+	g_test_timer_start ();
+	for (i = 0; i < 100; i++) {
+		egg_dh_gen_pair (p, g, bits, &X, &x);
+		k = egg_dh_gen_secret (peer, x, p, &n_k);
+		egg_secure_free (k);
+		gcry_mpi_release (x);
+		gcry_mpi_release (X);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed / 100, "%s exponent session key: %.3f ms",
+	                         short_exponent ? "short" : "full", elapsed * 10);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (peer);
+	gcry_mpi_release (peer_priv);
+}
+
 static void
 check_dh_default (const gchar *name, guint bits)
 {
@@ -193,6 +341,8 @@ main (int argc, char **argv)
 	if (!g_test_quick ()) {
 		g_test_add_func ("/dh/perform", test_perform);
 		g_test_add_func ("/dh/short_pair", test_short_pair);
+		g_test_add_func ("/dh/pool_pair", test_pool_pair);
+		g_test_add_func ("/dh/short_exponent", test_short_exponent);
 	}
 
 	g_test_add_func ("/dh/default_768", test_default_768);
@@ -204,5 +354,10 @@ main (int argc, char **argv)
 	g_test_add_func ("/dh/default_8192", test_default_8192);
 	g_test_add_func ("/dh/default_bad", test_default_bad);
 
+	if (g_test_perf ()) {
+		g_test_add_data_func ("/dh/perf/session-full", GINT_TO_POINTER (FALSE), test_perf_session);
+		g_test_add_data_func ("/dh/perf/session-short", GINT_TO_POINTER (TRUE), test_perf_session);
+	}
+
 	return g_test_run ();
 }
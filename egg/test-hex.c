@@ -109,15 +109,137 @@ test_decode_fail (void)
 	g_assert (!data);
 }
 
+static void
+test_round_trip (void)
+{
+	guchar input[300];
+	gchar *hex, *check;
+	guchar *data;
+	gsize n_data;
+	gsize length;
+	gsize i;
+
+	for (i = 0; i < sizeof (input); i++)
+		input[i] = g_random_int_range (0, 256);
+
+	/* Lengths around the block sizes of the vectorized paths */
+	for (length = 0; length < sizeof (input); length++) {
+		hex = egg_hex_encode_full (input, length, FALSE, NULL, 0);
+		g_assert_cmpuint (strlen (hex), ==, length * 2);
+		for (i = 0; i < length; i++) {
+			check = g_strdup_printf ("%02x", (guint)input[i]);
+			g_assert (strncmp (hex + i * 2, check, 2) == 0);
+			g_free (check);
+		}
+
+		data = egg_hex_decode (hex, -1, &n_data);
+		g_assert (data);
+		g_assert_cmpuint (n_data, ==, length);
+		g_assert (memcmp (data, input, length) == 0);
+		g_free (data);
+
+		/* A bad character anywhere should fail */
+		if (length > 0) {
+			hex[g_random_int_range (0, length * 2)] = 'g';
+			data = egg_hex_decode (hex, -1, &n_data);
+			g_assert (!data);
+		}
+
+		g_free (hex);
+
+		/* Same with delimiters */
+		hex = egg_hex_encode_full (input, length, TRUE, ":", 3);
+		data = egg_hex_decode_full (hex, -1, ":", 3, &n_data);
+		g_assert (data);
+		g_assert_cmpuint (n_data, ==, length);
+		g_assert (memcmp (data, input, length) == 0);
+		g_free (data);
+		g_free (hex);
+	}
+}
+
+static void
+test_perf_encode (gconstpointer user_data)
+{
+	gsize length = GPOINTER_TO_SIZE (user_data);
+	guchar *input;
+	gchar *hex;
+	gdouble elapsed;
+	gint count, rounds;
+	gsize i;
+
+	input = g_malloc (length);
+	for (i = 0; i < length; i++)
+		input[i] = i;
+
+	rounds = MAX (1, (64 * 1024 * 1024) / length);
+	g_test_timer_start ();
+	for (count = 0; count < rounds; count++) {
+		hex = egg_hex_encode_full (input, length, TRUE, NULL, 0);
+		g_free (hex);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed, "encode %" G_GSIZE_FORMAT " bytes: %.1f MB/s",
+	                         length, (length * (gdouble)rounds) / elapsed / (1024 * 1024));
+	g_free (input);
+}
+
+static void
+test_perf_decode (gconstpointer user_data)
+{
+	gsize length = GPOINTER_TO_SIZE (user_data);
+	guchar *input;
+	guchar *data;
+	gchar *hex;
+	gsize n_data;
+	gdouble elapsed;
+	gint count, rounds;
+	gsize i;
+
+	input = g_malloc (length);
+	for (i = 0; i < length; i++)
+		input[i] = i;
+	hex = egg_hex_encode_full (input, length, TRUE, NULL, 0);
+
+	rounds = MAX (1, (64 * 1024 * 1024) / length);
+	g_test_timer_start ();
+	for (count = 0; count < rounds; count++) {
+		data = egg_hex_decode (hex, length * 2, &n_data);
+		g_free (data);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed, "decode %" G_GSIZE_FORMAT " bytes: %.1f MB/s",
+	                         length, (length * (gdouble)rounds) / elapsed / (1024 * 1024));
+	g_free (input);
+	g_free (hex);
+}
+
 int
 main (int argc, char **argv)
 {
+	gchar *name;
+	gsize length;
+
 	g_test_init (&argc, &argv, NULL);
 
 	g_test_add_func ("/hex/encode", test_encode);
 	g_test_add_func ("/hex/encode_spaces", test_encode_spaces);
 	g_test_add_func ("/hex/decode", test_decode);
 	g_test_add_func ("/hex/decode_fail", test_decode_fail);
+	g_test_add_func ("/hex/round_trip", test_round_trip);
+
+	if (g_test_perf ()) {
+		for (length = 1024; length <= 16 * 1024 * 1024; length *= 4) {
+			name = g_strdup_printf ("/hex/perf/encode-%" G_GSIZE_FORMAT, length);
+			g_test_add_data_func (name, GSIZE_TO_POINTER (length), test_perf_encode);
+			g_free (name);
+			name = g_strdup_printf ("/hex/perf/decode-%" G_GSIZE_FORMAT, length);
+			g_test_add_data_func (name, GSIZE_TO_POINTER (length), test_perf_decode);
+			g_free (name);
+		}
+	}
 
 	return g_test_run ();
 }
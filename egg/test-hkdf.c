@@ -327,6 +327,107 @@ test_hkdf_test_case_7 (void)
 	egg_assert_cmpmem (buffer, sizeof (buffer), ==, okm, sizeof (okm));
 }
 
+static void
+test_hkdf_ctx (void)
+{
+	/* RFC 5869: A.1 Test Case 1 */
+	const guchar ikm1[] = { 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	                        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	                        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b };
+	const guchar salt1[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	                         0x08, 0x09, 0x0a, 0x0b, 0x0c };
+	const guchar info1[] = { 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+	                         0xf8, 0xf9 };
+	const guchar okm1[] = { 0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a,
+	                        0x90, 0x43, 0x4f, 0x64, 0xd0, 0x36, 0x2f, 0x2a,
+	                        0x2d, 0x2d, 0x0a, 0x90, 0xcf, 0x1a, 0x5a, 0x4c,
+	                        0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4, 0xc5, 0xbf,
+	                        0x34, 0x00, 0x72, 0x08, 0xd5, 0xb8, 0x87, 0x18,
+	                        0x58, 0x65 };
+	/* RFC 5869: A.3 Test Case 3, with a default salt */
+	const guchar okm3[] = { 0x8d, 0xa4, 0xe7, 0x75, 0xa5, 0x63, 0xc1, 0x8f,
+	                        0x71, 0x5f, 0x80, 0x2a, 0x06, 0x3c, 0x5a, 0x31,
+	                        0xb8, 0xa1, 0x1f, 0x5c, 0x5e, 0xe1, 0x87, 0x9e,
+	                        0xc3, 0x45, 0x4e, 0x5f, 0x3c, 0x73, 0x8d, 0x2d,
+	                        0x9d, 0x20, 0x13, 0x95, 0xfa, 0xa4, 0xb6, 0x1a,
+	                        0x96, 0xc8 };
+	guchar buffer[42];
+	guchar check[42];
+	EggHkdfCtx *ctx;
+	gboolean ret;
+
+	ctx = egg_hkdf_ctx_new ("sha256", FALSE);
+	g_assert (ctx != NULL);
+
+	memset (buffer, 0, sizeof (buffer));
+	ret = egg_hkdf_ctx_perform (ctx, ikm1, sizeof (ikm1), salt1, sizeof (salt1),
+	                            info1, sizeof (info1), buffer, sizeof (buffer));
+	g_assert (ret);
+	egg_assert_cmpmem (buffer, sizeof (buffer), ==, okm1, sizeof (okm1));
+
+	/* Same context again, with a different salt and no info */
+	memset (buffer, 0, sizeof (buffer));
+	ret = egg_hkdf_ctx_extract (ctx, ikm1, sizeof (ikm1), NULL, 0);
+	g_assert (ret);
+	ret = egg_hkdf_ctx_expand (ctx, NULL, 0, buffer, sizeof (buffer));
+	g_assert (ret);
+	egg_assert_cmpmem (buffer, sizeof (buffer), ==, okm3, sizeof (okm3));
+
+	/* Several outputs from one extraction */
+	ret = egg_hkdf_ctx_expand (ctx, info1, sizeof (info1), buffer, sizeof (buffer));
+	g_assert (ret);
+	ret = egg_hkdf_perform ("sha256", ikm1, sizeof (ikm1), NULL, 0,
+	                        info1, sizeof (info1), check, sizeof (check));
+	g_assert (ret);
+	egg_assert_cmpmem (buffer, sizeof (buffer), ==, check, sizeof (check));
+
+	ret = egg_hkdf_ctx_expand (ctx, NULL, 0, buffer, 16);
+	g_assert (ret);
+	egg_assert_cmpmem (buffer, 16, ==, okm3, 16);
+
+	egg_hkdf_ctx_free (ctx);
+
+	/* Secure memory variant gives the same answers */
+	ctx = egg_hkdf_ctx_new ("sha256", TRUE);
+	g_assert (ctx != NULL);
+	ret = egg_hkdf_ctx_perform (ctx, ikm1, sizeof (ikm1), salt1, sizeof (salt1),
+	                            info1, sizeof (info1), buffer, sizeof (buffer));
+	g_assert (ret);
+	egg_assert_cmpmem (buffer, sizeof (buffer), ==, okm1, sizeof (okm1));
+	egg_hkdf_ctx_free (ctx);
+}
+
+static void
+test_perf_derive (gconstpointer data)
+{
+	gboolean reuse = GPOINTER_TO_INT (data);
+	guchar ikm[128];
+	guchar okm[16];
+	EggHkdfCtx *ctx = NULL;
+	gdouble elapsed;
+	gint i;
+
+	memset (ikm, 0xAA, sizeof (ikm));
+
+	if (reuse)
+		ctx = egg_hkdf_ctx_new ("sha256", FALSE);
+
+	/* Same shape as a session key: 1024 bit DH secret to an AES key */
+	g_test_timer_start ();
+	for (i = 0; i < 10000; i++) {
+		if (reuse)
+			egg_hkdf_ctx_perform (ctx, ikm, sizeof (ikm), NULL, 0, NULL, 0, okm, sizeof (okm));
+		else
+			egg_hkdf_perform ("sha256", ikm, sizeof (ikm), NULL, 0, NULL, 0, okm, sizeof (okm));
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_maximized_result (10000 / elapsed, "%s: %.0f derivations per second",
+	                         reuse ? "context" : "one shot", 10000 / elapsed);
+
+	egg_hkdf_ctx_free (ctx);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -339,6 +440,12 @@ main (int argc, char **argv)
 	g_test_add_func ("/hkdf/test-case-5", test_hkdf_test_case_5);
 	g_test_add_func ("/hkdf/test-case-6", test_hkdf_test_case_6);
 	g_test_add_func ("/hkdf/test-case-7", test_hkdf_test_case_7);
+	g_test_add_func ("/hkdf/context", test_hkdf_ctx);
+
+	if (g_test_perf ()) {
+		g_test_add_data_func ("/hkdf/perf/one-shot", GINT_TO_POINTER (FALSE), test_perf_derive);
+		g_test_add_data_func ("/hkdf/perf/context", GINT_TO_POINTER (TRUE), test_perf_derive);
+	}
 
 	return g_test_run ();
 }
@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+
+#
+# Copyright 2026 The libsecret authors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation; either version 2.1 of the licence or (at
+# your option) any later version.
+#
+# See the included COPYING file for more information.
+#
+
+import mock
+import os
+
+count = int(os.environ.get("MOCK_BULK_ITEMS", "50"))
+
+service = mock.SecretService()
+service.add_standard_objects()
+
+collection = mock.SecretCollection(service, "bulk", locked=False)
+for i in range(count):
+	mock.SecretItem(collection, "item%d" % i, secret="stale",
+	                attributes={ "number": str(i), "string": "stale", "even": str(i % 2 == 0).lower() })
+mock.SecretItem(collection, "confirm1", attributes={ "string": "stale" }, secret="stale", confirm=True)
+mock.SecretItem(collection, "confirm2", attributes={ "string": "stale" }, secret="stale", confirm=True)
+
+collection = mock.SecretCollection(service, "lockedbulk", locked=True)
+mock.SecretItem(collection, "locked", attributes={ "string": "stale" }, secret="stale")
+
+service.listen()
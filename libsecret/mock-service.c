@@ -19,12 +19,16 @@
 
 #include "secret-private.h"
 
+#include <glib/gstdio.h>
+
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
 
 static GTestDBus *test_bus = NULL;
 static GPid pid = 0;
+static gchar *p2p_directory = NULL;
+static gchar *p2p_address = NULL;
 
 static gboolean
 service_start (const gchar *mock_script,
@@ -41,6 +45,7 @@ service_start (const gchar *mock_script,
 		"python", (gchar *)mock_script,
 		"--name", MOCK_SERVICE_NAME,
 		"--ready", ready,
+		"--p2p", NULL,
 		NULL
 	};
 
@@ -50,6 +55,13 @@ service_start (const gchar *mock_script,
 	test_bus = g_test_dbus_new (G_TEST_DBUS_NONE);
 	g_test_dbus_up (test_bus);
 
+	/* The mock service also listens for peer to peer connections here */
+	p2p_directory = g_dir_make_tmp ("mock-service-XXXXXX", error);
+	if (p2p_directory == NULL)
+		return FALSE;
+	p2p_address = g_strdup_printf ("unix:path=%s/socket", p2p_directory);
+	argv[7] = p2p_address;
+
 	g_setenv ("SECRET_SERVICE_BUS_NAME", MOCK_SERVICE_NAME, TRUE);
 
 	if (pipe (wait_pipe) < 0) {
@@ -95,6 +107,12 @@ mock_service_start (const gchar *mock_script,
 	return ret;
 }
 
+const gchar *
+mock_service_get_p2p_address (void)
+{
+	return p2p_address;
+}
+
 void
 mock_service_stop (void)
 {
@@ -111,6 +129,15 @@ mock_service_stop (void)
 	g_spawn_close_pid (pid);
 	pid = 0;
 
+	if (p2p_directory != NULL) {
+		g_unlink (p2p_address + strlen ("unix:path="));
+		g_rmdir (p2p_directory);
+	}
+	g_free (p2p_directory);
+	p2p_directory = NULL;
+	g_free (p2p_address);
+	p2p_address = NULL;
+
 	while (g_main_context_iteration (NULL, FALSE));
 
 	/*
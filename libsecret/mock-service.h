@@ -22,6 +22,8 @@
 gboolean      mock_service_start     (const gchar *mock_script,
                                       GError **error);
 
+const gchar * mock_service_get_p2p_address (void);
+
 void          mock_service_stop      (void);
 
 #endif /* _MOCK_SERVICE_H_ */
@@ -11,6 +11,8 @@
 # See the included COPYING file for more information.
 #
 
+import ctypes
+import fcntl
 import getopt
 import os
 import sys
@@ -22,6 +24,7 @@ import dh
 import hkdf
 
 import dbus
+import dbus.server
 import dbus.service
 import dbus.glib
 import gobject
@@ -30,7 +33,9 @@ COLLECTION_PREFIX = "/org/freedesktop/secrets/collection/"
 
 bus_name = 'org.freedesktop.Secret.MockService'
 ready_pipe = -1
+p2p_address = None
 objects = { }
+peers = [ ]
 
 class NotSupported(dbus.exceptions.DBusException):
 	def __init__(self, msg):
@@ -49,6 +54,43 @@ class NoSuchObject(dbus.exceptions.DBusException):
 		dbus.exceptions.DBusException.__init__(self, msg, name="org.freedesktop.Secret.Error.NoSuchObject")
 
 
+# For passing secrets in sealed memory files, see memfd_create(2)
+MFD_CLOEXEC = 0x0001
+MFD_ALLOW_SEALING = 0x0002
+F_ADD_SEALS = 1033
+F_GET_SEALS = 1034
+F_SEAL_SEAL = 0x0001
+F_SEAL_SHRINK = 0x0002
+F_SEAL_GROW = 0x0004
+F_SEAL_WRITE = 0x0008
+
+libc = ctypes.CDLL(None, use_errno=True)
+
+def memfd_new(data):
+	fd = libc.memfd_create("mock-secret", MFD_CLOEXEC | MFD_ALLOW_SEALING)
+	if fd < 0:
+		raise OSError(ctypes.get_errno(), "couldn't create memory file")
+	while data:
+		data = data[os.write(fd, data):]
+	fcntl.fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+	return fd
+
+def memfd_read(fd):
+	try:
+		seals = fcntl.fcntl(fd, F_GET_SEALS)
+		if seals & (F_SEAL_SHRINK | F_SEAL_WRITE) != (F_SEAL_SHRINK | F_SEAL_WRITE):
+			raise InvalidArgs("memory file with secret is not sealed")
+		os.lseek(fd, 0, os.SEEK_SET)
+		chunks = [ ]
+		while True:
+			chunk = os.read(fd, 65536)
+			if not chunk:
+				break
+			chunks.append(chunk)
+		return "".join(chunks)
+	finally:
+		os.close(fd)
+
 unique_identifier = 111
 def next_identifier(prefix=''):
 	global unique_identifier
@@ -65,6 +107,20 @@ def hex_encode(string):
 def alias_path(name):
 	return "/org/freedesktop/secrets/aliases/%s" % name
 
+def add_to_peers(object, path):
+	for connection in peers:
+		object.add_to_connection(connection, path)
+
+def add_to_connections(object, path):
+	object.add_to_connection(dbus.SessionBus(), path)
+	add_to_peers(object, path)
+
+class PeerServer(dbus.server.Server):
+	def on_connection_added(self, connection):
+		peers.append(connection)
+		for (path, object) in objects.items():
+			object.add_to_connection(connection, path)
+
 class PlainAlgorithm():
 	def negotiate(self, service, sender, param):
 		if type (param) != dbus.String:
@@ -119,6 +175,8 @@ class AesAlgorithm():
 
 
 class SecretPrompt(dbus.service.Object):
+	SUPPORTS_MULTIPLE_CONNECTIONS = True
+
 	def __init__(self, service, sender, prompt_name=None, delay=0,
 	             dismiss=False, action=None):
 		self.sender = sender
@@ -133,6 +191,7 @@ class SecretPrompt(dbus.service.Object):
 		else:
 			self.path = "/org/freedesktop/secrets/prompts/%s" % next_identifier('p')
 		dbus.service.Object.__init__(self, service.bus_name, self.path)
+		add_to_peers(self, self.path)
 		service.add_prompt(self)
 		assert self.path not in objects
 		objects[self.path] = self
@@ -160,6 +219,8 @@ class SecretPrompt(dbus.service.Object):
 
 
 class SecretSession(dbus.service.Object):
+	SUPPORTS_MULTIPLE_CONNECTIONS = True
+
 	def __init__(self, service, sender, algorithm, key):
 		self.sender = sender
 		self.service = service
@@ -167,6 +228,7 @@ class SecretSession(dbus.service.Object):
 		self.key = key
 		self.path = "/org/freedesktop/secrets/sessions/%s" % next_identifier('s')
 		dbus.service.Object.__init__(self, service.bus_name, self.path)
+		add_to_peers(self, self.path)
 		service.add_session(self)
 		objects[self.path] = self
 
@@ -182,6 +244,22 @@ class SecretSession(dbus.service.Object):
 		plain = self.algorithm.decrypt(self.key, value[1], value[2])
 		return (plain, value[3])
 
+	def encode_secret_fd(self, secret, content_type):
+		(params, data) = self.algorithm.encrypt(self.key, secret)
+		fd = memfd_new(data)
+		try:
+			handle = dbus.types.UnixFd(fd)
+		finally:
+			os.close(fd)
+		return dbus.Struct((dbus.ObjectPath(self.path), dbus.ByteArray(params),
+		                    handle, dbus.String(content_type)),
+		                   signature="oayhs")
+
+	def decode_secret_fd(self, value):
+		data = memfd_read(value[2].take())
+		plain = self.algorithm.decrypt(self.key, value[1], data)
+		return (plain, value[3])
+
 	@dbus.service.method('org.freedesktop.Secret.Session')
 	def Close(self):
 		self.remove_from_connection()
@@ -190,6 +268,7 @@ class SecretSession(dbus.service.Object):
 
 class SecretItem(dbus.service.Object):
 	SUPPORTS_MULTIPLE_OBJECT_PATHS = True
+	SUPPORTS_MULTIPLE_CONNECTIONS = True
 
 	def __init__(self, collection, identifier=None, label="Item", attributes={ },
 	             secret="", confirm=False, content_type="text/plain", type=None):
@@ -207,18 +286,19 @@ class SecretItem(dbus.service.Object):
 		self.confirm = confirm
 		self.created = self.modified = time.time()
 		dbus.service.Object.__init__(self, collection.service.bus_name, self.path)
+		add_to_peers(self, self.path)
 		self.collection.add_item(self)
 		objects[self.path] = self
 
 	def add_alias(self, name):
 		path = "%s/%s" % (alias_path(name), self.identifier)
 		objects[path] = self
-		self.add_to_connection(self.connection, path)
+		add_to_connections(self, path)
 
 	def remove_alias(self, name):
 		path = "%s/%s" % (alias_path(name), self.identifier)
 		del objects[path]
-		self.remove_from_connection(self.connection, path)
+		self.remove_from_connection(path=path)
 
 	def match_attributes(self, attributes):
 		for (key, value) in attributes.items():
@@ -234,6 +314,7 @@ class SecretItem(dbus.service.Object):
 
 	def perform_delete(self):
 		self.collection.remove_item(self)
+		self.collection.ItemDeleted(dbus.ObjectPath(self.path))
 		del objects[self.path]
 		self.remove_from_connection()
 
@@ -255,6 +336,26 @@ class SecretItem(dbus.service.Object):
 			raise IsLocked("secret is locked: %s" % self.path)
 		(self.secret, self.content_type) = session.decode_secret(secret)
 
+	@dbus.service.method('org.gnome.libsecret.Item.Fd', sender_keyword='sender',
+	                     out_signature='(oayhs)')
+	def GetSecretFd(self, session_path, sender=None):
+		session = objects.get(session_path, None)
+		if not session or session.sender != sender:
+			raise InvalidArgs("session invalid: %s" % session_path)
+		if self.get_locked():
+			raise IsLocked("secret is locked: %s" % self.path)
+		return session.encode_secret_fd(self.secret, self.content_type)
+
+	@dbus.service.method('org.gnome.libsecret.Item.Fd', sender_keyword='sender',
+	                     in_signature='(oayhs)', byte_arrays=True)
+	def SetSecretFd(self, secret, sender=None):
+		session = objects.get(secret[0], None)
+		if not session or session.sender != sender:
+			raise InvalidArgs("session invalid: %s" % secret[0])
+		if self.get_locked():
+			raise IsLocked("secret is locked: %s" % self.path)
+		(self.secret, self.content_type) = session.decode_secret_fd(secret)
+
 	@dbus.service.method('org.freedesktop.Secret.Item', sender_keyword='sender')
 	def Delete(self, sender=None):
 		item = self
@@ -311,6 +412,7 @@ class SecretItem(dbus.service.Object):
 
 class SecretCollection(dbus.service.Object):
 	SUPPORTS_MULTIPLE_OBJECT_PATHS = True
+	SUPPORTS_MULTIPLE_CONNECTIONS = True
 
 	def __init__(self, service, identifier=None, label="Collection", locked=False,
 	             confirm=False, master=None):
@@ -328,6 +430,7 @@ class SecretCollection(dbus.service.Object):
 		self.aliased = set()
 		self.path = "%s%s" % (COLLECTION_PREFIX, identifier)
 		dbus.service.Object.__init__(self, service.bus_name, self.path)
+		add_to_peers(self, self.path)
 		self.service.add_collection(self)
 		objects[self.path] = self
 
@@ -349,7 +452,7 @@ class SecretCollection(dbus.service.Object):
 			item.add_alias(name)
 		path = alias_path(name)
 		objects[path] = self
-		self.add_to_connection(self.connection, path)
+		add_to_connections(self, path)
 
 	def remove_alias(self, name):
 		if name not in self.aliased:
@@ -357,7 +460,7 @@ class SecretCollection(dbus.service.Object):
 		path = alias_path(name)
 		self.aliased.remove(name)
 		del objects[path]
-		self.remove_from_connection(self.connection, path)
+		self.remove_from_connection(path=path)
 		for item in self.items.values():
 			item.remove_alias(name)
 
@@ -410,6 +513,7 @@ class SecretCollection(dbus.service.Object):
 		if item is None:
 			item = SecretItem(self, next_identifier(), label, attributes, type=type,
 			                  secret=secret, confirm=False, content_type=content_type)
+			self.ItemCreated(dbus.ObjectPath(item.path))
 		else:
 			item.label = label
 			item.type = type
@@ -468,20 +572,32 @@ class SecretCollection(dbus.service.Object):
 	def PropertiesChanged(self, interface_name, changed_properties, invalidated_properties):
 		self.modified = time.time()
 
+	@dbus.service.signal('org.freedesktop.Secret.Collection', signature='o')
+	def ItemCreated(self, item_path):
+		self.modified = time.time()
+
+	@dbus.service.signal('org.freedesktop.Secret.Collection', signature='o')
+	def ItemDeleted(self, item_path):
+		self.modified = time.time()
+
 
 class SecretService(dbus.service.Object):
+	SUPPORTS_MULTIPLE_CONNECTIONS = True
 
 	algorithms = {
 		'plain': PlainAlgorithm(),
 		"dh-ietf1024-sha256-aes128-cbc-pkcs7": AesAlgorithm(),
 	}
 
+	object_manager = True
+
 	def __init__(self, name=None):
 		if name == None:
 			name = bus_name
 		bus = dbus.SessionBus()
 		self.bus_name = dbus.service.BusName(name, allow_replacement=True, replace_existing=True)
 		dbus.service.Object.__init__(self, self.bus_name, '/org/freedesktop/secrets')
+		objects['/org/freedesktop/secrets'] = self
 		self.sessions = { }
 		self.prompts = { }
 		self.collections = { }
@@ -534,6 +650,8 @@ class SecretService(dbus.service.Object):
 	def listen(self):
 		global ready_pipe
 		loop = gobject.MainLoop()
+		if p2p_address:
+			self.server = PeerServer(p2p_address)
 		if ready_pipe >= 0:
 			os.write(ready_pipe, "GO")
 			os.close(ready_pipe)
@@ -589,6 +707,8 @@ class SecretService(dbus.service.Object):
 		locked = []
 		prompts = []
 		for path in paths:
+			if not path.startswith("/org/freedesktop/secrets/"):
+				raise NoSuchObject("no such object: %s" % path)
 			if path not in objects:
 				continue
 			object = objects[path]
@@ -675,6 +795,20 @@ class SecretService(dbus.service.Object):
 				raise NoSuchObject("no such Collection")
 			self.set_alias(name, self.collections[collection])
 
+	@dbus.service.method('org.freedesktop.DBus.ObjectManager', out_signature='a{oa{sa{sv}}}')
+	def GetManagedObjects(self):
+		if not self.object_manager:
+			raise dbus.exceptions.DBusException("No ObjectManager on this service",
+			                                    name="org.freedesktop.DBus.Error.UnknownMethod")
+		objects = { }
+		for collection in self.collections.values():
+			interface = 'org.freedesktop.Secret.Collection'
+			objects[dbus.ObjectPath(collection.path)] = { interface: collection.GetAll(interface) }
+			for item in collection.items.values():
+				interface = 'org.freedesktop.Secret.Item'
+				objects[dbus.ObjectPath(item.path)] = { interface: item.GetAll(interface) }
+		return objects
+
 	@dbus.service.method(dbus.PROPERTIES_IFACE, in_signature='ss', out_signature='v')
 	def Get(self, interface_name, property_name):
 		return self.GetAll(interface_name)[property_name]
@@ -696,9 +830,9 @@ class SecretService(dbus.service.Object):
 
 
 def parse_options(args):
-	global bus_name, ready_pipe
+	global bus_name, ready_pipe, p2p_address
 	try:
-		opts, args = getopt.getopt(args, "nr", ["name=", "ready="])
+		opts, args = getopt.getopt(args, "nrp", ["name=", "ready=", "p2p="])
 	except getopt.GetoptError, err:
 		print str(err)
 		sys.exit(2)
@@ -707,6 +841,8 @@ def parse_options(args):
 			bus_name = a
 		elif o in ("-r", "--ready"):
 			ready_pipe = int(a)
+		elif o in ("-p", "--p2p"):
+			p2p_address = a
 		else:
 			assert False, "unhandled option"
 	return args
@@ -32,6 +32,356 @@
  * Use secret_attributes_build() to simply build up a set of attributes.
  */
 
+/*
+ * An immutable set of attributes, sorted by name, with the pointer table and
+ * the values carved out of a single allocation. Equal sets hash and compare
+ * cheaply, and looking up a name is a binary search.
+ *
+ * Nearly every item in a keyring uses the same few attribute names, so the
+ * names are shared between sets rather than copied into each one. The same
+ * goes for the schema name in the xdg:schema attribute. A shared string is
+ * freed along with the last set using it, so names that a service reports
+ * don't pile up for the life of the process. Other values are not shared.
+ */
+struct _SecretAttributes {
+	gint refs;
+	guint hash;
+	guint length;
+	const gchar **pairs;
+};
+
+typedef struct {
+	gint refs;
+	gchar string[1];
+} SharedString;
+
+G_LOCK_DEFINE_STATIC (shared_strings);
+static GHashTable *shared_strings = NULL;
+
+typedef struct {
+	const gchar *name;
+	const gchar *value;
+} AttributePair;
+
+static gint
+compare_pairs (gconstpointer a,
+               gconstpointer b,
+               gpointer user_data)
+{
+	return strcmp (((const AttributePair *)a)->name,
+	               ((const AttributePair *)b)->name);
+}
+
+static gboolean
+attribute_value_is_shared (const gchar *name)
+{
+	return g_str_equal (name, "xdg:schema");
+}
+
+/* Called with the shared_strings lock held */
+static const gchar *
+shared_string_ref (const gchar *string)
+{
+	SharedString *shared;
+	gsize length;
+
+	if (shared_strings == NULL)
+		shared_strings = g_hash_table_new (g_str_hash, g_str_equal);
+
+	shared = g_hash_table_lookup (shared_strings, string);
+	if (shared == NULL) {
+		length = strlen (string);
+		shared = g_malloc (G_STRUCT_OFFSET (SharedString, string) + length + 1);
+		shared->refs = 0;
+		memcpy (shared->string, string, length + 1);
+		g_hash_table_insert (shared_strings, shared->string, shared);
+	}
+
+	shared->refs++;
+	return shared->string;
+}
+
+/* Called with the shared_strings lock held */
+static void
+shared_string_unref (const gchar *string)
+{
+	SharedString *shared;
+
+	shared = (SharedString *)(string - G_STRUCT_OFFSET (SharedString, string));
+	if (--shared->refs == 0) {
+		g_hash_table_remove (shared_strings, shared->string);
+		g_free (shared);
+	}
+}
+
+/* Stable, so with duplicate names the last one wins */
+static void
+sort_pairs (GArray *pairs)
+{
+	AttributePair *pair;
+	guint i, length;
+
+	g_array_sort_with_data (pairs, compare_pairs, NULL);
+
+	for (i = 0, length = 0; i < pairs->len; i++) {
+		pair = &g_array_index (pairs, AttributePair, i);
+		if (i + 1 < pairs->len &&
+		    g_str_equal (pair->name, g_array_index (pairs, AttributePair, i + 1).name))
+			continue;
+		g_array_index (pairs, AttributePair, length++) = *pair;
+	}
+
+	g_array_set_size (pairs, length);
+}
+
+static GArray *
+pairs_for_table (GHashTable *attributes,
+                 const gchar *schema_name)
+{
+	GHashTableIter iter;
+	AttributePair pair;
+	GArray *pairs;
+
+	pairs = g_array_sized_new (FALSE, FALSE, sizeof (AttributePair),
+	                           g_hash_table_size (attributes) + 1);
+
+	g_hash_table_iter_init (&iter, attributes);
+	while (g_hash_table_iter_next (&iter, (gpointer *)&pair.name, (gpointer *)&pair.value)) {
+		if (!schema_name || !g_str_equal (pair.name, "xdg:schema"))
+			g_array_append_val (pairs, pair);
+	}
+
+	if (schema_name) {
+		pair.name = "xdg:schema";
+		pair.value = schema_name;
+		g_array_append_val (pairs, pair);
+	}
+
+	sort_pairs (pairs);
+	return pairs;
+}
+
+static SecretAttributes *
+attributes_new_for_pairs (GArray *pairs)
+{
+	SecretAttributes *attrs;
+	AttributePair *pair;
+	gsize size;
+	gchar *data;
+	guint i;
+
+	size = sizeof (SecretAttributes) + sizeof (gchar *) * pairs->len * 2;
+	for (i = 0; i < pairs->len; i++) {
+		pair = &g_array_index (pairs, AttributePair, i);
+		if (!attribute_value_is_shared (pair->name))
+			size += strlen (pair->value) + 1;
+	}
+
+	attrs = g_malloc (size);
+	attrs->refs = 1;
+	attrs->hash = 5381;
+	attrs->length = pairs->len;
+	attrs->pairs = (const gchar **)(attrs + 1);
+
+	data = (gchar *)(attrs->pairs + pairs->len * 2);
+	G_LOCK (shared_strings);
+	for (i = 0; i < pairs->len; i++) {
+		pair = &g_array_index (pairs, AttributePair, i);
+		attrs->pairs[i * 2] = shared_string_ref (pair->name);
+		if (attribute_value_is_shared (pair->name)) {
+			attrs->pairs[i * 2 + 1] = shared_string_ref (pair->value);
+		} else {
+			attrs->pairs[i * 2 + 1] = data;
+			data = g_stpcpy (data, pair->value) + 1;
+		}
+		attrs->hash = (attrs->hash * 33) ^ g_str_hash (pair->name);
+		attrs->hash = (attrs->hash * 33) ^ g_str_hash (pair->value);
+	}
+	G_UNLOCK (shared_strings);
+
+	return attrs;
+}
+
+SecretAttributes *
+_secret_attributes_new_for_table (GHashTable *attributes,
+                                  const gchar *schema_name)
+{
+	SecretAttributes *attrs;
+	GArray *pairs;
+
+	g_return_val_if_fail (attributes != NULL, NULL);
+
+	pairs = pairs_for_table (attributes, schema_name);
+	attrs = attributes_new_for_pairs (pairs);
+	g_array_free (pairs, TRUE);
+	return attrs;
+}
+
+SecretAttributes *
+_secret_attributes_new_for_variant (GVariant *variant)
+{
+	SecretAttributes *attrs;
+	AttributePair pair;
+	GVariantIter iter;
+	GArray *pairs;
+
+	g_return_val_if_fail (variant != NULL, NULL);
+
+	pairs = g_array_sized_new (FALSE, FALSE, sizeof (AttributePair),
+	                           g_variant_n_children (variant));
+
+	/* The strings point into the variant, and are copied below */
+	g_variant_iter_init (&iter, variant);
+	while (g_variant_iter_next (&iter, "{&s&s}", &pair.name, &pair.value))
+		g_array_append_val (pairs, pair);
+
+	sort_pairs (pairs);
+	attrs = attributes_new_for_pairs (pairs);
+	g_array_free (pairs, TRUE);
+	return attrs;
+}
+
+SecretAttributes *
+_secret_attributes_ref (SecretAttributes *attrs)
+{
+	g_return_val_if_fail (attrs != NULL, NULL);
+	g_atomic_int_inc (&attrs->refs);
+	return attrs;
+}
+
+void
+_secret_attributes_unref (gpointer attrs)
+{
+	SecretAttributes *self = attrs;
+	guint i;
+
+	if (self == NULL || !g_atomic_int_dec_and_test (&self->refs))
+		return;
+
+	G_LOCK (shared_strings);
+	for (i = 0; i < self->length; i++) {
+		if (attribute_value_is_shared (self->pairs[i * 2]))
+			shared_string_unref (self->pairs[i * 2 + 1]);
+		shared_string_unref (self->pairs[i * 2]);
+	}
+	G_UNLOCK (shared_strings);
+
+	g_free (self);
+}
+
+GType
+_secret_attributes_get_type (void)
+{
+	static gsize initialized = 0;
+	static GType type = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		type = g_boxed_type_register_static ("SecretAttributes",
+		                                     (GBoxedCopyFunc)_secret_attributes_ref,
+		                                     (GBoxedFreeFunc)_secret_attributes_unref);
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return type;
+}
+
+guint
+_secret_attributes_get_length (SecretAttributes *attrs)
+{
+	g_return_val_if_fail (attrs != NULL, 0);
+	return attrs->length;
+}
+
+const gchar *
+_secret_attributes_lookup (SecretAttributes *attrs,
+                           const gchar *name)
+{
+	guint lower, upper, mid;
+	gint cmp;
+
+	g_return_val_if_fail (attrs != NULL, NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+
+	lower = 0;
+	upper = attrs->length;
+	while (lower < upper) {
+		mid = lower + (upper - lower) / 2;
+		cmp = strcmp (name, attrs->pairs[mid * 2]);
+		if (cmp == 0)
+			return attrs->pairs[mid * 2 + 1];
+		else if (cmp < 0)
+			upper = mid;
+		else
+			lower = mid + 1;
+	}
+
+	return NULL;
+}
+
+guint
+_secret_attributes_hash (gconstpointer attrs)
+{
+	return ((const SecretAttributes *)attrs)->hash;
+}
+
+gboolean
+_secret_attributes_equal (gconstpointer one,
+                          gconstpointer two)
+{
+	const SecretAttributes *a = one;
+	const SecretAttributes *b = two;
+	guint i;
+
+	if (a == b)
+		return TRUE;
+	if (a == NULL || b == NULL)
+		return FALSE;
+	if (a->hash != b->hash || a->length != b->length)
+		return FALSE;
+
+	/* The names are shared, and so can be compared directly */
+	for (i = 0; i < a->length; i++) {
+		if (a->pairs[i * 2] != b->pairs[i * 2])
+			return FALSE;
+		if (!g_str_equal (a->pairs[i * 2 + 1], b->pairs[i * 2 + 1]))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+GVariant *
+_secret_attributes_get_variant (SecretAttributes *attrs)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	g_return_val_if_fail (attrs != NULL, NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{ss}"));
+	for (i = 0; i < attrs->length; i++)
+		g_variant_builder_add (&builder, "{ss}", attrs->pairs[i * 2], attrs->pairs[i * 2 + 1]);
+
+	return g_variant_builder_end (&builder);
+}
+
+GHashTable *
+_secret_attributes_to_table (SecretAttributes *attrs)
+{
+	GHashTable *attributes;
+	guint i;
+
+	g_return_val_if_fail (attrs != NULL, NULL);
+
+	/* Callers may modify the table, so nothing is shared with it */
+	attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	for (i = 0; i < attrs->length; i++)
+		g_hash_table_insert (attributes, g_strdup (attrs->pairs[i * 2]),
+		                     g_strdup (attrs->pairs[i * 2 + 1]));
+
+	return attributes;
+}
+
 GVariant *
 _secret_attributes_to_variant (GHashTable *attributes,
                                const gchar *schema_name)
@@ -57,23 +407,6 @@ _secret_attributes_to_variant (GHashTable *attributes,
 	return g_variant_builder_end (&builder);
 }
 
-GHashTable *
-_secret_attributes_for_variant (GVariant *variant)
-{
-	GVariantIter iter;
-	GHashTable *attributes;
-	gchar *value;
-	gchar *key;
-
-	attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-
-	g_variant_iter_init (&iter, variant);
-	while (g_variant_iter_next (&iter, "{ss}", &key, &value))
-		g_hash_table_insert (attributes, key, value);
-
-	return attributes;
-}
-
 /**
  * secret_attributes_build: (skip)
  * @schema: the schema for the attributes
@@ -108,6 +108,7 @@ struct _SecretCollectionPrivate {
 	/* Protected by mutex */
 	GMutex mutex;
 	GHashTable *items;
+	GHashTable *pending;
 };
 
 static GInitableIface *secret_collection_initable_parent_iface = NULL;
@@ -137,6 +138,7 @@ secret_collection_init (SecretCollection *self)
 	                                        SecretCollectionPrivate);
 
 	g_mutex_init (&self->pv->mutex);
+	self->pv->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	self->pv->cancellable = g_cancellable_new ();
 	self->pv->constructing = TRUE;
 }
@@ -252,13 +254,17 @@ secret_collection_finalize (GObject *obj)
 {
 	SecretCollection *self = SECRET_COLLECTION (obj);
 
-	if (self->pv->service)
+	if (self->pv->service) {
+		_secret_service_unregister_proxy (self->pv->service,
+		                                  g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)));
 		g_object_remove_weak_pointer (G_OBJECT (self->pv->service),
 		                              (gpointer *)&self->pv->service);
+	}
 
 	g_mutex_clear (&self->pv->mutex);
 	if (self->pv->items)
 		g_hash_table_destroy (self->pv->items);
+	g_hash_table_destroy (self->pv->pending);
 	g_object_unref (self->pv->cancellable);
 
 	G_OBJECT_CLASS (secret_collection_parent_class)->finalize (obj);
@@ -268,19 +274,162 @@ static void
 collection_update_items (SecretCollection *self,
                          GHashTable *items)
 {
-	GHashTable *previous;
+	GPtrArray *removed;
+	GHashTableIter iter;
+	gboolean changed = FALSE;
+	gpointer path;
+	gpointer item;
 
-	g_hash_table_ref (items);
+	removed = g_ptr_array_new_with_free_func (g_object_unref);
 
 	g_mutex_lock (&self->pv->mutex);
-	previous = self->pv->items;
-	self->pv->items = items;
+
+	if (self->pv->items == NULL) {
+		self->pv->items = g_hash_table_ref (items);
+		changed = TRUE;
+
+	/* Apply only the differences, existing items stay as they are */
+	} else {
+		g_hash_table_iter_init (&iter, self->pv->items);
+		while (g_hash_table_iter_next (&iter, &path, &item)) {
+			if (!g_hash_table_contains (items, path)) {
+				g_ptr_array_add (removed, item);
+				g_hash_table_iter_steal (&iter);
+				g_free (path);
+			}
+		}
+
+		g_hash_table_iter_init (&iter, items);
+		while (g_hash_table_iter_next (&iter, &path, &item)) {
+			if (g_hash_table_lookup (self->pv->items, path) != item) {
+				g_hash_table_insert (self->pv->items, g_strdup (path),
+				                     g_object_ref (item));
+				changed = TRUE;
+			}
+		}
+	}
+
 	g_mutex_unlock (&self->pv->mutex);
 
-	if (previous != NULL)
-		g_hash_table_unref (previous);
+	if (changed || removed->len > 0)
+		g_object_notify (G_OBJECT (self), "items");
+	g_ptr_array_unref (removed);
+}
+
+typedef struct {
+	SecretCollection *collection;
+	gchar *item_path;
+} CreatedClosure;
+
+static void
+created_closure_free (gpointer data)
+{
+	CreatedClosure *closure = data;
+	g_object_unref (closure->collection);
+	g_free (closure->item_path);
+	g_slice_free (CreatedClosure, closure);
+}
+
+static void
+collection_settle_item (SecretCollection *self,
+                        const gchar *item_path,
+                        SecretItem *item)
+{
+	gboolean added = FALSE;
+
+	g_mutex_lock (&self->pv->mutex);
+
+	/* Only if nothing deleted or reloaded the item meanwhile */
+	if (g_hash_table_remove (self->pv->pending, item_path) &&
+	    item != NULL && self->pv->items != NULL &&
+	    !g_hash_table_contains (self->pv->items, item_path)) {
+		g_hash_table_insert (self->pv->items, g_strdup (item_path),
+		                     g_object_ref (item));
+		added = TRUE;
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
 
-	g_object_notify (G_OBJECT (self), "items");
+	if (added)
+		g_object_notify (G_OBJECT (self), "items");
+}
+
+static void
+on_item_created (GObject *source,
+                 GAsyncResult *result,
+                 gpointer user_data)
+{
+	CreatedClosure *closure = user_data;
+	GError *error = NULL;
+	SecretItem *item;
+
+	/* On failure the next full reload of Items picks the item up */
+	item = secret_item_new_for_dbus_path_finish (result, &error);
+	g_clear_error (&error);
+
+	collection_settle_item (closure->collection, closure->item_path, item);
+
+	if (item != NULL)
+		g_object_unref (item);
+	created_closure_free (closure);
+}
+
+static void
+collection_item_created (SecretCollection *self,
+                         const gchar *item_path)
+{
+	CreatedClosure *closure;
+	SecretItem *item;
+	gboolean load;
+
+	if (self->pv->service == NULL)
+		return;
+
+	g_mutex_lock (&self->pv->mutex);
+	load = self->pv->items != NULL &&
+	       !g_hash_table_contains (self->pv->items, item_path) &&
+	       !g_hash_table_contains (self->pv->pending, item_path);
+	if (load)
+		g_hash_table_add (self->pv->pending, g_strdup (item_path));
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (!load)
+		return;
+
+	/* Perhaps the item is already alive, eg: it was created by us */
+	item = _secret_service_lookup_item (self->pv->service, item_path);
+	if (item != NULL) {
+		collection_settle_item (self, item_path, item);
+		g_object_unref (item);
+
+	} else {
+		closure = g_slice_new0 (CreatedClosure);
+		closure->collection = g_object_ref (self);
+		closure->item_path = g_strdup (item_path);
+		secret_item_new_for_dbus_path (self->pv->service, item_path, SECRET_ITEM_NONE,
+		                               self->pv->cancellable, on_item_created, closure);
+	}
+}
+
+static void
+collection_item_deleted (SecretCollection *self,
+                         const gchar *item_path)
+{
+	gpointer path = NULL;
+	gpointer item = NULL;
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_remove (self->pv->pending, item_path);
+	if (self->pv->items != NULL &&
+	    g_hash_table_lookup_extended (self->pv->items, item_path, &path, &item))
+		g_hash_table_steal (self->pv->items, item_path);
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (item != NULL) {
+		g_object_notify (G_OBJECT (self), "items");
+		g_object_unref (item);
+		g_free (path);
+	}
 }
 
 static void
@@ -340,57 +489,24 @@ secret_collection_signal (GDBusProxy *proxy,
 	SecretCollection *self = SECRET_COLLECTION (proxy);
 	SecretItem *item;
 	const gchar *item_path;
-	GVariantBuilder builder;
-	gboolean found = FALSE;
-	GVariantIter iter;
-	GVariant *value;
-	GVariant *paths;
-	GVariant *path;
 
 	/*
 	 * Remember that these signals come from a time before PropertiesChanged.
 	 * We support them because they're in the spec, and ksecretservice uses them.
+	 * They name a single item, so apply them directly rather than reloading.
 	 */
 
-	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
-
-	/* A new collection was added, add it to the Collections property */
+	/* A new item was added, load just that item */
 	if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_CREATED)) {
-		g_variant_get (parameters, "(@o)", &value);
-		g_variant_builder_init (&builder, G_VARIANT_TYPE ("ao"));
-		g_variant_iter_init (&iter, paths);
-		while ((path = g_variant_iter_next_value (&iter)) != NULL) {
-			if (g_variant_equal (path, value)) {
-				found = TRUE;
-				break;
-			}
-			g_variant_builder_add_value (&builder, path);
-			g_variant_unref (path);
-		}
-		if (!found) {
-			g_variant_builder_add_value (&builder, value);
-			handle_property_changed (self, "Items", g_variant_builder_end (&builder));
-		}
-		g_variant_builder_clear (&builder);
-		g_variant_unref (value);
+		g_variant_get (parameters, "(&o)", &item_path);
+		collection_item_created (self, item_path);
 
-	/* A collection was deleted, remove it from the Collections property */
+	/* An item was deleted, drop just that item */
 	} else if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_DELETED)) {
-		g_variant_get (parameters, "(@o)", &value);
-		g_variant_builder_init (&builder, G_VARIANT_TYPE ("ao"));
-		g_variant_iter_init (&iter, paths);
-		while ((path = g_variant_iter_next_value (&iter)) != NULL) {
-			if (g_variant_equal (path, value))
-				found = TRUE;
-			else
-				g_variant_builder_add_value (&builder, path);
-			g_variant_unref (path);
-		}
-		if (found)
-			handle_property_changed (self, "Items", g_variant_builder_end (&builder));
-		g_variant_unref (value);
+		g_variant_get (parameters, "(&o)", &item_path);
+		collection_item_deleted (self, item_path);
 
-	/* The collection changed, update it */
+	/* The item changed, update it */
 	} else if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_CHANGED)) {
 		g_variant_get (parameters, "(&o)", &item_path);
 
@@ -410,8 +526,6 @@ secret_collection_signal (GDBusProxy *proxy,
 			g_object_unref (item);
 		}
 	}
-
-	g_variant_unref (paths);
 }
 
 static void
@@ -533,12 +647,22 @@ secret_collection_initable_init (GInitable *initable,
 	SecretCollection *self;
 	SecretService *service;
 	GDBusProxy *proxy;
+	GError *lerror = NULL;
 
 	if (!secret_collection_initable_parent_iface->init (initable, cancellable, error))
 		return FALSE;
 
 	proxy = G_DBUS_PROXY (initable);
 
+	/* As with GDBusProxy's own GetAll, only cancellation is an error here */
+	if (_secret_util_want_properties (proxy) &&
+	    !_secret_util_get_properties_sync (proxy, cancellable, &lerror) &&
+	    g_error_matches (lerror, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_propagate_error (error, lerror);
+		return FALSE;
+	}
+	g_clear_error (&lerror);
+
 	if (!_secret_util_have_cached_properties (proxy)) {
 		g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
 		             "No such secret collection at path: %s",
@@ -559,6 +683,7 @@ secret_collection_initable_init (GInitable *initable,
 	if (!collection_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error))
 		return FALSE;
 
+	_secret_service_register_proxy (self->pv->service, proxy);
 	self->pv->constructing = FALSE;
 	return TRUE;
 }
@@ -644,6 +769,53 @@ on_init_service (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+init_with_properties (SecretCollection *self,
+                      GSimpleAsyncResult *res)
+{
+	InitClosure *init = g_simple_async_result_get_op_res_gpointer (res);
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+
+	if (!_secret_util_have_cached_properties (proxy)) {
+		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                 "No such secret collection at path: %s",
+		                                 g_dbus_proxy_get_object_path (proxy));
+		g_simple_async_result_complete (res);
+
+	} else if (self->pv->service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
+		                    on_init_service, g_object_ref (res));
+
+	} else {
+		collection_ensure_for_flags_async (self, self->pv->init_flags,
+		                                   init->cancellable, res);
+	}
+}
+
+static void
+on_init_properties (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretCollection *self = SECRET_COLLECTION (source);
+	GError *error = NULL;
+
+	/* As with GDBusProxy's own GetAll, only cancellation is an error here */
+	if (!_secret_util_get_properties_finish (G_DBUS_PROXY (self), on_init_properties,
+	                                         result, &error) &&
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else {
+		g_clear_error (&error);
+		init_with_properties (self, res);
+	}
+
+	g_object_unref (res);
+}
+
 static void
 on_init_base (GObject *source,
               GAsyncResult *result,
@@ -660,19 +832,12 @@ on_init_base (GObject *source,
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 
-	} else if (!_secret_util_have_cached_properties (proxy)) {
-		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
-		                                 "No such secret collection at path: %s",
-		                                 g_dbus_proxy_get_object_path (proxy));
-		g_simple_async_result_complete (res);
-
-	} else if (self->pv->service == NULL) {
-		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
-		                    on_init_service, g_object_ref (res));
+	} else if (_secret_util_want_properties (proxy)) {
+		_secret_util_get_properties (proxy, on_init_properties, init->cancellable,
+		                             on_init_properties, g_object_ref (res));
 
 	} else {
-		collection_ensure_for_flags_async (self, self->pv->init_flags,
-		                                   init->cancellable, res);
+		init_with_properties (self, res);
 	}
 
 	g_object_unref (res);
@@ -715,6 +880,7 @@ secret_collection_async_initable_init_finish (GAsyncInitable *initable,
 	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
 		return FALSE;
 
+	_secret_service_register_proxy (self->pv->service, G_DBUS_PROXY (self));
 	self->pv->constructing = FALSE;
 	return TRUE;
 }
@@ -769,63 +935,76 @@ on_load_item (GObject *source,
 
 	if (closure->items_loading == 0) {
 		collection_update_items (self, closure->items);
-		g_simple_async_result_complete_in_idle (res);
+		g_simple_async_result_complete (res);
 	}
 
 	g_object_unref (self);
 	g_object_unref (res);
 }
 
-/**
- * secret_collection_load_items:
- * @self: the secret collection
- * @cancellable: optional cancellation object
- * @callback: called when the operation completes
- * @user_data: data to be passed to the callback
+/*
+ * The ObjectManager only lives at the service path, so GetManagedObjects
+ * always returns every collection and item in the service. The GetAll calls
+ * for the missing items are all sent at once, so they cost about one round
+ * trip of latency however many there are, but each is a message and a reply
+ * through the bus.
  *
- * Ensure that the #SecretCollection proxy has loaded all the items present
- * in the Secret Service. This affects the result of
- * secret_collection_get_items().
- *
- * For collections returned from secret_service_get_collections() the items
- * will have already been loaded.
- *
- * This method will return immediately and complete asynchronously.
+ * Applications typically load a handful of items, and for those the per item
+ * calls are cheaper than transferring the whole tree of a large keyring. This
+ * limit is a conservative judgement rather than a measured break even point:
+ * below it, loading works as it always has.
  */
-void
-secret_collection_load_items (SecretCollection *self,
-                              GCancellable *cancellable,
-                              GAsyncReadyCallback callback,
-                              gpointer user_data)
+#define ITEMS_MANAGED_OBJECTS_MIN 8
+
+static guint
+collection_count_missing_items (SecretCollection *self,
+                                GVariant *paths)
 {
-	ItemsClosure *closure;
 	SecretItem *item;
-	GSimpleAsyncResult *res;
 	const gchar *path;
-	GVariant *paths;
 	GVariantIter iter;
+	guint missing = 0;
 
-	g_return_if_fail (SECRET_IS_COLLECTION (self));
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_loop (&iter, "&o", &path)) {
+		item = _secret_collection_find_item_instance (self, path);
+		if (item == NULL)
+			missing++;
+		else
+			g_object_unref (item);
+	}
 
-	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
-	g_return_if_fail (paths != NULL);
+	return missing;
+}
 
-	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
-	                                 secret_collection_load_items);
-	closure = g_slice_new0 (ItemsClosure);
-	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
-	closure->items = items_table_new ();
-	g_simple_async_result_set_op_res_gpointer (res, closure, items_closure_free);
+static void
+items_load_paths (SecretCollection *self,
+                  GVariant *paths,
+                  GHashTable *objects,
+                  GSimpleAsyncResult *res,
+                  gboolean in_callback)
+{
+	ItemsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GVariant *properties;
+	SecretItem *item;
+	const gchar *path;
+	GVariantIter iter;
 
 	g_variant_iter_init (&iter, paths);
 	while (g_variant_iter_loop (&iter, "&o", &path)) {
 		item = _secret_collection_find_item_instance (self, path);
 
-		/* No such collection yet create a new one */
+		/* No such item yet, create a new one */
 		if (item == NULL) {
-			secret_item_new_for_dbus_path (self->pv->service, path, SECRET_ITEM_NONE,
-			                               cancellable, on_load_item, g_object_ref (res));
+			properties = objects ? g_hash_table_lookup (objects, path) : NULL;
+			if (properties != NULL)
+				_secret_item_new_for_properties (self->pv->service, path, properties,
+				                                 closure->cancellable, on_load_item,
+				                                 g_object_ref (res));
+			else
+				secret_item_new_for_dbus_path (self->pv->service, path, SECRET_ITEM_NONE,
+				                               closure->cancellable, on_load_item,
+				                               g_object_ref (res));
 			closure->items_loading++;
 
 		} else {
@@ -835,13 +1014,113 @@ secret_collection_load_items (SecretCollection *self,
 
 	if (closure->items_loading == 0) {
 		collection_update_items (self, closure->items);
-		g_simple_async_result_complete_in_idle (res);
+		if (in_callback)
+			g_simple_async_result_complete (res);
+		else
+			g_simple_async_result_complete_in_idle (res);
+	}
+}
+
+static void
+on_load_items_objects (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretCollection *self = SECRET_COLLECTION (g_async_result_get_source_object (user_data));
+	GHashTable *objects;
+	GError *error = NULL;
+	GVariant *paths;
+
+	objects = _secret_service_get_managed_objects_finish (SECRET_SERVICE (source), result, &error);
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
+
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (paths == NULL) {
+		g_simple_async_result_set_error (res, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
+		                                 "Secret collection has no Items property: %s",
+		                                 g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)));
+		g_simple_async_result_complete (res);
+
+	} else {
+		items_load_paths (self, paths, objects, res, TRUE);
 	}
 
+	if (paths != NULL)
+		g_variant_unref (paths);
+	if (objects != NULL)
+		g_hash_table_unref (objects);
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+void
+_secret_collection_load_items_with_objects (SecretCollection *self,
+                                            GHashTable *objects,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data)
+{
+	ItemsClosure *closure;
+	GSimpleAsyncResult *res;
+	GVariant *paths;
+
+	g_return_if_fail (SECRET_IS_COLLECTION (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
+	g_return_if_fail (paths != NULL);
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_collection_load_items);
+	closure = g_slice_new0 (ItemsClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->items = items_table_new ();
+	g_simple_async_result_set_op_res_gpointer (res, closure, items_closure_free);
+
+	/* One GetManagedObjects is cheaper than a GetAll for each of many items */
+	if (objects == NULL && collection_count_missing_items (self, paths) >= ITEMS_MANAGED_OBJECTS_MIN)
+		_secret_service_get_managed_objects (self->pv->service, cancellable,
+		                                     on_load_items_objects, g_object_ref (res));
+	else
+		items_load_paths (self, paths, objects, res, FALSE);
+
 	g_variant_unref (paths);
 	g_object_unref (res);
 }
 
+/**
+ * secret_collection_load_items:
+ * @self: the secret collection
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Ensure that the #SecretCollection proxy has loaded all the items present
+ * in the Secret Service. This affects the result of
+ * secret_collection_get_items().
+ *
+ * For collections returned from secret_service_get_collections() the items
+ * will have already been loaded.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_collection_load_items (SecretCollection *self,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+	g_return_if_fail (SECRET_IS_COLLECTION (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	_secret_collection_load_items_with_objects (self, NULL, cancellable,
+	                                            callback, user_data);
+}
+
 /**
  * secret_collection_load_items_finish:
  * @self: the secret collection
@@ -869,29 +1148,15 @@ secret_collection_load_items_finish (SecretCollection *self,
 	return TRUE;
 }
 
-/**
- * secret_collection_load_items_sync:
- * @self: the secret collection
- * @cancellable: optional cancellation object
- * @error: location to place an error on failure
- *
- * Ensure that the #SecretCollection proxy has loaded all the items present
- * in the Secret Service. This affects the result of
- * secret_collection_get_items().
- *
- * For collections returned from secret_service_get_collections() the items
- * will have already been loaded.
- *
- * This method may block indefinitely and should not be used in user interface
- * threads.
- *
- * Returns: whether the load was successful or not
- */
 gboolean
-secret_collection_load_items_sync (SecretCollection *self,
-                                   GCancellable *cancellable,
-                                   GError **error)
-{
+_secret_collection_load_items_with_objects_sync (SecretCollection *self,
+                                                 GHashTable *objects,
+                                                 GCancellable *cancellable,
+                                                 GError **error)
+{
+	GHashTable *fetched = NULL;
+	GVariant *properties;
+	GError *lerror = NULL;
 	SecretItem *item;
 	GHashTable *items;
 	GVariant *paths;
@@ -906,17 +1171,34 @@ secret_collection_load_items_sync (SecretCollection *self,
 	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
 	g_return_val_if_fail (paths != NULL, FALSE);
 
+	/* One GetManagedObjects is cheaper than a GetAll for each of many items */
+	if (objects == NULL && collection_count_missing_items (self, paths) >= ITEMS_MANAGED_OBJECTS_MIN) {
+		fetched = _secret_service_get_managed_objects_sync (self->pv->service,
+		                                                    cancellable, &lerror);
+		if (lerror != NULL) {
+			g_propagate_error (error, lerror);
+			g_variant_unref (paths);
+			return FALSE;
+		}
+		objects = fetched;
+	}
+
 	items = items_table_new ();
 
 	g_variant_iter_init (&iter, paths);
 	while (g_variant_iter_next (&iter, "&o", &path)) {
 		item = _secret_collection_find_item_instance (self, path);
 
-		/* No such collection yet create a new one */
+		/* No such item yet, create a new one */
 		if (item == NULL) {
-			item = secret_item_new_for_dbus_path_sync (self->pv->service, path,
-			                                           SECRET_ITEM_NONE,
-			                                           cancellable, error);
+			properties = objects ? g_hash_table_lookup (objects, path) : NULL;
+			if (properties != NULL)
+				item = _secret_item_new_for_properties_sync (self->pv->service, path,
+				                                             properties, cancellable, error);
+			else
+				item = secret_item_new_for_dbus_path_sync (self->pv->service, path,
+				                                           SECRET_ITEM_NONE,
+				                                           cancellable, error);
 			if (item == NULL) {
 				ret = FALSE;
 				break;
@@ -929,11 +1211,328 @@ secret_collection_load_items_sync (SecretCollection *self,
 	if (ret)
 		collection_update_items (self, items);
 
+	if (fetched != NULL)
+		g_hash_table_unref (fetched);
 	g_hash_table_unref (items);
 	g_variant_unref (paths);
 	return ret;
 }
 
+/**
+ * secret_collection_load_items_sync:
+ * @self: the secret collection
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Ensure that the #SecretCollection proxy has loaded all the items present
+ * in the Secret Service. This affects the result of
+ * secret_collection_get_items().
+ *
+ * For collections returned from secret_service_get_collections() the items
+ * will have already been loaded.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: whether the load was successful or not
+ */
+gboolean
+secret_collection_load_items_sync (SecretCollection *self,
+                                   GCancellable *cancellable,
+                                   GError **error)
+{
+	g_return_val_if_fail (SECRET_IS_COLLECTION (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return _secret_collection_load_items_with_objects_sync (self, NULL, cancellable, error);
+}
+
+/* Number of GetAll calls kept in flight when the service has no ObjectManager */
+#define ITEM_INFO_WINDOW 16
+
+typedef struct {
+	GCancellable *cancellable;
+	GDBusConnection *connection;
+	gchar *bus_name;
+	GVariant *paths;
+	const gchar **objv;
+	gsize n_objv;
+	gsize next;
+	gint in_flight;
+	SecretItemInfoList *list;
+	GError *error;
+} InfosClosure;
+
+typedef struct {
+	GSimpleAsyncResult *res;
+	const gchar *path;
+} InfosCall;
+
+static void
+infos_closure_free (gpointer data)
+{
+	InfosClosure *closure = data;
+	g_clear_object (&closure->cancellable);
+	g_object_unref (closure->connection);
+	g_free (closure->bus_name);
+	g_free (closure->objv);
+	g_variant_unref (closure->paths);
+	if (closure->list)
+		secret_item_info_list_unref (closure->list);
+	g_clear_error (&closure->error);
+	g_slice_free (InfosClosure, closure);
+}
+
+static void     infos_load_next     (GSimpleAsyncResult *res,
+                                     gboolean in_callback);
+
+static void
+on_item_info_get_all (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	InfosCall *call = user_data;
+	InfosClosure *closure = g_simple_async_result_get_op_res_gpointer (call->res);
+	GVariant *properties;
+	GVariant *retval;
+	GError *error = NULL;
+
+	closure->in_flight--;
+
+	retval = g_dbus_connection_call_finish (closure->connection, result, &error);
+	if (retval != NULL) {
+		g_variant_get (retval, "(@a{sv})", &properties);
+		_secret_item_info_list_add (closure->list, call->path, properties);
+		g_variant_unref (properties);
+		g_variant_unref (retval);
+
+	/* Items deleted while we were loading are simply left out */
+	} else if (g_error_matches (error, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT) ||
+	           g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		g_clear_error (&error);
+
+	} else if (closure->error == NULL) {
+		_secret_util_strip_remote_error (&error);
+		closure->error = error;
+
+	} else {
+		g_clear_error (&error);
+	}
+
+	infos_load_next (call->res, TRUE);
+
+	g_object_unref (call->res);
+	g_slice_free (InfosCall, call);
+}
+
+static void
+infos_load_next (GSimpleAsyncResult *res,
+                 gboolean in_callback)
+{
+	InfosClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	InfosCall *call;
+
+	while (closure->error == NULL && closure->next < closure->n_objv &&
+	       closure->in_flight < ITEM_INFO_WINDOW) {
+		call = g_slice_new0 (InfosCall);
+		call->res = g_object_ref (res);
+		call->path = closure->objv[closure->next++];
+
+		g_dbus_connection_call (closure->connection, closure->bus_name, call->path,
+		                        SECRET_PROPERTIES_INTERFACE, "GetAll",
+		                        g_variant_new ("(s)", SECRET_ITEM_INTERFACE),
+		                        G_VARIANT_TYPE ("(a{sv})"), G_DBUS_CALL_FLAGS_NONE, -1,
+		                        closure->cancellable, on_item_info_get_all, call);
+		closure->in_flight++;
+	}
+
+	if (closure->in_flight == 0) {
+		if (closure->error) {
+			g_simple_async_result_take_error (res, closure->error);
+			closure->error = NULL;
+		} else {
+			_secret_item_info_list_seal (closure->list);
+		}
+		if (in_callback)
+			g_simple_async_result_complete (res);
+		else
+			g_simple_async_result_complete_in_idle (res);
+	}
+}
+
+static void
+on_item_infos_objects (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	InfosClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GVariant *properties;
+	GHashTable *objects;
+	GError *error = NULL;
+	gsize i;
+
+	objects = _secret_service_get_managed_objects_finish (SECRET_SERVICE (source),
+	                                                      result, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	/* Items deleted since the collection was loaded are simply left out */
+	} else if (objects != NULL) {
+		for (i = 0; i < closure->n_objv; i++) {
+			properties = g_hash_table_lookup (objects, closure->objv[i]);
+			if (properties != NULL)
+				_secret_item_info_list_add (closure->list, closure->objv[i], properties);
+		}
+		_secret_item_info_list_seal (closure->list);
+		g_simple_async_result_complete (res);
+		g_hash_table_unref (objects);
+
+	/* No ObjectManager, so get the properties of each item by itself */
+	} else {
+		infos_load_next (res, TRUE);
+	}
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_collection_load_item_infos:
+ * @self: the secret collection
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Load snapshots of all the items in the collection, without creating a
+ * #SecretItem proxy for each of them. See #SecretItemInfo for details.
+ * Where the service supports it, all the snapshots come from a single
+ * D-Bus call.
+ *
+ * The items are in no particular order. Items deleted while loading are
+ * left out.
+ *
+ * This method will return immediately and complete asynchronously.
+ *
+ * Stability: Unstable
+ */
+void
+secret_collection_load_item_infos (SecretCollection *self,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	GSimpleAsyncResult *res;
+	InfosClosure *closure;
+
+	g_return_if_fail (SECRET_IS_COLLECTION (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_collection_load_item_infos);
+	closure = g_slice_new0 (InfosClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->connection = g_object_ref (g_dbus_proxy_get_connection (proxy));
+	closure->bus_name = g_strdup (g_dbus_proxy_get_name (proxy));
+	closure->paths = g_dbus_proxy_get_cached_property (proxy, "Items");
+	if (closure->paths == NULL)
+		closure->paths = g_variant_ref_sink (g_variant_new_objv (NULL, 0));
+	closure->objv = g_variant_get_objv (closure->paths, &closure->n_objv);
+	closure->list = _secret_item_info_list_new (closure->n_objv);
+	g_simple_async_result_set_op_res_gpointer (res, closure, infos_closure_free);
+
+	/* A single reply has the properties of every item */
+	_secret_service_get_managed_objects (self->pv->service, cancellable,
+	                                     on_item_infos_objects, g_object_ref (res));
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_collection_load_item_infos_finish:
+ * @self: the secret collection
+ * @result: the asynchronous result passed to the callback
+ * @error: location to place an error on failure
+ *
+ * Complete an asynchronous operation to load snapshots of all the items in
+ * the collection.
+ *
+ * Stability: Unstable
+ *
+ * Returns: (transfer full): the item snapshots, to be released with
+ *          secret_item_info_list_unref(), or %NULL on failure
+ */
+SecretItemInfoList *
+secret_collection_load_item_infos_finish (SecretCollection *self,
+                                          GAsyncResult *result,
+                                          GError **error)
+{
+	InfosClosure *closure;
+
+	g_return_val_if_fail (SECRET_IS_COLLECTION (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_collection_load_item_infos), NULL);
+
+	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
+		return NULL;
+
+	closure = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return secret_item_info_list_ref (closure->list);
+}
+
+/**
+ * secret_collection_load_item_infos_sync:
+ * @self: the secret collection
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Load snapshots of all the items in the collection, without creating a
+ * #SecretItem proxy for each of them. See #SecretItemInfo for details.
+ * Where the service supports it, all the snapshots come from a single
+ * D-Bus call.
+ *
+ * The items are in no particular order. Items deleted while loading are
+ * left out.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Stability: Unstable
+ *
+ * Returns: (transfer full): the item snapshots, to be released with
+ *          secret_item_info_list_unref(), or %NULL on failure
+ */
+SecretItemInfoList *
+secret_collection_load_item_infos_sync (SecretCollection *self,
+                                        GCancellable *cancellable,
+                                        GError **error)
+{
+	SecretItemInfoList *list;
+	SecretSync *sync;
+
+	g_return_val_if_fail (SECRET_IS_COLLECTION (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_collection_load_item_infos (self, cancellable,
+	                                   _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	list = secret_collection_load_item_infos_finish (self, sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return list;
+}
+
 /**
  * secret_collection_refresh:
  * @self: the collection
@@ -1235,6 +1834,7 @@ typedef struct {
 	gchar **paths;
 	guint loading;
 	SecretSearchFlags flags;
+	gpointer unlock_set;
 } SearchClosure;
 
 static void
@@ -1245,6 +1845,7 @@ search_closure_free (gpointer data)
 	g_clear_object (&closure->cancellable);
 	g_hash_table_unref (closure->items);
 	g_strfreev (closure->paths);
+	_secret_service_unlock_set_leave (closure->unlock_set);
 	g_slice_free (SearchClosure, closure);
 }
 
@@ -1306,9 +1907,12 @@ secret_search_unlock_load_or_complete (GSimpleAsyncResult *async,
 	/* If unlocking then unlock all the locked items */
 	if (search->flags & SECRET_SEARCH_UNLOCK) {
 		items = g_hash_table_get_values (search->items);
+		_secret_service_unlock_set_enter (search->unlock_set);
 		secret_service_unlock (secret_collection_get_service (search->collection),
 		                       items, search->cancellable,
 		                       on_search_unlocked, g_object_ref (async));
+		_secret_service_unlock_set_leave (search->unlock_set);
+		search->unlock_set = NULL;
 		g_list_free (items);
 
 	/* If loading secrets ... locked items automatically ignored */
@@ -1388,6 +1992,8 @@ on_search_paths (GObject *source,
 			secret_search_unlock_load_or_complete (async, search);
 
 	} else {
+		_secret_service_unlock_set_leave (search->unlock_set);
+		search->unlock_set = NULL;
 		g_simple_async_result_take_error (async, error);
 		g_simple_async_result_complete (async);
 	}
@@ -1448,6 +2054,8 @@ secret_collection_search (SecretCollection *self,
 	search->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
 	search->items = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
 	search->flags = flags;
+	if (flags & SECRET_SEARCH_UNLOCK)
+		search->unlock_set = _secret_service_unlock_set_join (secret_collection_get_service (self));
 	g_simple_async_result_set_op_res_gpointer (async, search, search_closure_free);
 
 	secret_collection_search_for_dbus_paths (self, schema, attributes,
@@ -1810,6 +2418,10 @@ _secret_collection_find_item_instance (SecretCollection *self,
 		g_object_ref (item);
 	g_mutex_unlock (&self->pv->mutex);
 
+	/* Not loaded here, but perhaps alive elsewhere, eg: from a search */
+	if (item == NULL && self->pv->service != NULL)
+		item = _secret_service_lookup_item (self->pv->service, item_path);
+
 	return item;
 }
 
@@ -21,6 +21,7 @@
 
 #include <gio/gio.h>
 
+#include "secret-item-info.h"
 #include "secret-schema.h"
 #include "secret-service.h"
 #include "secret-types.h"
@@ -92,6 +93,19 @@ gboolean            secret_collection_load_items_sync          (SecretCollection
                                                                 GCancellable *cancellable,
                                                                 GError **error);
 
+void                secret_collection_load_item_infos          (SecretCollection *self,
+                                                                GCancellable *cancellable,
+                                                                GAsyncReadyCallback callback,
+                                                                gpointer user_data);
+
+SecretItemInfoList * secret_collection_load_item_infos_finish  (SecretCollection *self,
+                                                                GAsyncResult *result,
+                                                                GError **error);
+
+SecretItemInfoList * secret_collection_load_item_infos_sync    (SecretCollection *self,
+                                                                GCancellable *cancellable,
+                                                                GError **error);
+
 void                secret_collection_refresh                  (SecretCollection *self);
 
 void                secret_collection_create                   (SecretService *service,
@@ -0,0 +1,397 @@
+/* libsecret - GLib wrapper for Secret Service
+ *
+ * Copyright 2026 The libsecret authors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the licence or (at
+ * your option) any later version.
+ *
+ * See the included COPYING file for more information.
+ */
+
+#include "config.h"
+
+#include "secret-item-info.h"
+#include "secret-private.h"
+
+#include <string.h>
+
+/**
+ * SECTION:secret-item-info
+ * @title: SecretItemInfo
+ * @short_description: lightweight snapshots of secret items
+ *
+ * A #SecretItemInfo describes a secret item at the time it was loaded: its
+ * D-Bus path, label, attributes, creation and modification times, and
+ * whether it is locked. Unlike #SecretItem it is not a D-Bus proxy, it is
+ * not kept up to date, and it cannot be used to retrieve the secret.
+ *
+ * This makes it suitable for scanning large keyrings, where creating a
+ * #SecretItem for each item would use a lot of memory. Use
+ * secret_collection_load_item_infos() to load snapshots of all the items
+ * in a collection.
+ *
+ * The snapshots are stored together in a #SecretItemInfoList. Strings in
+ * it are shared, so attribute names and common attribute values are only
+ * stored once. A #SecretItemInfo is only valid while its list is.
+ *
+ * Stability: Unstable
+ */
+
+/**
+ * SecretItemInfo:
+ *
+ * A snapshot of the properties of a secret item. Owned by the
+ * #SecretItemInfoList it came from.
+ */
+
+/**
+ * SecretItemInfoList:
+ *
+ * An immutable, reference counted list of #SecretItemInfo snapshots.
+ */
+
+struct _SecretItemInfo {
+	const gchar *path;
+	const gchar *label;
+	const gchar **attributes;
+	guint64 created;
+	guint64 modified;
+	gboolean locked;
+};
+
+struct _SecretItemInfoList {
+	gint refs;
+
+	/* All the strings, attribute names and values deduplicated */
+	GStringChunk *strings;
+
+	/* Items and their attribute name/value pairs, each NULL terminated */
+	GArray *infos;
+	GPtrArray *attributes;
+
+	/* Only while building, offsets into attributes for each info */
+	GArray *offsets;
+};
+
+GType
+secret_item_info_list_get_type (void)
+{
+	static gsize initialized = 0;
+	static GType type = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		type = g_boxed_type_register_static ("SecretItemInfoList",
+		                                     (GBoxedCopyFunc)secret_item_info_list_ref,
+		                                     (GBoxedFreeFunc)secret_item_info_list_unref);
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return type;
+}
+
+SecretItemInfoList *
+_secret_item_info_list_new (guint reserve)
+{
+	SecretItemInfoList *list;
+
+	list = g_slice_new0 (SecretItemInfoList);
+	list->refs = 1;
+	list->strings = g_string_chunk_new (4096);
+	list->infos = g_array_sized_new (FALSE, TRUE, sizeof (SecretItemInfo), reserve);
+	list->attributes = g_ptr_array_sized_new (reserve * 8);
+	list->offsets = g_array_sized_new (FALSE, TRUE, sizeof (guint), reserve);
+
+	return list;
+}
+
+static guint64
+get_uint64 (GVariant *properties,
+            const gchar *name)
+{
+	guint64 value = 0;
+	g_variant_lookup (properties, name, "t", &value);
+	return value;
+}
+
+void
+_secret_item_info_list_add (SecretItemInfoList *list,
+                            const gchar *path,
+                            GVariant *properties)
+{
+	SecretItemInfo info = { NULL, };
+	GVariant *attributes;
+	GVariantIter iter;
+	const gchar *label;
+	const gchar *name;
+	const gchar *value;
+	gboolean locked;
+	guint offset;
+
+	g_return_if_fail (list->offsets != NULL);
+
+	info.path = g_string_chunk_insert (list->strings, path);
+	if (g_variant_lookup (properties, "Label", "&s", &label))
+		info.label = g_string_chunk_insert (list->strings, label);
+	else
+		info.label = g_string_chunk_insert_const (list->strings, "");
+	if (g_variant_lookup (properties, "Locked", "b", &locked))
+		info.locked = locked;
+	info.created = get_uint64 (properties, "Created");
+	info.modified = get_uint64 (properties, "Modified");
+
+	offset = list->attributes->len;
+	attributes = g_variant_lookup_value (properties, "Attributes", G_VARIANT_TYPE ("a{ss}"));
+	if (attributes != NULL) {
+		g_variant_iter_init (&iter, attributes);
+		while (g_variant_iter_next (&iter, "{&s&s}", &name, &value)) {
+			g_ptr_array_add (list->attributes, g_string_chunk_insert_const (list->strings, name));
+			g_ptr_array_add (list->attributes, g_string_chunk_insert_const (list->strings, value));
+		}
+		g_variant_unref (attributes);
+	}
+	g_ptr_array_add (list->attributes, NULL);
+
+	g_array_append_val (list->infos, info);
+	g_array_append_val (list->offsets, offset);
+}
+
+SecretItemInfoList *
+_secret_item_info_list_seal (SecretItemInfoList *list)
+{
+	SecretItemInfo *info;
+	guint i;
+
+	g_return_val_if_fail (list->offsets != NULL, list);
+
+	/* The attributes array no longer moves around, point into it */
+	for (i = 0; i < list->infos->len; i++) {
+		info = &g_array_index (list->infos, SecretItemInfo, i);
+		info->attributes = (const gchar **)list->attributes->pdata +
+		                   g_array_index (list->offsets, guint, i);
+	}
+
+	g_array_free (list->offsets, TRUE);
+	list->offsets = NULL;
+	return list;
+}
+
+/**
+ * secret_item_info_list_ref:
+ * @list: the list
+ *
+ * Add another reference to the #SecretItemInfoList. For each reference
+ * secret_item_info_list_unref() should be called to unreference the list.
+ *
+ * Returns: (transfer full): the list
+ */
+SecretItemInfoList *
+secret_item_info_list_ref (SecretItemInfoList *list)
+{
+	g_return_val_if_fail (list != NULL, NULL);
+	g_atomic_int_inc (&list->refs);
+	return list;
+}
+
+/**
+ * secret_item_info_list_unref:
+ * @list: (type Secret.ItemInfoList): the list
+ *
+ * Unreference a #SecretItemInfoList. When the last reference is gone, then
+ * the list and all of its #SecretItemInfo snapshots will be freed.
+ */
+void
+secret_item_info_list_unref (gpointer list)
+{
+	SecretItemInfoList *self = list;
+
+	g_return_if_fail (self != NULL);
+
+	if (g_atomic_int_dec_and_test (&self->refs)) {
+		if (self->offsets)
+			g_array_free (self->offsets, TRUE);
+		g_array_free (self->infos, TRUE);
+		g_ptr_array_free (self->attributes, TRUE);
+		g_string_chunk_free (self->strings);
+		g_slice_free (SecretItemInfoList, self);
+	}
+}
+
+/**
+ * secret_item_info_list_get_length:
+ * @list: the list
+ *
+ * Get the number of items in the list.
+ *
+ * Returns: the number of items
+ */
+guint
+secret_item_info_list_get_length (SecretItemInfoList *list)
+{
+	g_return_val_if_fail (list != NULL, 0);
+	return list->infos->len;
+}
+
+/**
+ * secret_item_info_list_get:
+ * @list: the list
+ * @index: the index of the item
+ *
+ * Get a snapshot of one of the items in the list.
+ *
+ * Returns: (transfer none): the item snapshot, owned by the list
+ */
+const SecretItemInfo *
+secret_item_info_list_get (SecretItemInfoList *list,
+                           guint index)
+{
+	g_return_val_if_fail (list != NULL, NULL);
+	g_return_val_if_fail (list->offsets == NULL, NULL);
+	g_return_val_if_fail (index < list->infos->len, NULL);
+	return &g_array_index (list->infos, SecretItemInfo, index);
+}
+
+/**
+ * secret_item_info_get_path:
+ * @info: the item snapshot
+ *
+ * Get the D-Bus object path of the item.
+ *
+ * Returns: (transfer none): the object path
+ */
+const gchar *
+secret_item_info_get_path (const SecretItemInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+	return info->path;
+}
+
+/**
+ * secret_item_info_get_label:
+ * @info: the item snapshot
+ *
+ * Get the label of the item.
+ *
+ * Returns: (transfer none): the label
+ */
+const gchar *
+secret_item_info_get_label (const SecretItemInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+	return info->label;
+}
+
+/**
+ * secret_item_info_get_attribute:
+ * @info: the item snapshot
+ * @name: the name of the attribute
+ *
+ * Get the value of one of the item's attributes.
+ *
+ * Returns: (transfer none) (allow-none): the value, or %NULL if the item
+ *          has no such attribute
+ */
+const gchar *
+secret_item_info_get_attribute (const SecretItemInfo *info,
+                                const gchar *name)
+{
+	guint i;
+
+	g_return_val_if_fail (info != NULL, NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+
+	for (i = 0; info->attributes[i] != NULL; i += 2) {
+		if (g_str_equal (info->attributes[i], name))
+			return info->attributes[i + 1];
+	}
+
+	return NULL;
+}
+
+/**
+ * secret_item_info_get_attributes:
+ * @info: the item snapshot
+ *
+ * Get all the attributes of the item in a new hash table.
+ *
+ * Returns: (transfer full) (element-type utf8 utf8): a new table of
+ *          attributes, to be released with g_hash_table_unref()
+ */
+GHashTable *
+secret_item_info_get_attributes (const SecretItemInfo *info)
+{
+	GHashTable *attributes;
+	guint i;
+
+	g_return_val_if_fail (info != NULL, NULL);
+
+	attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	for (i = 0; info->attributes[i] != NULL; i += 2) {
+		g_hash_table_insert (attributes, g_strdup (info->attributes[i]),
+		                     g_strdup (info->attributes[i + 1]));
+	}
+
+	return attributes;
+}
+
+/**
+ * secret_item_info_get_schema_name:
+ * @info: the item snapshot
+ *
+ * Get the schema name of the item, from its xdg:schema attribute.
+ *
+ * Returns: (transfer none) (allow-none): the schema name
+ */
+const gchar *
+secret_item_info_get_schema_name (const SecretItemInfo *info)
+{
+	return secret_item_info_get_attribute (info, "xdg:schema");
+}
+
+/**
+ * secret_item_info_get_created:
+ * @info: the item snapshot
+ *
+ * Get the created date and time of the item. The return value is
+ * the number of seconds since the unix epoch, January 1st 1970.
+ *
+ * Returns: the created date and time
+ */
+guint64
+secret_item_info_get_created (const SecretItemInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+	return info->created;
+}
+
+/**
+ * secret_item_info_get_modified:
+ * @info: the item snapshot
+ *
+ * Get the modified date and time of the item. The return value is
+ * the number of seconds since the unix epoch, January 1st 1970.
+ *
+ * Returns: the modified date and time
+ */
+guint64
+secret_item_info_get_modified (const SecretItemInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+	return info->modified;
+}
+
+/**
+ * secret_item_info_get_locked:
+ * @info: the item snapshot
+ *
+ * Get whether the item was locked when the snapshot was taken.
+ *
+ * Returns: whether the item was locked
+ */
+gboolean
+secret_item_info_get_locked (const SecretItemInfo *info)
+{
+	g_return_val_if_fail (info != NULL, FALSE);
+	return info->locked;
+}
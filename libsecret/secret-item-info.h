@@ -0,0 +1,62 @@
+/* libsecret - GLib wrapper for Secret Service
+ *
+ * Copyright 2026 The libsecret authors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the licence or (at
+ * your option) any later version.
+ *
+ * See the included COPYING file for more information.
+ */
+
+#if !defined (__SECRET_INSIDE_HEADER__) && !defined (SECRET_COMPILATION)
+#error "Only <libsecret/secret.h> can be included directly."
+#endif
+
+#ifndef __SECRET_ITEM_INFO_H__
+#define __SECRET_ITEM_INFO_H__
+
+#include <gio/gio.h>
+
+#include "secret-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _SecretItemInfo      SecretItemInfo;
+
+typedef struct _SecretItemInfoList  SecretItemInfoList;
+
+#define             SECRET_TYPE_ITEM_INFO_LIST             (secret_item_info_list_get_type ())
+
+GType               secret_item_info_list_get_type         (void) G_GNUC_CONST;
+
+SecretItemInfoList * secret_item_info_list_ref             (SecretItemInfoList *list);
+
+void                secret_item_info_list_unref            (gpointer list);
+
+guint               secret_item_info_list_get_length       (SecretItemInfoList *list);
+
+const SecretItemInfo * secret_item_info_list_get           (SecretItemInfoList *list,
+                                                            guint index);
+
+const gchar *       secret_item_info_get_path              (const SecretItemInfo *info);
+
+const gchar *       secret_item_info_get_label             (const SecretItemInfo *info);
+
+const gchar *       secret_item_info_get_attribute         (const SecretItemInfo *info,
+                                                            const gchar *name);
+
+GHashTable *        secret_item_info_get_attributes        (const SecretItemInfo *info);
+
+const gchar *       secret_item_info_get_schema_name       (const SecretItemInfo *info);
+
+guint64             secret_item_info_get_created           (const SecretItemInfo *info);
+
+guint64             secret_item_info_get_modified          (const SecretItemInfo *info);
+
+gboolean            secret_item_info_get_locked            (const SecretItemInfo *info);
+
+G_END_DECLS
+
+#endif /* __SECRET_ITEM_INFO_H___ */
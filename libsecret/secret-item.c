@@ -102,6 +102,7 @@ struct _SecretItemPrivate {
 	/* Locked by mutex */
 	GMutex mutex;
 	SecretValue *value;
+	SecretAttributes *attributes;
 	gint disposed;
 };
 
@@ -263,21 +264,56 @@ secret_item_finalize (GObject *obj)
 {
 	SecretItem *self = SECRET_ITEM (obj);
 
-	if (self->pv->service)
+	if (self->pv->service) {
+		_secret_service_unregister_proxy (self->pv->service,
+		                                  g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)));
 		g_object_remove_weak_pointer (G_OBJECT (self->pv->service),
 		                              (gpointer *)&self->pv->service);
+	}
 
+	_secret_attributes_unref (self->pv->attributes);
 	g_mutex_clear (&self->pv->mutex);
 
 	G_OBJECT_CLASS (secret_item_parent_class)->finalize (obj);
 }
 
+/*
+ * Many items are usually loaded at once, so once a new Attributes value has
+ * been parsed it is dropped from the property cache, and only the parsed
+ * form, which shares its names with other items, is kept.
+ */
+static void
+item_update_attributes (SecretItem *self)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	SecretAttributes *previous;
+	SecretAttributes *attrs;
+	GVariant *variant;
+
+	variant = g_dbus_proxy_get_cached_property (proxy, "Attributes");
+	if (variant == NULL)
+		return;
+
+	attrs = _secret_attributes_new_for_variant (variant);
+	g_dbus_proxy_set_cached_property (proxy, "Attributes", NULL);
+	g_variant_unref (variant);
+
+	g_mutex_lock (&self->pv->mutex);
+	previous = self->pv->attributes;
+	self->pv->attributes = attrs;
+	g_mutex_unlock (&self->pv->mutex);
+
+	_secret_attributes_unref (previous);
+}
+
 static void
 handle_property_changed (GObject *object,
                          const gchar *property_name)
 {
-	if (g_str_equal (property_name, "Attributes"))
+	if (g_str_equal (property_name, "Attributes")) {
+		item_update_attributes (SECRET_ITEM (object));
 		g_object_notify (object, "attributes");
+	}
 
 	else if (g_str_equal (property_name, "Label"))
 		g_object_notify (object, "label");
@@ -473,12 +509,22 @@ secret_item_initable_init (GInitable *initable,
 	SecretItem *self;
 	SecretService *service;
 	GDBusProxy *proxy;
+	GError *lerror = NULL;
 
 	if (!secret_item_initable_parent_iface->init (initable, cancellable, error))
 		return FALSE;
 
 	proxy = G_DBUS_PROXY (initable);
 
+	/* As with GDBusProxy's own GetAll, only cancellation is an error here */
+	if (_secret_util_want_properties (proxy) &&
+	    !_secret_util_get_properties_sync (proxy, cancellable, &lerror) &&
+	    g_error_matches (lerror, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_propagate_error (error, lerror);
+		return FALSE;
+	}
+	g_clear_error (&lerror);
+
 	if (!_secret_util_have_cached_properties (proxy)) {
 		g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
 		             "No such secret item at path: %s",
@@ -495,7 +541,12 @@ secret_item_initable_init (GInitable *initable,
 			item_take_service (self, service);
 	}
 
-	return item_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error);
+	if (!item_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error))
+		return FALSE;
+
+	item_update_attributes (self);
+	_secret_service_register_proxy (self->pv->service, G_DBUS_PROXY (self));
+	return TRUE;
 }
 
 static void
@@ -530,6 +581,52 @@ on_init_service (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+init_with_properties (SecretItem *self,
+                      GSimpleAsyncResult *res)
+{
+	InitClosure *init = g_simple_async_result_get_op_res_gpointer (res);
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+
+	if (!_secret_util_have_cached_properties (proxy)) {
+		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                 "No such secret item at path: %s",
+		                                 g_dbus_proxy_get_object_path (proxy));
+		g_simple_async_result_complete (res);
+
+	} else if (self->pv->service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
+		                    on_init_service, g_object_ref (res));
+
+	} else {
+		item_ensure_for_flags_async (self, self->pv->init_flags, res);
+	}
+}
+
+static void
+on_init_properties (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretItem *self = SECRET_ITEM (source);
+	GError *error = NULL;
+
+	/* As with GDBusProxy's own GetAll, only cancellation is an error here */
+	if (!_secret_util_get_properties_finish (G_DBUS_PROXY (self), on_init_properties,
+	                                         result, &error) &&
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else {
+		g_clear_error (&error);
+		init_with_properties (self, res);
+	}
+
+	g_object_unref (res);
+}
+
 static void
 on_init_base (GObject *source,
               GAsyncResult *result,
@@ -546,18 +643,12 @@ on_init_base (GObject *source,
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 
-	} else if (!_secret_util_have_cached_properties (proxy)) {
-		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
-		                                 "No such secret item at path: %s",
-		                                 g_dbus_proxy_get_object_path (proxy));
-		g_simple_async_result_complete (res);
-
-	} else if (self->pv->service == NULL) {
-		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
-		                    on_init_service, g_object_ref (res));
+	} else if (_secret_util_want_properties (proxy)) {
+		_secret_util_get_properties (proxy, on_init_properties, init->cancellable,
+		                             on_init_properties, g_object_ref (res));
 
 	} else {
-		item_ensure_for_flags_async (self, self->pv->init_flags, res);
+		init_with_properties (self, res);
 	}
 
 	g_object_unref (res);
@@ -598,6 +689,9 @@ secret_item_async_initable_init_finish (GAsyncInitable *initable,
 	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
 		return FALSE;
 
+	item_update_attributes (SECRET_ITEM (initable));
+	_secret_service_register_proxy (SECRET_ITEM (initable)->pv->service,
+	                                G_DBUS_PROXY (initable));
 	return TRUE;
 }
 
@@ -1127,6 +1221,7 @@ secret_item_get_secret (SecretItem *self)
 
 typedef struct {
 	GCancellable *cancellable;
+	gboolean used_fd;
 } LoadClosure;
 
 static void
@@ -1137,6 +1232,9 @@ load_closure_free (gpointer data)
 	g_slice_free (LoadClosure, closure);
 }
 
+static void   item_load_secret_call   (SecretItem *self,
+                                       GSimpleAsyncResult *res);
+
 static void
 on_item_load_secret (GObject *source,
                      GAsyncResult *result,
@@ -1144,19 +1242,39 @@ on_item_load_secret (GObject *source,
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
 	SecretItem *self = SECRET_ITEM (g_async_result_get_source_object (user_data));
+	LoadClosure *load = g_simple_async_result_get_op_res_gpointer (res);
 	SecretSession *session;
+	GUnixFDList *fds = NULL;
 	GError *error = NULL;
 	SecretValue *value;
 	GVariant *retval;
 	GVariant *child;
 
-	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
+	if (load->used_fd)
+		retval = g_dbus_proxy_call_with_unix_fd_list_finish (G_DBUS_PROXY (source), &fds,
+		                                                     result, &error);
+	else
+		retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
+
+	/* The service doesn't support passing secrets in memory files */
+	if (load->used_fd && g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		g_clear_error (&error);
+		_secret_service_disable_fd_transfer (self->pv->service);
+		item_load_secret_call (self, res);
+		g_object_unref (self);
+		g_object_unref (res);
+		return;
+	}
+
 	if (error == NULL) {
 		child = g_variant_get_child_value (retval, 0);
 		g_variant_unref (retval);
 
 		session = _secret_service_get_session (self->pv->service);
-		value = _secret_session_decode_secret (session, child);
+		if (load->used_fd)
+			value = _secret_session_decode_secret_fd (session, child, fds);
+		else
+			value = _secret_session_decode_secret (session, child);
 		g_variant_unref (child);
 
 		if (value == NULL) {
@@ -1172,11 +1290,38 @@ on_item_load_secret (GObject *source,
 		g_simple_async_result_take_error (res, error);
 	}
 
+	g_clear_object (&fds);
 	g_simple_async_result_complete (res);
 	g_object_unref (self);
 	g_object_unref (res);
 }
 
+static void
+item_load_secret_call (SecretItem *self,
+                       GSimpleAsyncResult *res)
+{
+	LoadClosure *load = g_simple_async_result_get_op_res_gpointer (res);
+	const gchar *session_path;
+
+	session_path = secret_service_get_session_dbus_path (self->pv->service);
+	g_assert (session_path != NULL && session_path[0] != '\0');
+
+	/* We can't know how large the secret is, so always ask for a memory file */
+	load->used_fd = _secret_service_get_fd_transfer (self->pv->service);
+	if (load->used_fd)
+		g_dbus_proxy_call_with_unix_fd_list (G_DBUS_PROXY (self),
+		                                     SECRET_ITEM_FD_INTERFACE ".GetSecretFd",
+		                                     g_variant_new ("(o)", session_path),
+		                                     G_DBUS_CALL_FLAGS_NONE, -1, NULL,
+		                                     load->cancellable,
+		                                     on_item_load_secret, g_object_ref (res));
+	else
+		g_dbus_proxy_call (G_DBUS_PROXY (self), "GetSecret",
+		                   g_variant_new ("(o)", session_path),
+		                   G_DBUS_CALL_FLAGS_NONE, -1, load->cancellable,
+		                   on_item_load_secret, g_object_ref (res));
+}
+
 static void
 on_load_ensure_session (GObject *source,
                         GAsyncResult *result,
@@ -1184,8 +1329,6 @@ on_load_ensure_session (GObject *source,
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
 	SecretItem *self = SECRET_ITEM (g_async_result_get_source_object (user_data));
-	LoadClosure *load = g_simple_async_result_get_op_res_gpointer (res);
-	const gchar *session_path;
 	GError *error = NULL;
 
 	secret_service_ensure_session_finish (self->pv->service, result, &error);
@@ -1194,12 +1337,7 @@ on_load_ensure_session (GObject *source,
 		g_simple_async_result_complete (res);
 
 	} else {
-		session_path = secret_service_get_session_dbus_path (self->pv->service);
-		g_assert (session_path != NULL && session_path[0] != '\0');
-		g_dbus_proxy_call (G_DBUS_PROXY (self), "GetSecret",
-		                   g_variant_new ("(o)", session_path),
-		                   G_DBUS_CALL_FLAGS_NONE, -1, load->cancellable,
-		                   on_item_load_secret, g_object_ref (res));
+		item_load_secret_call (self, res);
 	}
 
 	g_object_unref (self);
@@ -1526,8 +1664,11 @@ secret_item_load_secrets_sync (GList *items,
                                GCancellable *cancellable,
                                GError **error)
 {
-	SecretSync *sync;
-	gboolean ret;
+	SecretService *service = NULL;
+	GHashTable *with_paths;
+	SecretValue *value;
+	SecretItem *item;
+	GPtrArray *paths;
 	GList *l;
 
 	for (l = items; l != NULL; l = g_list_next (l))
@@ -1536,25 +1677,44 @@ secret_item_load_secrets_sync (GList *items,
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
+	paths = g_ptr_array_new ();
+	for (l = items; l != NULL; l = g_list_next (l)) {
+		if (secret_item_get_locked (l->data))
+			continue;
+		if (service == NULL)
+			service = secret_item_get_service (l->data);
+		g_ptr_array_add (paths, (gpointer)g_dbus_proxy_get_object_path (l->data));
+	}
+	g_ptr_array_add (paths, NULL);
 
-	secret_item_load_secrets (items, cancellable,
-	                          _secret_sync_on_result, sync);
+	/* Nothing unlocked to load */
+	if (service == NULL) {
+		g_ptr_array_free (paths, TRUE);
+		return TRUE;
+	}
 
-	g_main_loop_run (sync->loop);
+	with_paths = secret_service_get_secrets_for_dbus_paths_sync (service, (const gchar **)paths->pdata,
+	                                                             cancellable, error);
+	g_ptr_array_free (paths, TRUE);
 
-	ret = secret_item_load_secrets_finish (sync->result, error);
+	if (with_paths == NULL)
+		return FALSE;
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	for (l = items; l != NULL; l = g_list_next (l)) {
+		item = l->data;
+		value = g_hash_table_lookup (with_paths, g_dbus_proxy_get_object_path (G_DBUS_PROXY (item)));
+		if (value != NULL)
+			_secret_item_set_cached_secret (item, value);
+	}
 
-	return ret;
+	g_hash_table_unref (with_paths);
+	return TRUE;
 }
 
 typedef struct {
 	GCancellable *cancellable;
 	SecretValue *value;
+	gboolean used_fd;
 } SetClosure;
 
 static void
@@ -1566,6 +1726,9 @@ set_closure_free (gpointer data)
 	g_slice_free (SetClosure, set);
 }
 
+static void   item_set_secret_call    (SecretItem *self,
+                                       GSimpleAsyncResult *res);
+
 static void
 on_item_set_secret (GObject *source,
                     GAsyncResult *result,
@@ -1579,6 +1742,16 @@ on_item_set_secret (GObject *source,
 
 	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
 
+	/* The service doesn't support passing secrets in memory files */
+	if (set->used_fd && g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		g_clear_error (&error);
+		_secret_service_disable_fd_transfer (self->pv->service);
+		item_set_secret_call (self, res);
+		g_object_unref (self);
+		g_object_unref (res);
+		return;
+	}
+
 	if (error == NULL) {
 		_secret_item_set_cached_secret (self, set->value);
 	} else {
@@ -1592,6 +1765,66 @@ on_item_set_secret (GObject *source,
 	g_object_unref (res);
 }
 
+static GVariant *
+item_encode_secret_fd (SecretItem *self,
+                       SecretSession *session,
+                       SecretValue *value,
+                       GUnixFDList *fds)
+{
+	GError *error = NULL;
+	GVariant *encoded;
+	gsize length;
+
+	if (!_secret_service_get_fd_transfer (self->pv->service))
+		return NULL;
+
+	secret_value_get (value, &length);
+	if (length < SECRET_FD_TRANSFER_THRESHOLD)
+		return NULL;
+
+	encoded = _secret_session_encode_secret_fd (session, value, fds, &error);
+	if (encoded == NULL) {
+		g_message ("couldn't pass secret in a memory file: %s", error->message);
+		g_error_free (error);
+	}
+
+	return encoded;
+}
+
+static void
+item_set_secret_call (SecretItem *self,
+                      GSimpleAsyncResult *res)
+{
+	SetClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretSession *session;
+	GVariant *encoded;
+	GUnixFDList *fds;
+
+	session = _secret_service_get_session (self->pv->service);
+
+	fds = g_unix_fd_list_new ();
+	encoded = item_encode_secret_fd (self, session, closure->value, fds);
+	closure->used_fd = (encoded != NULL);
+
+	if (closure->used_fd) {
+		g_dbus_proxy_call_with_unix_fd_list (G_DBUS_PROXY (self),
+		                                     SECRET_ITEM_FD_INTERFACE ".SetSecretFd",
+		                                     g_variant_new ("(@(oayhs))", encoded),
+		                                     G_DBUS_CALL_FLAGS_NO_AUTO_START, -1, fds,
+		                                     closure->cancellable,
+		                                     on_item_set_secret,
+		                                     g_object_ref (res));
+	} else {
+		encoded = _secret_session_encode_secret (session, closure->value);
+		g_dbus_proxy_call (G_DBUS_PROXY (self), "SetSecret",
+		                   g_variant_new ("(@(oayays))", encoded),
+		                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1, closure->cancellable,
+		                   on_item_set_secret, g_object_ref (res));
+	}
+
+	g_object_unref (fds);
+}
+
 static void
 on_set_ensure_session (GObject *source,
                        GAsyncResult *result,
@@ -1599,9 +1832,6 @@ on_set_ensure_session (GObject *source,
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
 	SecretItem *self = SECRET_ITEM (g_async_result_get_source_object (user_data));
-	SetClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretSession *session;
-	GVariant *encoded;
 	GError *error = NULL;
 
 	secret_service_ensure_session_finish (self->pv->service, result, &error);
@@ -1610,12 +1840,7 @@ on_set_ensure_session (GObject *source,
 		g_simple_async_result_complete (res);
 
 	} else {
-		session = _secret_service_get_session (self->pv->service);
-		encoded = _secret_session_encode_secret (session, closure->value);
-		g_dbus_proxy_call (G_DBUS_PROXY (self), "SetSecret",
-		                   g_variant_new ("(@(oayays))", encoded),
-		                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1, closure->cancellable,
-		                   on_item_set_secret, g_object_ref (res));
+		item_set_secret_call (self, res);
 	}
 
 	g_object_unref (self);
@@ -1737,6 +1962,221 @@ secret_item_set_secret_sync (SecretItem *self,
 	return ret;
 }
 
+typedef struct {
+	GCancellable *cancellable;
+	SecretValue *value;
+	gboolean written;
+} IfChangedClosure;
+
+static void
+if_changed_closure_free (gpointer data)
+{
+	IfChangedClosure *closure = data;
+	g_clear_object (&closure->cancellable);
+	if (closure->value)
+		secret_value_unref (closure->value);
+	g_slice_free (IfChangedClosure, closure);
+}
+
+static void
+on_if_changed_set_secret (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	IfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	if (secret_item_set_secret_finish (SECRET_ITEM (source), result, &error))
+		closure->written = TRUE;
+	else
+		g_simple_async_result_take_error (res, error);
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+static void
+if_changed_compare_secret (SecretItem *self,
+                           GSimpleAsyncResult *res,
+                           gboolean in_callback)
+{
+	IfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretValue *current;
+	gboolean same;
+
+	current = secret_item_get_secret (self);
+	same = current != NULL && _secret_value_equal (current, closure->value);
+	if (current != NULL)
+		secret_value_unref (current);
+
+	if (!same) {
+		secret_item_set_secret (self, closure->value, closure->cancellable,
+		                        on_if_changed_set_secret, g_object_ref (res));
+	} else if (in_callback) {
+		g_simple_async_result_complete (res);
+	} else {
+		g_simple_async_result_complete_in_idle (res);
+	}
+}
+
+static void
+on_if_changed_load_secret (GObject *source,
+                           GAsyncResult *result,
+                           gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretItem *self = SECRET_ITEM (source);
+	GError *error = NULL;
+
+	if (secret_item_load_secret_finish (self, result, &error)) {
+		if_changed_compare_secret (self, res, TRUE);
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_item_set_secret_if_changed:
+ * @self: an item
+ * @value: a new secret value
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to pass to the callback
+ *
+ * Set the secret value of this item, but only if it differs from the
+ * current secret value.
+ *
+ * The comparison is made against the secret value already loaded by this
+ * item, see secret_item_get_secret(). If no secret value has been loaded
+ * yet, it is loaded first. The comparison takes place in non-pageable
+ * memory.
+ *
+ * This function returns immediately and completes asynchronously.
+ */
+void
+secret_item_set_secret_if_changed (SecretItem *self,
+                                   SecretValue *value,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	IfChangedClosure *closure;
+	SecretValue *current;
+
+	g_return_if_fail (SECRET_IS_ITEM (self));
+	g_return_if_fail (value != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_item_set_secret_if_changed);
+	closure = g_slice_new0 (IfChangedClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->value = secret_value_ref (value);
+	g_simple_async_result_set_op_res_gpointer (res, closure, if_changed_closure_free);
+
+	current = secret_item_get_secret (self);
+	if (current != NULL) {
+		secret_value_unref (current);
+		if_changed_compare_secret (self, res, FALSE);
+	} else {
+		secret_item_load_secret (self, cancellable, on_if_changed_load_secret,
+		                         g_object_ref (res));
+	}
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_item_set_secret_if_changed_finish:
+ * @self: an item
+ * @result: asynchronous result passed to callback
+ * @written: (out) (allow-none): location to place whether the secret was written
+ * @error: location to place error on failure
+ *
+ * Complete asynchronous operation to set the secret value of this item
+ * if it changed.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_item_set_secret_if_changed_finish (SecretItem *self,
+                                          GAsyncResult *result,
+                                          gboolean *written,
+                                          GError **error)
+{
+	IfChangedClosure *closure;
+	GSimpleAsyncResult *res;
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_item_set_secret_if_changed), FALSE);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return FALSE;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	if (written)
+		*written = closure->written;
+	return TRUE;
+}
+
+/**
+ * secret_item_set_secret_if_changed_sync:
+ * @self: an item
+ * @value: a new secret value
+ * @cancellable: optional cancellation object
+ * @written: (out) (allow-none): location to place whether the secret was written
+ * @error: location to place error on failure
+ *
+ * Set the secret value of this item, but only if it differs from the
+ * current secret value.
+ *
+ * The comparison is made against the secret value already loaded by this
+ * item, see secret_item_get_secret(). If no secret value has been loaded
+ * yet, it is loaded first. The comparison takes place in non-pageable
+ * memory.
+ *
+ * This function may block indefinetely. Use the asynchronous version
+ * in user interface threads.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_item_set_secret_if_changed_sync (SecretItem *self,
+                                        SecretValue *value,
+                                        GCancellable *cancellable,
+                                        gboolean *written,
+                                        GError **error)
+{
+	SecretSync *sync;
+	gboolean ret;
+
+	g_return_val_if_fail (SECRET_IS_ITEM (self), FALSE);
+	g_return_val_if_fail (value != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_item_set_secret_if_changed (self, value, cancellable,
+	                                   _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	ret = secret_item_set_secret_if_changed_finish (self, sync->result, written, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return ret;
+}
+
 /**
  * secret_item_get_schema_name:
  * @self: an item
@@ -1749,16 +2189,16 @@ secret_item_set_secret_sync (SecretItem *self,
 gchar *
 secret_item_get_schema_name (SecretItem *self)
 {
+	SecretAttributes *attrs;
 	gchar *schema_name;
-	GVariant *variant;
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
-	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Attributes");
-	g_return_val_if_fail (variant != NULL, NULL);
+	attrs = _secret_item_ref_attributes (self);
+	g_return_val_if_fail (attrs != NULL, NULL);
 
-	g_variant_lookup (variant, "xdg:schema", "s", &schema_name);
-	g_variant_unref (variant);
+	schema_name = g_strdup (_secret_attributes_lookup (attrs, "xdg:schema"));
+	_secret_attributes_unref (attrs);
 
 	return schema_name;
 }
@@ -1783,20 +2223,38 @@ secret_item_get_schema_name (SecretItem *self)
 GHashTable *
 secret_item_get_attributes (SecretItem *self)
 {
+	SecretAttributes *attrs;
 	GHashTable *attributes;
-	GVariant *variant;
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
-	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Attributes");
-	g_return_val_if_fail (variant != NULL, NULL);
+	attrs = _secret_item_ref_attributes (self);
+	g_return_val_if_fail (attrs != NULL, NULL);
 
-	attributes = _secret_attributes_for_variant (variant);
-	g_variant_unref (variant);
+	attributes = _secret_attributes_to_table (attrs);
+	_secret_attributes_unref (attrs);
 
 	return attributes;
 }
 
+SecretAttributes *
+_secret_item_ref_attributes (SecretItem *self)
+{
+	SecretAttributes *attrs = NULL;
+
+	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
+
+	/* Such as after the attributes were set, or the item refreshed */
+	item_update_attributes (self);
+
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->attributes)
+		attrs = _secret_attributes_ref (self->pv->attributes);
+	g_mutex_unlock (&self->pv->mutex);
+
+	return attrs;
+}
+
 /**
  * secret_item_set_attributes:
  * @self: an item
@@ -1903,6 +2361,192 @@ secret_item_set_attributes_sync (SecretItem *self,
 	                                       cancellable, error);
 }
 
+static gboolean
+item_attributes_unchanged (SecretItem *self,
+                           SecretAttributes *wanted)
+{
+	SecretAttributes *current;
+	gboolean same;
+
+	current = _secret_item_ref_attributes (self);
+	same = _secret_attributes_equal (current, wanted);
+	_secret_attributes_unref (current);
+
+	return same;
+}
+
+static void
+on_if_changed_set_attributes (GObject *source,
+                              GAsyncResult *result,
+                              gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	IfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	if (_secret_util_set_property_finish (G_DBUS_PROXY (source), secret_item_set_attributes,
+	                                      result, &error))
+		closure->written = TRUE;
+	else
+		g_simple_async_result_take_error (res, error);
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+/**
+ * secret_item_set_attributes_if_changed:
+ * @self: an item
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): a new set of attributes
+ * @cancellable: optional cancellation object
+ * @callback: called when the asynchronous operation completes
+ * @user_data: data to pass to the callback
+ *
+ * Set the attributes of this item, but only if they differ from the
+ * attributes the item currently has.
+ *
+ * The comparison is made against the attributes last retrieved from the
+ * secret service, see secret_item_get_attributes().
+ *
+ * This function returns immediately and completes asynchronously.
+ */
+void
+secret_item_set_attributes_if_changed (SecretItem *self,
+                                       const SecretSchema *schema,
+                                       GHashTable *attributes,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+	const gchar *schema_name = NULL;
+	SecretAttributes *wanted;
+	GSimpleAsyncResult *res;
+	IfChangedClosure *closure;
+
+	g_return_if_fail (SECRET_IS_ITEM (self));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	if (schema != NULL) {
+		if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
+			return; /* Warnings raised already */
+		schema_name = schema->name;
+	}
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_item_set_attributes_if_changed);
+	closure = g_slice_new0 (IfChangedClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	g_simple_async_result_set_op_res_gpointer (res, closure, if_changed_closure_free);
+
+	wanted = _secret_attributes_new_for_table (attributes, schema_name);
+
+	if (item_attributes_unchanged (self, wanted)) {
+		g_simple_async_result_complete_in_idle (res);
+	} else {
+		_secret_util_set_property (G_DBUS_PROXY (self), "Attributes",
+		                           _secret_attributes_get_variant (wanted),
+		                           secret_item_set_attributes, cancellable,
+		                           on_if_changed_set_attributes, g_object_ref (res));
+	}
+
+	_secret_attributes_unref (wanted);
+	g_object_unref (res);
+}
+
+/**
+ * secret_item_set_attributes_if_changed_finish:
+ * @self: an item
+ * @result: asynchronous result passed to the callback
+ * @written: (out) (allow-none): location to place whether the attributes were written
+ * @error: location to place error on failure
+ *
+ * Complete operation to set the attributes of this item if they changed.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_item_set_attributes_if_changed_finish (SecretItem *self,
+                                              GAsyncResult *result,
+                                              gboolean *written,
+                                              GError **error)
+{
+	IfChangedClosure *closure;
+	GSimpleAsyncResult *res;
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_item_set_attributes_if_changed), FALSE);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return FALSE;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	if (written)
+		*written = closure->written;
+	return TRUE;
+}
+
+/**
+ * secret_item_set_attributes_if_changed_sync:
+ * @self: an item
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): a new set of attributes
+ * @cancellable: optional cancellation object
+ * @written: (out) (allow-none): location to place whether the attributes were written
+ * @error: location to place error on failure
+ *
+ * Set the attributes of this item, but only if they differ from the
+ * attributes the item currently has.
+ *
+ * The comparison is made against the attributes last retrieved from the
+ * secret service, see secret_item_get_attributes().
+ *
+ * This function may block indefinetely. Use the asynchronous version
+ * in user interface threads.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_item_set_attributes_if_changed_sync (SecretItem *self,
+                                            const SecretSchema *schema,
+                                            GHashTable *attributes,
+                                            GCancellable *cancellable,
+                                            gboolean *written,
+                                            GError **error)
+{
+	const gchar *schema_name = NULL;
+	SecretAttributes *wanted;
+	gboolean changed;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail (SECRET_IS_ITEM (self), FALSE);
+	g_return_val_if_fail (attributes != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (schema != NULL) {
+		if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
+			return FALSE; /* Warnings raised already */
+		schema_name = schema->name;
+	}
+
+	wanted = _secret_attributes_new_for_table (attributes, schema_name);
+
+	changed = !item_attributes_unchanged (self, wanted);
+	if (changed)
+		ret = _secret_util_set_property_sync (G_DBUS_PROXY (self), "Attributes",
+		                                      _secret_attributes_get_variant (wanted),
+		                                      cancellable, error);
+
+	_secret_attributes_unref (wanted);
+
+	if (ret && written)
+		*written = changed;
+	return ret;
+}
+
 /**
  * secret_item_get_label:
  * @self: an item
@@ -147,6 +147,23 @@ gboolean            secret_item_set_secret_sync            (SecretItem *self,
                                                             GCancellable *cancellable,
                                                             GError **error);
 
+void                secret_item_set_secret_if_changed      (SecretItem *self,
+                                                            SecretValue *value,
+                                                            GCancellable *cancellable,
+                                                            GAsyncReadyCallback callback,
+                                                            gpointer user_data);
+
+gboolean            secret_item_set_secret_if_changed_finish (SecretItem *self,
+                                                              GAsyncResult *result,
+                                                              gboolean *written,
+                                                              GError **error);
+
+gboolean            secret_item_set_secret_if_changed_sync (SecretItem *self,
+                                                            SecretValue *value,
+                                                            GCancellable *cancellable,
+                                                            gboolean *written,
+                                                            GError **error);
+
 gchar *             secret_item_get_schema_name            (SecretItem *self);
 
 GHashTable*         secret_item_get_attributes             (SecretItem *self);
@@ -168,6 +185,25 @@ gboolean            secret_item_set_attributes_sync        (SecretItem *self,
                                                             GCancellable *cancellable,
                                                             GError **error);
 
+void                secret_item_set_attributes_if_changed  (SecretItem *self,
+                                                            const SecretSchema *schema,
+                                                            GHashTable *attributes,
+                                                            GCancellable *cancellable,
+                                                            GAsyncReadyCallback callback,
+                                                            gpointer user_data);
+
+gboolean            secret_item_set_attributes_if_changed_finish (SecretItem *self,
+                                                                  GAsyncResult *result,
+                                                                  gboolean *written,
+                                                                  GError **error);
+
+gboolean            secret_item_set_attributes_if_changed_sync (SecretItem *self,
+                                                                const SecretSchema *schema,
+                                                                GHashTable *attributes,
+                                                                GCancellable *cancellable,
+                                                                gboolean *written,
+                                                                GError **error);
+
 gchar *             secret_item_get_label                  (SecretItem *self);
 
 void                secret_item_set_label                  (SecretItem *self,
@@ -26,6 +26,8 @@
 
 #include <glib/gi18n-lib.h>
 
+#include <string.h>
+
 /**
  * SecretSearchFlags:
  * @SECRET_SEARCH_NONE: no flags
@@ -45,6 +47,7 @@ typedef struct {
 	guint loading;
 	SecretSearchFlags flags;
 	GVariant *attributes;
+	gpointer unlock_set;
 } SearchClosure;
 
 static void
@@ -57,6 +60,7 @@ search_closure_free (gpointer data)
 	g_variant_unref (closure->attributes);
 	g_strfreev (closure->unlocked);
 	g_strfreev (closure->locked);
+	_secret_service_unlock_set_leave (closure->unlock_set);
 	g_slice_free (SearchClosure, closure);
 }
 
@@ -135,8 +139,11 @@ secret_search_unlock_load_or_complete (GSimpleAsyncResult *async,
 	/* If unlocking then unlock all the locked items */
 	if (search->flags & SECRET_SEARCH_UNLOCK) {
 		items = search_closure_build_items (search, search->locked);
+		_secret_service_unlock_set_enter (search->unlock_set);
 		secret_service_unlock (search->service, items, search->cancellable,
 		                       on_search_unlocked, g_object_ref (async));
+		_secret_service_unlock_set_leave (search->unlock_set);
+		search->unlock_set = NULL;
 		g_list_free_full (items, g_object_unref);
 
 	/* If loading secrets ... locked items automatically ignored */
@@ -227,6 +234,8 @@ on_search_paths (GObject *source,
 			secret_search_unlock_load_or_complete (res, closure);
 
 	} else {
+		_secret_service_unlock_set_leave (closure->unlock_set);
+		closure->unlock_set = NULL;
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 	}
@@ -322,6 +331,8 @@ secret_service_search (SecretService *service,
 
 	if (service) {
 		closure->service = g_object_ref (service);
+		if (flags & SECRET_SEARCH_UNLOCK)
+			closure->unlock_set = _secret_service_unlock_set_join (service);
 		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
 		                                          closure->cancellable, on_search_paths,
 		                                          g_object_ref (res));
@@ -952,6 +963,62 @@ secret_service_unlock_sync (SecretService *service,
 	return count;
 }
 
+/**
+ * secret_service_begin_unlock_set:
+ * @service: the secret service
+ *
+ * Start collecting unlock requests into an unlock set.
+ *
+ * Until the matching call to secret_service_end_unlock_set(), calls to
+ * secret_service_unlock() and secret_service_unlock_dbus_paths() made on
+ * @service from the thread default main context are held back instead of
+ * being sent to the secret service.
+ *
+ * The asynchronous secret_service_search() and secret_collection_search()
+ * with %SECRET_SEARCH_UNLOCK, and secret_service_lookup(), that are started
+ * on @service while the set is open also join it. These only know what to
+ * unlock once their search completes, so the set is not sent until each of
+ * them has either asked to unlock its items or finished without doing so.
+ * Synchronous functions run their own main context and are never part of
+ * an unlock set.
+ *
+ * Calls may be nested, and the set is only ended by the outermost
+ * secret_service_end_unlock_set(). This must happen before control returns
+ * to the thread default main context. A set still open at that point is
+ * ended then, with a warning.
+ */
+void
+secret_service_begin_unlock_set (SecretService *service)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (service));
+
+	_secret_service_unlock_set_begin (service);
+}
+
+/**
+ * secret_service_end_unlock_set:
+ * @service: the secret service
+ *
+ * Send the unlock requests collected since secret_service_begin_unlock_set(),
+ * as soon as every operation that joined the set has made its request.
+ *
+ * Everything in the set is unlocked with a single call to the secret service,
+ * so the user sees at most one prompt. Each request then completes with the
+ * items or collections it asked for. Should unlocking the set as a whole
+ * fail, each request is retried on its own so that one bad request does not
+ * fail the others.
+ *
+ * Requests in the set that are cancelled complete right away, the others
+ * are not affected.
+ */
+void
+secret_service_end_unlock_set (SecretService *service)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (service));
+
+	_secret_service_unlock_set_end (service);
+}
+
 typedef struct {
 	GCancellable *cancellable;
 	gchar *collection_path;
@@ -973,11 +1040,58 @@ store_closure_free (gpointer data)
 	g_slice_free (StoreClosure, store);
 }
 
+static GHashTable *
+store_properties_new (const SecretSchema *schema,
+                      GHashTable *attributes,
+                      const gchar *label)
+{
+	GHashTable *properties;
+	const gchar *schema_name;
+	GVariant *propval;
+
+	properties = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+	                                    (GDestroyNotify)g_variant_unref);
+
+	propval = g_variant_new_string (label);
+	g_hash_table_insert (properties,
+	                     SECRET_ITEM_INTERFACE ".Label",
+	                     g_variant_ref_sink (propval));
+
+	/* Always store the schema name in the attributes */
+	schema_name = (schema == NULL) ? NULL : schema->name;
+	propval = _secret_attributes_to_variant (attributes, schema_name);
+	g_hash_table_insert (properties,
+	                     SECRET_ITEM_INTERFACE ".Attributes",
+	                     g_variant_ref_sink (propval));
+
+	return properties;
+}
+
+static const gchar *
+store_alias (const gchar *collection_path)
+{
+	if (g_str_has_prefix (collection_path, SECRET_ALIAS_PREFIX))
+		return collection_path + strlen (SECRET_ALIAS_PREFIX);
+	return NULL;
+}
+
 static void
 on_store_create (GObject *source,
                  GAsyncResult *result,
                  gpointer user_data);
 
+static void
+store_create_item (SecretService *service,
+                   GSimpleAsyncResult *async)
+{
+	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
+
+	secret_service_create_item_dbus_path (service, store->collection_path,
+	                                      store->properties, store->value,
+	                                      SECRET_ITEM_CREATE_REPLACE, store->cancellable,
+	                                      on_store_create, g_object_ref (async));
+}
+
 static void
 on_store_keyring (GObject *source,
                   GAsyncResult *result,
@@ -992,10 +1106,8 @@ on_store_keyring (GObject *source,
 	path = secret_service_create_collection_dbus_path_finish (service, result, &error);
 	if (error == NULL) {
 		store->created_collection = TRUE;
-		secret_service_create_item_dbus_path (service, store->collection_path,
-		                                      store->properties, store->value,
-		                                      SECRET_ITEM_CREATE_REPLACE, store->cancellable,
-		                                      on_store_create, g_object_ref (async));
+		_secret_service_cache_alias (service, "default", path);
+		store_create_item (service, async);
 	} else {
 		g_simple_async_result_take_error (async, error);
 		g_simple_async_result_complete (async);
@@ -1005,6 +1117,20 @@ on_store_keyring (GObject *source,
 	g_free (path);
 }
 
+static void
+store_create_keyring (SecretService *service,
+                      GSimpleAsyncResult *async)
+{
+	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
+	GHashTable *properties;
+
+	properties = _secret_collection_properties_new (_("Default keyring"));
+	secret_service_create_collection_dbus_path (service, properties, "default",
+	                                            SECRET_COLLECTION_CREATE_NONE, store->cancellable,
+	                                            on_store_keyring, g_object_ref (async));
+	g_hash_table_unref (properties);
+}
+
 static void
 on_store_unlock (GObject *source,
                  GAsyncResult *result,
@@ -1018,10 +1144,9 @@ on_store_unlock (GObject *source,
 	secret_service_unlock_dbus_paths_finish (service, result, NULL, &error);
 	if (error == NULL) {
 		store->unlocked_collection = TRUE;
-		secret_service_create_item_dbus_path (service, store->collection_path,
-		                                      store->properties, store->value,
-		                                      SECRET_ITEM_CREATE_REPLACE, store->cancellable,
-		                                      on_store_create, g_object_ref (async));
+		if (store_alias (store->collection_path))
+			_secret_service_set_alias_locked (service, store_alias (store->collection_path), FALSE);
+		store_create_item (service, async);
 	} else {
 		g_simple_async_result_take_error (async, error);
 		g_simple_async_result_complete (async);
@@ -1030,6 +1155,48 @@ on_store_unlock (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+store_unlock_collection (SecretService *service,
+                         GSimpleAsyncResult *async)
+{
+	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
+	const gchar *paths[2] = { store->collection_path, NULL };
+
+	secret_service_unlock_dbus_paths (service, paths, store->cancellable,
+	                                  on_store_unlock, g_object_ref (async));
+}
+
+static void
+store_remember_alias (SecretService *service,
+                      const gchar *collection_path,
+                      const gchar *item_path,
+                      GError *error)
+{
+	const gchar *alias = store_alias (collection_path);
+	gchar *parent;
+
+	if (alias == NULL)
+		return;
+
+	/* The item path tells which collection the alias refers to */
+	if (error == NULL) {
+		if (_secret_service_lookup_alias (service, alias, NULL, NULL)) {
+			_secret_service_set_alias_locked (service, alias, FALSE);
+		} else if (item_path != NULL) {
+			parent = _secret_util_parent_path (item_path);
+			_secret_service_cache_alias (service, alias, parent);
+			g_free (parent);
+		}
+
+	} else if (g_error_matches (error, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT) ||
+	           g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		_secret_service_cache_alias (service, alias, NULL);
+
+	} else if (g_error_matches (error, SECRET_ERROR, SECRET_ERROR_IS_LOCKED)) {
+		_secret_service_set_alias_locked (service, alias, TRUE);
+	}
+}
+
 static void
 on_store_create (GObject *source,
                  GAsyncResult *result,
@@ -1039,9 +1206,11 @@ on_store_create (GObject *source,
 	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
 	SecretService *service = SECRET_SERVICE (source);
 	GError *error = NULL;
-	GHashTable *properties;
+	gchar *item_path;
 
-	_secret_service_create_item_dbus_path_finish_raw (result, &error);
+	item_path = _secret_service_create_item_dbus_path_finish_raw (result, &error);
+	store_remember_alias (service, store->collection_path, item_path, error);
+	g_free (item_path);
 
 	/*
 	 * This happens when the collection doesn't exist. If the collection is
@@ -1052,18 +1221,12 @@ on_store_create (GObject *source,
 	    (g_error_matches (error, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT) ||
 	     g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) &&
 	    g_strcmp0 (store->collection_path, SECRET_ALIAS_PREFIX "default") == 0) {
-		properties = _secret_collection_properties_new (_("Default keyring"));
-		secret_service_create_collection_dbus_path (service, properties, "default",
-		                                            SECRET_COLLECTION_CREATE_NONE, store->cancellable,
-		                                            on_store_keyring, g_object_ref (async));
-		g_hash_table_unref (properties);
+		store_create_keyring (service, async);
 		g_error_free (error);
 
 	} else if (!store->unlocked_collection &&
 	           g_error_matches (error, SECRET_ERROR, SECRET_ERROR_IS_LOCKED)) {
-		const gchar *paths[2] = { store->collection_path, NULL };
-		secret_service_unlock_dbus_paths (service, paths, store->cancellable,
-		                                  on_store_unlock, g_object_ref (async));
+		store_unlock_collection (service, async);
 		g_error_free (error);
 	} else {
 		if (error != NULL)
@@ -1074,22 +1237,41 @@ on_store_create (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+store_begin (SecretService *service,
+             GSimpleAsyncResult *async)
+{
+	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
+	gchar *collection_path = NULL;
+	gboolean locked = FALSE;
+	const gchar *alias;
+
+	/* Skip a CreateItem that is already known to fail */
+	alias = store_alias (store->collection_path);
+	if (alias == NULL || !_secret_service_lookup_alias (service, alias, &collection_path, &locked))
+		store_create_item (service, async);
+	else if (collection_path == NULL && g_str_equal (alias, "default"))
+		store_create_keyring (service, async);
+	else if (locked)
+		store_unlock_collection (service, async);
+	else
+		store_create_item (service, async);
+
+	g_free (collection_path);
+}
+
 static void
 on_store_service (GObject *source,
                   GAsyncResult *result,
                   gpointer user_data)
 {
 	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
-	StoreClosure *store = g_simple_async_result_get_op_res_gpointer (async);
 	SecretService *service;
 	GError *error = NULL;
 
 	service = secret_service_get_finish (result, &error);
 	if (error == NULL) {
-		secret_service_create_item_dbus_path (service, store->collection_path,
-		                                      store->properties, store->value,
-		                                      SECRET_ITEM_CREATE_REPLACE, store->cancellable,
-		                                      on_store_create, g_object_ref (async));
+		store_begin (service, async);
 		g_object_unref (service);
 
 	} else {
@@ -1141,8 +1323,6 @@ secret_service_store (SecretService *service,
 {
 	GSimpleAsyncResult *async;
 	StoreClosure *store;
-	const gchar *schema_name;
-	GVariant *propval;
 
 	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
 	g_return_if_fail (attributes != NULL);
@@ -1160,20 +1340,7 @@ secret_service_store (SecretService *service,
 	store->collection_path = _secret_util_collection_to_path (collection);
 	store->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
 	store->value = secret_value_ref (value);
-	store->properties = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
-	                                           (GDestroyNotify)g_variant_unref);
-
-	propval = g_variant_new_string (label);
-	g_hash_table_insert (store->properties,
-	                     SECRET_ITEM_INTERFACE ".Label",
-	                     g_variant_ref_sink (propval));
-
-	/* Always store the schema name in the attributes */
-	schema_name = (schema == NULL) ? NULL : schema->name;
-	propval = _secret_attributes_to_variant (attributes, schema_name);
-	g_hash_table_insert (store->properties,
-	                     SECRET_ITEM_INTERFACE ".Attributes",
-	                     g_variant_ref_sink (propval));
+	store->properties = store_properties_new (schema, attributes, label);
 
 	g_simple_async_result_set_op_res_gpointer (async, store, store_closure_free);
 
@@ -1182,10 +1349,7 @@ secret_service_store (SecretService *service,
 		                    on_store_service, g_object_ref (async));
 
 	} else {
-		secret_service_create_item_dbus_path (service, store->collection_path,
-		                                      store->properties, store->value,
-		                                      SECRET_ITEM_CREATE_REPLACE, store->cancellable,
-		                                      on_store_create, g_object_ref (async));
+		store_begin (service, async);
 	}
 
 	g_object_unref (async);
@@ -1257,7 +1421,15 @@ secret_service_store_sync (SecretService *service,
                            GCancellable *cancellable,
                            GError **error)
 {
+	GHashTable *properties;
+	GError *lerror = NULL;
+	gchar *alias_path = NULL;
+	gchar *collection_path;
+	gboolean prompt = FALSE;
+	gboolean locked = FALSE;
+	const gchar *alias;
 	SecretSync *sync;
+	gchar *path;
 	gboolean ret;
 
 	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
@@ -1271,6 +1443,52 @@ secret_service_store_sync (SecretService *service,
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
 		return FALSE;
 
+	if (service == NULL) {
+		service = secret_service_get_sync (SECRET_SERVICE_OPEN_SESSION, cancellable, error);
+		if (service == NULL)
+			return FALSE;
+	} else {
+		g_object_ref (service);
+	}
+
+	collection_path = _secret_util_collection_to_path (collection);
+
+	/*
+	 * A missing default collection or a locked collection mean prompting,
+	 * so those are handed over to the asynchronous implementation below.
+	 */
+	alias = store_alias (collection_path);
+	if (alias != NULL && _secret_service_lookup_alias (service, alias, &alias_path, &locked))
+		prompt = locked || alias_path == NULL;
+
+	/* Otherwise try to create the item directly, without a main loop */
+	if (!prompt) {
+		properties = store_properties_new (schema, attributes, label);
+		path = secret_service_create_item_dbus_path_sync (service, collection_path, properties,
+		                                                  value, SECRET_ITEM_CREATE_REPLACE,
+		                                                  cancellable, &lerror);
+		store_remember_alias (service, collection_path, path, lerror);
+		g_hash_table_unref (properties);
+		g_free (path);
+
+		prompt = g_error_matches (lerror, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT) ||
+		         g_error_matches (lerror, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD) ||
+		         g_error_matches (lerror, SECRET_ERROR, SECRET_ERROR_IS_LOCKED);
+	}
+
+	g_free (collection_path);
+	g_free (alias_path);
+
+	if (!prompt) {
+		g_object_unref (service);
+		if (lerror == NULL)
+			return TRUE;
+		g_propagate_error (error, lerror);
+		return FALSE;
+	}
+
+	g_clear_error (&lerror);
+
 	sync = _secret_sync_new ();
 	g_main_context_push_thread_default (sync->context);
 
@@ -1284,130 +1502,202 @@ secret_service_store_sync (SecretService *service,
 	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
+	g_object_unref (service);
 	return ret;
 }
 
 typedef struct {
-	GVariant *attributes;
-	SecretValue *value;
+	SecretService *service;
 	GCancellable *cancellable;
-} LookupClosure;
+	const SecretSchema *schema;
+	GHashTable *attributes;
+	gchar *collection;
+	gchar *collection_path;
+	gchar *label;
+	SecretValue *value;
+	SecretAttributes *wanted;
+	gboolean written;
+} StoreIfChangedClosure;
 
 static void
-lookup_closure_free (gpointer data)
+store_if_changed_closure_free (gpointer data)
 {
-	LookupClosure *closure = data;
-	g_variant_unref (closure->attributes);
-	if (closure->value)
-		secret_value_unref (closure->value);
+	StoreIfChangedClosure *closure = data;
+	g_clear_object (&closure->service);
 	g_clear_object (&closure->cancellable);
-	g_slice_free (LookupClosure, closure);
+	_secret_schema_unref_if_nonstatic (closure->schema);
+	g_hash_table_unref (closure->attributes);
+	g_free (closure->collection);
+	g_free (closure->collection_path);
+	g_free (closure->label);
+	secret_value_unref (closure->value);
+	_secret_attributes_unref (closure->wanted);
+	g_slice_free (StoreIfChangedClosure, closure);
+}
+
+static gboolean
+store_if_changed_matches (StoreIfChangedClosure *closure,
+                          SecretItem *item)
+{
+	SecretAttributes *attrs;
+	SecretValue *value;
+	gboolean same;
+	gchar *label;
+	gchar *parent;
+
+	parent = _secret_util_parent_path (g_dbus_proxy_get_object_path (G_DBUS_PROXY (item)));
+	same = g_strcmp0 (parent, closure->collection_path) == 0;
+	g_free (parent);
+
+	if (same) {
+		attrs = _secret_item_ref_attributes (item);
+		same = _secret_attributes_equal (attrs, closure->wanted);
+		_secret_attributes_unref (attrs);
+	}
+
+	if (same) {
+		label = secret_item_get_label (item);
+		same = g_strcmp0 (label, closure->label) == 0;
+		g_free (label);
+	}
+
+	/* Locked items have no secret loaded, and are always written */
+	if (same) {
+		value = secret_item_get_secret (item);
+		same = value != NULL && _secret_value_equal (value, closure->value);
+		if (value != NULL)
+			secret_value_unref (value);
+	}
+
+	return same;
 }
 
 static void
-on_lookup_get_secret (GObject *source,
-                      GAsyncResult *result,
-                      gpointer user_data)
+on_store_if_changed_stored (GObject *source,
+                            GAsyncResult *result,
+                            gpointer user_data)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
 	GError *error = NULL;
 
-	closure->value = secret_service_get_secret_for_dbus_path_finish (self, result, &error);
-	if (error != NULL)
-		g_simple_async_result_take_error (res, error);
+	if (secret_service_store_finish (closure->service, result, &error))
+		closure->written = TRUE;
+	else
+		g_simple_async_result_take_error (async, error);
 
-	g_simple_async_result_complete (res);
-	g_object_unref (res);
+	g_simple_async_result_complete (async);
+	g_object_unref (async);
 }
 
 static void
-on_lookup_unlocked (GObject *source,
-                    GAsyncResult *result,
-                    gpointer user_data)
+store_if_changed_write (GSimpleAsyncResult *async)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+
+	secret_service_store (closure->service, closure->schema, closure->attributes,
+	                      closure->collection, closure->label, closure->value,
+	                      closure->cancellable, on_store_if_changed_stored,
+	                      g_object_ref (async));
+}
+
+static void
+on_store_if_changed_search (GObject *source,
+                            GAsyncResult *result,
+                            gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
 	GError *error = NULL;
-	gchar **unlocked = NULL;
+	gboolean same = FALSE;
+	GList *items, *l;
+
+	items = secret_service_search_finish (closure->service, result, &error);
+	for (l = items; !same && l != NULL; l = g_list_next (l))
+		same = store_if_changed_matches (closure, l->data);
+	g_list_free_full (items, g_object_unref);
 
-	secret_service_unlock_dbus_paths_finish (SECRET_SERVICE (source),
-	                                         result, &unlocked, &error);
 	if (error != NULL) {
-		g_simple_async_result_take_error (res, error);
-		g_simple_async_result_complete (res);
+		g_simple_async_result_take_error (async, error);
+		g_simple_async_result_complete (async);
 
-	} else if (unlocked && unlocked[0]) {
-		secret_service_get_secret_for_dbus_path (self, unlocked[0],
-		                                         closure->cancellable,
-		                                         on_lookup_get_secret,
-		                                         g_object_ref (res));
+	} else if (same) {
+		g_simple_async_result_complete (async);
 
 	} else {
-		g_simple_async_result_complete (res);
+		store_if_changed_write (async);
 	}
 
-	g_strfreev (unlocked);
-	g_object_unref (res);
+	g_object_unref (async);
 }
 
 static void
-on_lookup_searched (GObject *source,
-                    GAsyncResult *result,
-                    gpointer user_data)
+store_if_changed_search (GSimpleAsyncResult *async)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
-	GError *error = NULL;
-	gchar **unlocked = NULL;
-	gchar **locked = NULL;
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+	GHashTable *attributes;
+
+	/* Look for an item with exactly these attributes, and its secret */
+	attributes = _secret_attributes_to_table (closure->wanted);
+	secret_service_search (closure->service, NULL, attributes,
+	                       SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS,
+	                       closure->cancellable, on_store_if_changed_search,
+	                       g_object_ref (async));
+	g_hash_table_unref (attributes);
+}
 
-	secret_service_search_for_dbus_paths_finish (self, result, &unlocked, &locked, &error);
-	if (error != NULL) {
-		g_simple_async_result_take_error (res, error);
-		g_simple_async_result_complete (res);
+static void
+on_store_if_changed_alias (GObject *source,
+                           GAsyncResult *result,
+                           gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+	GError *error = NULL;
+	gchar *path;
 
-	} else if (unlocked && unlocked[0]) {
-		secret_service_get_secret_for_dbus_path (self, unlocked[0],
-		                                         closure->cancellable,
-		                                         on_lookup_get_secret,
-		                                         g_object_ref (res));
+	path = secret_service_read_alias_dbus_path_finish (closure->service, result, &error);
 
-	} else if (locked && locked[0]) {
-		const gchar *paths[] = { locked[0], NULL };
-		secret_service_unlock_dbus_paths (self, paths,
-		                                  closure->cancellable,
-		                                  on_lookup_unlocked,
-		                                  g_object_ref (res));
+	/* No such collection yet, so nothing to compare against */
+	if (error != NULL || path == NULL) {
+		g_clear_error (&error);
+		store_if_changed_write (async);
 
 	} else {
-		g_simple_async_result_complete (res);
+		g_free (closure->collection_path);
+		closure->collection_path = path;
+		store_if_changed_search (async);
 	}
 
-	g_strfreev (unlocked);
-	g_strfreev (locked);
-	g_object_unref (res);
+	g_object_unref (async);
 }
 
 static void
-on_lookup_service (GObject *source,
-                   GAsyncResult *result,
-                   gpointer user_data)
+store_if_changed_begin (GSimpleAsyncResult *async)
+{
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+	const gchar *alias;
+
+	alias = store_alias (closure->collection_path);
+	if (alias != NULL)
+		secret_service_read_alias_dbus_path (closure->service, alias, closure->cancellable,
+		                                     on_store_if_changed_alias, g_object_ref (async));
+	else
+		store_if_changed_search (async);
+}
+
+static void
+on_store_if_changed_service (GObject *source,
+                             GAsyncResult *result,
+                             gpointer user_data)
 {
 	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *lookup = g_simple_async_result_get_op_res_gpointer (async);
-	SecretService *service;
+	StoreIfChangedClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
 	GError *error = NULL;
 
-	service = secret_service_get_finish (result, &error);
+	closure->service = secret_service_get_finish (result, &error);
 	if (error == NULL) {
-		_secret_service_search_for_paths_variant (service, lookup->attributes,
-		                                          lookup->cancellable,
-		                                          on_lookup_searched, g_object_ref (async));
-		g_object_unref (service);
+		store_if_changed_begin (async);
 
 	} else {
 		g_simple_async_result_take_error (async, error);
@@ -1418,17 +1708,26 @@ on_lookup_service (GObject *source,
 }
 
 /**
- * secret_service_lookup:
+ * secret_service_store_if_changed:
  * @service: (allow-none): the secret service
- * @schema: (allow-none): the schema for the attributes
+ * @schema: (allow-none): the schema to use to check attributes
  * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the
+ *              collection where to store the secret
+ * @label: label for the secret
+ * @value: the secret value
  * @cancellable: optional cancellation object
  * @callback: called when the operation completes
  * @user_data: data to be passed to the callback
  *
- * Lookup a secret value in the secret service.
+ * Store a secret value in the secret service, but only if that changes
+ * anything.
  *
- * The @attributes should be a set of key and value string pairs.
+ * This is like secret_service_store(), except that when an item with
+ * exactly the same attributes, label and secret value already exists in
+ * the collection, nothing is written. The existing item is found with a
+ * search, and its secret is compared in non-pageable memory. Items which
+ * are locked are always written.
  *
  * If @service is NULL, then secret_service_get() will be called to get
  * the default #SecretService proxy.
@@ -1436,20 +1735,330 @@ on_lookup_service (GObject *source,
  * This method will return immediately and complete asynchronously.
  */
 void
-secret_service_lookup (SecretService *service,
-                       const SecretSchema *schema,
-                       GHashTable *attributes,
-                       GCancellable *cancellable,
-                       GAsyncReadyCallback callback,
-                       gpointer user_data)
+secret_service_store_if_changed (SecretService *service,
+                                 const SecretSchema *schema,
+                                 GHashTable *attributes,
+                                 const gchar *collection,
+                                 const gchar *label,
+                                 SecretValue *value,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
 {
-	const gchar *schema_name = NULL;
-	GSimpleAsyncResult *res;
-	LookupClosure *closure;
+	StoreIfChangedClosure *closure;
+	GSimpleAsyncResult *async;
 
 	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
 	g_return_if_fail (attributes != NULL);
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (label != NULL);
+	g_return_if_fail (value != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
+		return;
+
+	async = g_simple_async_result_new  (G_OBJECT (service), callback, user_data,
+	                                    secret_service_store_if_changed);
+	closure = g_slice_new0 (StoreIfChangedClosure);
+	closure->service = service ? g_object_ref (service) : NULL;
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->schema = _secret_schema_ref_if_nonstatic (schema);
+	closure->attributes = _secret_attributes_copy (attributes);
+	closure->collection = g_strdup (collection);
+	closure->collection_path = _secret_util_collection_to_path (collection);
+	closure->label = g_strdup (label);
+	closure->value = secret_value_ref (value);
+	closure->wanted = _secret_attributes_new_for_table (attributes, schema ? schema->name : NULL);
+	g_simple_async_result_set_op_res_gpointer (async, closure, store_if_changed_closure_free);
+
+	if (service == NULL) {
+		secret_service_get (SECRET_SERVICE_OPEN_SESSION, cancellable,
+		                    on_store_if_changed_service, g_object_ref (async));
+
+	} else {
+		store_if_changed_begin (async);
+	}
+
+	g_object_unref (async);
+}
+
+/**
+ * secret_service_store_if_changed_finish:
+ * @service: (allow-none): the secret service
+ * @result: the asynchronous result passed to the callback
+ * @written: (out) (allow-none): location to place whether anything was written
+ * @error: location to place an error on failure
+ *
+ * Finish asynchronous operation to store a secret value in the secret
+ * service if it changed.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_service_store_if_changed_finish (SecretService *service,
+                                        GAsyncResult *result,
+                                        gboolean *written,
+                                        GError **error)
+{
+	StoreIfChangedClosure *closure;
+	GSimpleAsyncResult *async;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                                                      secret_service_store_if_changed), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	async = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (async, error))
+		return FALSE;
+
+	closure = g_simple_async_result_get_op_res_gpointer (async);
+	if (written)
+		*written = closure->written;
+	return TRUE;
+}
+
+/**
+ * secret_service_store_if_changed_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the
+ *              collection where to store the secret
+ * @label: label for the secret
+ * @value: the secret value
+ * @cancellable: optional cancellation object
+ * @written: (out) (allow-none): location to place whether anything was written
+ * @error: location to place an error on failure
+ *
+ * Store a secret value in the secret service, but only if that changes
+ * anything.
+ *
+ * This is like secret_service_store_sync(), except that when an item with
+ * exactly the same attributes, label and secret value already exists in
+ * the collection, nothing is written. Items which are locked are always
+ * written.
+ *
+ * If @service is NULL, then secret_service_get_sync() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: whether the operation was successful or not
+ */
+gboolean
+secret_service_store_if_changed_sync (SecretService *service,
+                                      const SecretSchema *schema,
+                                      GHashTable *attributes,
+                                      const gchar *collection,
+                                      const gchar *label,
+                                      SecretValue *value,
+                                      GCancellable *cancellable,
+                                      gboolean *written,
+                                      GError **error)
+{
+	SecretSync *sync;
+	gboolean ret;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (attributes != NULL, FALSE);
+	g_return_val_if_fail (label != NULL, FALSE);
+	g_return_val_if_fail (value != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
+		return FALSE;
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_service_store_if_changed (service, schema, attributes, collection,
+	                                 label, value, cancellable, _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	ret = secret_service_store_if_changed_finish (service, sync->result, written, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return ret;
+}
+
+typedef struct {
+	GVariant *attributes;
+	SecretValue *value;
+	GCancellable *cancellable;
+	gpointer unlock_set;
+} LookupClosure;
+
+static void
+lookup_closure_free (gpointer data)
+{
+	LookupClosure *closure = data;
+	g_variant_unref (closure->attributes);
+	if (closure->value)
+		secret_value_unref (closure->value);
+	g_clear_object (&closure->cancellable);
+	_secret_service_unlock_set_leave (closure->unlock_set);
+	g_slice_free (LookupClosure, closure);
+}
+
+static void
+on_lookup_get_secret (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+
+	closure->value = secret_service_get_secret_for_dbus_path_finish (self, result, &error);
+	if (error != NULL)
+		g_simple_async_result_take_error (res, error);
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_unlocked (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+
+	secret_service_unlock_dbus_paths_finish (SECRET_SERVICE (source),
+	                                         result, &unlocked, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (unlocked && unlocked[0]) {
+		secret_service_get_secret_for_dbus_path (self, unlocked[0],
+		                                         closure->cancellable,
+		                                         on_lookup_get_secret,
+		                                         g_object_ref (res));
+
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (unlocked);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_searched (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+	gchar **locked = NULL;
+
+	secret_service_search_for_dbus_paths_finish (self, result, &unlocked, &locked, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (unlocked && unlocked[0]) {
+		secret_service_get_secret_for_dbus_path (self, unlocked[0],
+		                                         closure->cancellable,
+		                                         on_lookup_get_secret,
+		                                         g_object_ref (res));
+
+	} else if (locked && locked[0]) {
+		const gchar *paths[] = { locked[0], NULL };
+		_secret_service_unlock_set_enter (closure->unlock_set);
+		secret_service_unlock_dbus_paths (self, paths,
+		                                  closure->cancellable,
+		                                  on_lookup_unlocked,
+		                                  g_object_ref (res));
+
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	/* Whether or not it unlocked anything, the lookup is done with the set */
+	_secret_service_unlock_set_leave (closure->unlock_set);
+	closure->unlock_set = NULL;
+
+	g_strfreev (unlocked);
+	g_strfreev (locked);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_service (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *lookup = g_simple_async_result_get_op_res_gpointer (async);
+	SecretService *service;
+	GError *error = NULL;
+
+	service = secret_service_get_finish (result, &error);
+	if (error == NULL) {
+		_secret_service_search_for_paths_variant (service, lookup->attributes,
+		                                          lookup->cancellable,
+		                                          on_lookup_searched, g_object_ref (async));
+		g_object_unref (service);
+
+	} else {
+		g_simple_async_result_take_error (async, error);
+		g_simple_async_result_complete (async);
+	}
+
+	g_object_unref (async);
+}
+
+/**
+ * secret_service_lookup:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Lookup a secret value in the secret service.
+ *
+ * The @attributes should be a set of key and value string pairs.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_service_lookup (SecretService *service,
+                       const SecretSchema *schema,
+                       GHashTable *attributes,
+                       GCancellable *cancellable,
+                       GAsyncReadyCallback callback,
+                       gpointer user_data)
+{
+	const gchar *schema_name = NULL;
+	GSimpleAsyncResult *res;
+	LookupClosure *closure;
+
+	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
 	/* Warnings raised already */
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
@@ -1470,6 +2079,7 @@ secret_service_lookup (SecretService *service,
 		secret_service_get (SECRET_SERVICE_OPEN_SESSION, cancellable,
 		                    on_lookup_service, g_object_ref (res));
 	} else {
+		closure->unlock_set = _secret_service_unlock_set_join (service);
 		_secret_service_search_for_paths_variant (service, closure->attributes,
 		                                          closure->cancellable,
 		                                          on_lookup_searched, g_object_ref (res));
@@ -1497,33 +2107,305 @@ secret_service_lookup_finish (SecretService *service,
                               GError **error)
 {
 	GSimpleAsyncResult *res;
-	LookupClosure *closure;
-	SecretValue *value;
+	LookupClosure *closure;
+	SecretValue *value;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                      secret_service_lookup), NULL);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return NULL;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	value = closure->value;
+	closure->value = NULL;
+	return value;
+}
+
+/**
+ * secret_service_lookup_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Lookup a secret value in the secret service.
+ *
+ * The @attributes should be a set of key and value string pairs.
+ *
+ * If @service is NULL, then secret_service_get_sync() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: (transfer full): a newly allocated #SecretValue, which should be
+ *          released with secret_value_unref(), or %NULL if no secret found
+ */
+SecretValue *
+secret_service_lookup_sync (SecretService *service,
+                            const SecretSchema *schema,
+                            GHashTable *attributes,
+                            GCancellable *cancellable,
+                            GError **error)
+{
+	SecretValue *value = NULL;
+	gchar **unlocked = NULL;
+	gchar **locked = NULL;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (attributes != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return NULL;
+
+	if (service == NULL) {
+		service = secret_service_get_sync (SECRET_SERVICE_OPEN_SESSION, cancellable, error);
+		if (service == NULL)
+			return NULL;
+	} else {
+		g_object_ref (service);
+	}
+
+	if (!secret_service_search_for_dbus_paths_sync (service, schema, attributes, cancellable,
+	                                                &unlocked, &locked, error)) {
+		g_object_unref (service);
+		return NULL;
+	}
+
+	/* Only unlocking may prompt, and so need a main loop */
+	if ((unlocked == NULL || unlocked[0] == NULL) && locked && locked[0]) {
+		const gchar *paths[] = { locked[0], NULL };
+		g_strfreev (unlocked);
+		unlocked = NULL;
+		if (secret_service_unlock_dbus_paths_sync (service, paths, cancellable,
+		                                           &unlocked, error) < 0) {
+			g_strfreev (locked);
+			g_object_unref (service);
+			return NULL;
+		}
+	}
+
+	if (unlocked && unlocked[0])
+		value = secret_service_get_secret_for_dbus_path_sync (service, unlocked[0],
+		                                                      cancellable, error);
+
+	g_strfreev (unlocked);
+	g_strfreev (locked);
+	g_object_unref (service);
+	return value;
+}
+
+typedef struct {
+	GCancellable *cancellable;
+	SecretService *service;
+	GVariant *attributes;
+	gint deleted;
+	gint deleting;
+} DeleteClosure;
+
+static void
+delete_closure_free (gpointer data)
+{
+	DeleteClosure *closure = data;
+	if (closure->service)
+		g_object_unref (closure->service);
+	g_variant_unref (closure->attributes);
+	g_clear_object (&closure->cancellable);
+	g_slice_free (DeleteClosure, closure);
+}
+
+static void
+on_delete_password_complete (GObject *source,
+                             GAsyncResult *result,
+                             gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	gboolean deleted;
+
+	closure->deleting--;
+
+	deleted = _secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error);
+	if (error != NULL)
+		g_simple_async_result_take_error (res, error);
+	if (deleted)
+		closure->deleted++;
+
+	if (closure->deleting <= 0)
+		g_simple_async_result_complete (res);
+
+	g_object_unref (res);
+}
+
+static void
+on_delete_searched (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+	gint i;
+
+	secret_service_search_for_dbus_paths_finish (SECRET_SERVICE (source), result, &unlocked, NULL, &error);
+	if (error == NULL) {
+		for (i = 0; unlocked[i] != NULL; i++) {
+			_secret_service_delete_path (closure->service, unlocked[i], TRUE,
+			                             closure->cancellable,
+			                             on_delete_password_complete,
+			                             g_object_ref (res));
+			closure->deleting++;
+		}
+
+		if (closure->deleting == 0)
+			g_simple_async_result_complete (res);
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (unlocked);
+	g_object_unref (res);
+}
+
+static void
+on_delete_service (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+	GError *error = NULL;
+
+	closure->service = secret_service_get_finish (result, &error);
+	if (error == NULL) {
+		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
+		                                          closure->cancellable,
+		                                          on_delete_searched, g_object_ref (async));
+
+	} else {
+		g_simple_async_result_take_error (async, error);
+		g_simple_async_result_complete (async);
+	}
+
+	g_object_unref (async);
+}
+
+/**
+ * secret_service_clear:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Remove unlocked items which match the attributes from the secret service.
+ *
+ * The @attributes should be a set of key and value string pairs.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_service_clear (SecretService *service,
+                      const SecretSchema *schema,
+                      GHashTable *attributes,
+                      GCancellable *cancellable,
+                      GAsyncReadyCallback callback,
+                      gpointer user_data)
+{
+	const gchar *schema_name = NULL;
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
+
+	g_return_if_fail (service == NULL || SECRET_SERVICE (service));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return;
+
+	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
+		schema_name = schema->name;
+
+	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
+	                                 secret_service_clear);
+	closure = g_slice_new0 (DeleteClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->attributes = _secret_attributes_to_variant (attributes, schema_name);
+	g_variant_ref_sink (closure->attributes);
+	g_simple_async_result_set_op_res_gpointer (res, closure, delete_closure_free);
+
+	/* A double check to make sure we don't delete everything, should have been checked earlier */
+	g_assert (g_variant_n_children (closure->attributes) > 0);
+
+	if (service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, cancellable,
+		                    on_delete_service, g_object_ref (res));
+	} else {
+		closure->service = g_object_ref (service);
+		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
+		                                          closure->cancellable,
+		                                          on_delete_searched, g_object_ref (res));
+	}
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_service_clear_finish:
+ * @service: (allow-none): the secret service
+ * @result: the asynchronous result passed to the callback
+ * @error: location to place an error on failure
+ *
+ * Finish asynchronous operation to remove items from the secret
+ * service.
+ *
+ * Returns: whether items were removed or not
+ */
+gboolean
+secret_service_clear_finish (SecretService *service,
+                             GAsyncResult *result,
+                             GError **error)
+{
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
 
-	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
-	                      secret_service_lookup), NULL);
+	                      secret_service_clear), FALSE);
 
 	res = G_SIMPLE_ASYNC_RESULT (result);
 	if (_secret_util_propagate_error (res, error))
-		return NULL;
+		return FALSE;
 
 	closure = g_simple_async_result_get_op_res_gpointer (res);
-	value = closure->value;
-	closure->value = NULL;
-	return value;
+	return closure->deleted > 0;
 }
 
 /**
- * secret_service_lookup_sync:
+ * secret_service_clear_sync:
  * @service: (allow-none): the secret service
  * @schema: (allow-none): the schema for the attributes
  * @attributes: (element-type utf8 utf8): the attribute keys and values
  * @cancellable: optional cancellation object
  * @error: location to place an error on failure
  *
- * Lookup a secret value in the secret service.
+ * Remove unlocked items which match the attributes from the secret service.
  *
  * The @attributes should be a set of key and value string pairs.
  *
@@ -1533,151 +2415,300 @@ secret_service_lookup_finish (SecretService *service,
  * This method may block indefinitely and should not be used in user interface
  * threads.
  *
- * Returns: (transfer full): a newly allocated #SecretValue, which should be
- *          released with secret_value_unref(), or %NULL if no secret found
+ * Returns: whether items were removed or not
  */
-SecretValue *
-secret_service_lookup_sync (SecretService *service,
-                            const SecretSchema *schema,
-                            GHashTable *attributes,
-                            GCancellable *cancellable,
-                            GError **error)
+gboolean
+secret_service_clear_sync (SecretService *service,
+                           const SecretSchema *schema,
+                           GHashTable *attributes,
+                           GCancellable *cancellable,
+                           GError **error)
 {
-	SecretSync *sync;
-	SecretValue *value;
+	const gchar *schema_name = NULL;
+	gchar **unlocked = NULL;
+	GError *lerror = NULL;
+	gint deleted = 0;
+	gint i;
 
-	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
-	g_return_val_if_fail (attributes != NULL, NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (attributes != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
 	/* Warnings raised already */
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
-		return NULL;
+		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
+	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
+		schema_name = schema->name;
 
-	secret_service_lookup (service, schema, attributes, cancellable,
-	                       _secret_sync_on_result, sync);
+	/* A double check to make sure we don't delete everything, should have been checked earlier */
+	g_assert (schema_name != NULL || g_hash_table_size (attributes) > 0);
 
-	g_main_loop_run (sync->loop);
+	if (service == NULL) {
+		service = secret_service_get_sync (SECRET_SERVICE_NONE, cancellable, error);
+		if (service == NULL)
+			return FALSE;
+	} else {
+		g_object_ref (service);
+	}
 
-	value = secret_service_lookup_finish (service, sync->result, error);
+	if (!secret_service_search_for_dbus_paths_sync (service, schema, attributes, cancellable,
+	                                                &unlocked, NULL, error)) {
+		g_object_unref (service);
+		return FALSE;
+	}
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	/* Each delete only runs a main loop if the service prompts */
+	for (i = 0; unlocked && unlocked[i] != NULL; i++) {
+		if (_secret_service_delete_path_sync (service, unlocked[i], TRUE, cancellable,
+		                                      lerror ? NULL : &lerror))
+			deleted++;
+	}
 
-	return value;
+	g_strfreev (unlocked);
+	g_object_unref (service);
+
+	if (lerror != NULL) {
+		g_propagate_error (error, lerror);
+		return FALSE;
+	}
+
+	return deleted > 0;
 }
 
+/* How many Delete calls secret_service_clear_all() keeps in flight by default */
+#define CLEAR_ALL_WINDOW 16
+
 typedef struct {
 	GCancellable *cancellable;
 	SecretService *service;
 	GVariant *attributes;
+	gchar **paths;
+	guint next;
+	guint window;
+	guint in_flight;
+	GPtrArray *prompts;
 	gint deleted;
-	gint deleting;
-} DeleteClosure;
+	GError *error;
+} ClearAllClosure;
 
 static void
-delete_closure_free (gpointer data)
+clear_all_closure_free (gpointer data)
 {
-	DeleteClosure *closure = data;
-	if (closure->service)
-		g_object_unref (closure->service);
-	g_variant_unref (closure->attributes);
+	ClearAllClosure *closure = data;
+	g_clear_object (&closure->service);
 	g_clear_object (&closure->cancellable);
-	g_slice_free (DeleteClosure, closure);
+	g_variant_unref (closure->attributes);
+	g_strfreev (closure->paths);
+	g_ptr_array_unref (closure->prompts);
+	g_clear_error (&closure->error);
+	g_slice_free (ClearAllClosure, closure);
 }
 
 static void
-on_delete_password_complete (GObject *source,
-                             GAsyncResult *result,
-                             gpointer user_data)
+clear_all_complete (GSimpleAsyncResult *res)
+{
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	if (closure->error) {
+		g_simple_async_result_take_error (res, closure->error);
+		closure->error = NULL;
+	}
+
+	g_simple_async_result_complete (res);
+}
+
+static void
+clear_all_prompt_next (GSimpleAsyncResult *res);
+
+static void
+on_clear_all_prompted (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
-	gboolean deleted;
-
-	closure->deleting--;
+	GVariant *retval;
 
-	deleted = _secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error);
-	if (error != NULL)
-		g_simple_async_result_take_error (res, error);
-	if (deleted)
+	/* A dismissed prompt has no result, and the item was not deleted */
+	retval = secret_service_prompt_at_dbus_path_finish (SECRET_SERVICE (source), result, &error);
+	if (retval != NULL) {
 		closure->deleted++;
+		g_variant_unref (retval);
+	}
 
-	if (closure->deleting <= 0)
-		g_simple_async_result_complete (res);
+	/* Carry on with the other prompts, unless cancelled, and report the first failure */
+	if (error != NULL && closure->error == NULL)
+		closure->error = error;
+	else if (error != NULL)
+		g_error_free (error);
+
+	if (g_cancellable_is_cancelled (closure->cancellable))
+		clear_all_complete (res);
+	else
+		clear_all_prompt_next (res);
 
 	g_object_unref (res);
 }
 
 static void
-on_delete_searched (GObject *source,
-                    GAsyncResult *result,
-                    gpointer user_data)
+clear_all_prompt_next (GSimpleAsyncResult *res)
+{
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	gchar *prompt_path;
+
+	/* Prompts run one after another once all the deletes have been sent */
+	if (closure->prompts->len == 0) {
+		clear_all_complete (res);
+		return;
+	}
+
+	prompt_path = g_ptr_array_index (closure->prompts, 0);
+	secret_service_prompt_at_dbus_path (closure->service, prompt_path, NULL,
+	                                    closure->cancellable, on_clear_all_prompted,
+	                                    g_object_ref (res));
+	g_ptr_array_remove_index (closure->prompts, 0);
+}
+
+static void
+clear_all_delete_next (GSimpleAsyncResult *res);
+
+static void
+on_clear_all_delete (GObject *source,
+                     GAsyncResult *result,
+                     gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	const gchar *prompt_path;
 	GError *error = NULL;
-	gchar **unlocked = NULL;
-	gint i;
+	GVariant *retval;
 
-	secret_service_search_for_dbus_paths_finish (SECRET_SERVICE (source), result, &unlocked, NULL, &error);
-	if (error == NULL) {
-		for (i = 0; unlocked[i] != NULL; i++) {
-			_secret_service_delete_path (closure->service, unlocked[i], TRUE,
-			                             closure->cancellable,
-			                             on_delete_password_complete,
-			                             g_object_ref (res));
-			closure->deleting++;
-		}
+	closure->in_flight--;
 
-		if (closure->deleting == 0)
-			g_simple_async_result_complete (res);
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (retval != NULL) {
+		g_variant_get (retval, "(&o)", &prompt_path);
+		if (_secret_util_empty_path (prompt_path))
+			closure->deleted++;
+		else
+			g_ptr_array_add (closure->prompts, g_strdup (prompt_path));
+		g_variant_unref (retval);
+
+	/* Keep going with the others, but report the first failure */
+	} else if (closure->error == NULL) {
+		_secret_util_strip_remote_error (&error);
+		closure->error = error;
+
+	} else {
+		g_error_free (error);
+	}
+
+	clear_all_delete_next (res);
+	g_object_unref (res);
+}
+
+static void
+clear_all_delete_next (GSimpleAsyncResult *res)
+{
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GDBusProxy *proxy = G_DBUS_PROXY (closure->service);
+	const gchar *path;
+
+	while (closure->paths[closure->next] != NULL && closure->in_flight < closure->window &&
+	       !g_cancellable_is_cancelled (closure->cancellable)) {
+		path = closure->paths[closure->next++];
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy), path,
+		                        SECRET_ITEM_INTERFACE, "Delete", g_variant_new ("()"),
+		                        G_VARIANT_TYPE ("(o)"), G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+		                        closure->cancellable, on_clear_all_delete, g_object_ref (res));
+		closure->in_flight++;
+	}
+
+	if (closure->in_flight > 0)
+		return;
+
+	/* Items that failed to delete don't stop the prompts for the others */
+	if (g_cancellable_is_cancelled (closure->cancellable)) {
+		if (closure->error == NULL)
+			g_cancellable_set_error_if_cancelled (closure->cancellable, &closure->error);
+		clear_all_complete (res);
+
+	} else {
+		clear_all_prompt_next (res);
+	}
+}
+
+static void
+on_clear_all_searched (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	secret_service_search_for_dbus_paths_finish (SECRET_SERVICE (source), result,
+	                                             &closure->paths, NULL, &error);
+	if (error == NULL) {
+		clear_all_delete_next (res);
 	} else {
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 	}
 
-	g_strfreev (unlocked);
 	g_object_unref (res);
 }
 
 static void
-on_delete_service (GObject *source,
-                   GAsyncResult *result,
-                   gpointer user_data)
+on_clear_all_service (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
 {
-	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
-	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (async);
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	ClearAllClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
 
 	closure->service = secret_service_get_finish (result, &error);
 	if (error == NULL) {
 		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
 		                                          closure->cancellable,
-		                                          on_delete_searched, g_object_ref (async));
+		                                          on_clear_all_searched, g_object_ref (res));
 
 	} else {
-		g_simple_async_result_take_error (async, error);
-		g_simple_async_result_complete (async);
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
 	}
 
-	g_object_unref (async);
+	g_object_unref (res);
 }
 
 /**
- * secret_service_clear:
+ * secret_service_clear_all:
  * @service: (allow-none): the secret service
  * @schema: (allow-none): the schema for the attributes
  * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @window: how many items to delete at the same time, or zero for a default
  * @cancellable: optional cancellation object
  * @callback: called when the operation completes
  * @user_data: data to be passed to the callback
  *
- * Remove unlocked items which match the attributes from the secret service.
+ * Remove all the unlocked items which match the attributes from the secret
+ * service, and count them.
+ *
+ * Unlike secret_service_clear(), which is meant for the handful of items an
+ * application stores, this is meant for removing large numbers of items. Up
+ * to @window items are deleted at the same time. If the secret service wants
+ * to prompt before deleting some of the items, those prompts are shown one
+ * after another once all the other items have been deleted. The Secret
+ * Service API returns a separate prompt for each item deleted, and has no
+ * way to combine them into one.
+ *
+ * If deleting an item fails, or one of the prompts fails, the others are
+ * still deleted, and the first error is reported.
  *
  * The @attributes should be a set of key and value string pairs.
  *
@@ -1687,18 +2718,19 @@ on_delete_service (GObject *source,
  * This method will return immediately and complete asynchronously.
  */
 void
-secret_service_clear (SecretService *service,
-                      const SecretSchema *schema,
-                      GHashTable *attributes,
-                      GCancellable *cancellable,
-                      GAsyncReadyCallback callback,
-                      gpointer user_data)
+secret_service_clear_all (SecretService *service,
+                          const SecretSchema *schema,
+                          GHashTable *attributes,
+                          guint window,
+                          GCancellable *cancellable,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
 {
 	const gchar *schema_name = NULL;
+	ClearAllClosure *closure;
 	GSimpleAsyncResult *res;
-	DeleteClosure *closure;
 
-	g_return_if_fail (service == NULL || SECRET_SERVICE (service));
+	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
 	g_return_if_fail (attributes != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
@@ -1710,72 +2742,74 @@ secret_service_clear (SecretService *service,
 		schema_name = schema->name;
 
 	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
-	                                 secret_service_clear);
-	closure = g_slice_new0 (DeleteClosure);
+	                                 secret_service_clear_all);
+	closure = g_slice_new0 (ClearAllClosure);
 	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
 	closure->attributes = _secret_attributes_to_variant (attributes, schema_name);
 	g_variant_ref_sink (closure->attributes);
-	g_simple_async_result_set_op_res_gpointer (res, closure, delete_closure_free);
+	closure->window = window ? window : CLEAR_ALL_WINDOW;
+	closure->prompts = g_ptr_array_new_with_free_func (g_free);
+	g_simple_async_result_set_op_res_gpointer (res, closure, clear_all_closure_free);
 
 	/* A double check to make sure we don't delete everything, should have been checked earlier */
 	g_assert (g_variant_n_children (closure->attributes) > 0);
 
 	if (service == NULL) {
 		secret_service_get (SECRET_SERVICE_NONE, cancellable,
-		                    on_delete_service, g_object_ref (res));
+		                    on_clear_all_service, g_object_ref (res));
 	} else {
 		closure->service = g_object_ref (service);
 		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
 		                                          closure->cancellable,
-		                                          on_delete_searched, g_object_ref (res));
+		                                          on_clear_all_searched, g_object_ref (res));
 	}
 
 	g_object_unref (res);
 }
 
 /**
- * secret_service_clear_finish:
+ * secret_service_clear_all_finish:
  * @service: (allow-none): the secret service
  * @result: the asynchronous result passed to the callback
  * @error: location to place an error on failure
  *
- * Finish asynchronous operation to remove items from the secret
+ * Finish asynchronous operation to remove all matching items from the secret
  * service.
  *
- * Returns: whether items were removed or not
+ * Returns: the number of items removed, or -1 if an error occurred
  */
-gboolean
-secret_service_clear_finish (SecretService *service,
-                             GAsyncResult *result,
-                             GError **error)
+gint
+secret_service_clear_all_finish (SecretService *service,
+                                 GAsyncResult *result,
+                                 GError **error)
 {
 	GSimpleAsyncResult *res;
-	DeleteClosure *closure;
+	ClearAllClosure *closure;
 
-	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), -1);
+	g_return_val_if_fail (error == NULL || *error == NULL, -1);
 	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
-	                      secret_service_clear), FALSE);
+	                      secret_service_clear_all), -1);
 
 	res = G_SIMPLE_ASYNC_RESULT (result);
 	if (_secret_util_propagate_error (res, error))
-		return FALSE;
+		return -1;
 
 	closure = g_simple_async_result_get_op_res_gpointer (res);
-	return closure->deleted > 0;
+	return closure->deleted;
 }
 
 /**
- * secret_service_clear_sync:
+ * secret_service_clear_all_sync:
  * @service: (allow-none): the secret service
  * @schema: (allow-none): the schema for the attributes
  * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @window: how many items to delete at the same time, or zero for a default
  * @cancellable: optional cancellation object
  * @error: location to place an error on failure
  *
- * Remove unlocked items which match the attributes from the secret service.
- *
- * The @attributes should be a set of key and value string pairs.
+ * Remove all the unlocked items which match the attributes from the secret
+ * service, and count them. See secret_service_clear_all() for details.
  *
  * If @service is NULL, then secret_service_get_sync() will be called to get
  * the default #SecretService proxy.
@@ -1783,40 +2817,42 @@ secret_service_clear_finish (SecretService *service,
  * This method may block indefinitely and should not be used in user interface
  * threads.
  *
- * Returns: whether items were removed or not
+ * Returns: the number of items removed, or -1 if an error occurred
  */
-gboolean
-secret_service_clear_sync (SecretService *service,
-                           const SecretSchema *schema,
-                           GHashTable *attributes,
-                           GCancellable *cancellable,
-                           GError **error)
+gint
+secret_service_clear_all_sync (SecretService *service,
+                               const SecretSchema *schema,
+                               GHashTable *attributes,
+                               guint window,
+                               GCancellable *cancellable,
+                               GError **error)
 {
 	SecretSync *sync;
-	gboolean result;
+	gint count;
 
-	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), -1);
+	g_return_val_if_fail (attributes != NULL, -1);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), -1);
+	g_return_val_if_fail (error == NULL || *error == NULL, -1);
 
 	/* Warnings raised already */
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
-		return FALSE;
+		return -1;
 
 	sync = _secret_sync_new ();
 	g_main_context_push_thread_default (sync->context);
 
-	secret_service_clear (service, schema, attributes, cancellable,
-	                      _secret_sync_on_result, sync);
+	secret_service_clear_all (service, schema, attributes, window, cancellable,
+	                          _secret_sync_on_result, sync);
 
 	g_main_loop_run (sync->loop);
 
-	result = secret_service_clear_finish (service, sync->result, error);
+	count = secret_service_clear_all_finish (service, sync->result, error);
 
 	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
-	return result;
+	return count;
 }
 
 typedef struct {
@@ -274,7 +274,7 @@ secret_password_storev_sync (const SecretSchema *schema,
                              GCancellable *cancellable,
                              GError **error)
 {
-	SecretSync *sync;
+	SecretValue *value;
 	gboolean ret;
 
 	g_return_val_if_fail (schema != NULL, FALSE);
@@ -288,18 +288,10 @@ secret_password_storev_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_storev (schema, attributes, collection, label, password,
-	                        cancellable, _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	ret = secret_password_store_finish (sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	value = secret_value_new (password, -1, "text/plain");
+	ret = secret_service_store_sync (NULL, schema, attributes, collection,
+	                                 label, value, cancellable, error);
+	secret_value_unref (value);
 
 	return ret;
 }
@@ -566,8 +558,7 @@ secret_password_lookupv_nonpageable_sync (const SecretSchema *schema,
                                           GCancellable *cancellable,
                                           GError **error)
 {
-	SecretSync *sync;
-	gchar *password;
+	SecretValue *value;
 
 	g_return_val_if_fail (schema != NULL, NULL);
 	g_return_val_if_fail (attributes != NULL, NULL);
@@ -578,20 +569,11 @@ secret_password_lookupv_nonpageable_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_lookupv (schema, attributes, cancellable,
-	                         _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	password = secret_password_lookup_nonpageable_finish (sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	value = secret_service_lookup_sync (NULL, schema, attributes, cancellable, error);
+	if (value == NULL)
+		return NULL;
 
-	return password;
+	return _secret_value_unref_to_password (value);
 }
 
 /**
@@ -621,8 +603,7 @@ secret_password_lookupv_sync (const SecretSchema *schema,
                               GCancellable *cancellable,
                               GError **error)
 {
-	SecretSync *sync;
-	gchar *string;
+	SecretValue *value;
 
 	g_return_val_if_fail (schema != NULL, NULL);
 	g_return_val_if_fail (attributes != NULL, NULL);
@@ -633,20 +614,11 @@ secret_password_lookupv_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_lookupv (schema, attributes, cancellable,
-	                         _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	string = secret_password_lookup_finish (sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	value = secret_service_lookup_sync (NULL, schema, attributes, cancellable, error);
+	if (value == NULL)
+		return NULL;
 
-	return string;
+	return _secret_value_unref_to_string (value);
 }
 
 /**
@@ -828,9 +800,6 @@ secret_password_clearv_sync (const SecretSchema *schema,
                              GCancellable *cancellable,
                              GError **error)
 {
-	SecretSync *sync;
-	gboolean result;
-
 	g_return_val_if_fail (schema != NULL, FALSE);
 	g_return_val_if_fail (attributes != NULL, FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
@@ -840,20 +809,7 @@ secret_password_clearv_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_clearv (schema, attributes, cancellable,
-	                        _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	result = secret_password_clear_finish (sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
-
-	return result;
+	return secret_service_clear_sync (NULL, schema, attributes, cancellable, error);
 }
 
 /**
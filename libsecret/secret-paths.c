@@ -22,6 +22,7 @@
 #include "secret-types.h"
 #include "secret-value.h"
 
+#include <string.h>
 
 /**
  * SECTION:secret-paths
@@ -75,7 +76,7 @@ secret_collection_new_for_dbus_path (SecretService *service,
 
 	g_async_initable_new_async (secret_service_get_collection_gtype (service),
 	                            G_PRIORITY_DEFAULT, cancellable, callback, user_data,
-	                            "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                            "g-flags", _secret_service_get_proxy_flags (service),
 	                            "g-interface-info", _secret_gen_collection_interface_info (),
 	                            "g-name", g_dbus_proxy_get_name (proxy),
 	                            "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -157,7 +158,7 @@ secret_collection_new_for_dbus_path_sync (SecretService *service,
 
 	return g_initable_new (secret_service_get_collection_gtype (service),
 	                       cancellable, error,
-	                       "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                       "g-flags", _secret_service_get_proxy_flags (service),
 	                       "g-interface-info", _secret_gen_collection_interface_info (),
 	                       "g-name", g_dbus_proxy_get_name (proxy),
 	                       "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -204,7 +205,7 @@ secret_item_new_for_dbus_path (SecretService *service,
 
 	g_async_initable_new_async (secret_service_get_item_gtype (service),
 	                            G_PRIORITY_DEFAULT, cancellable, callback, user_data,
-	                            "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                            "g-flags", _secret_service_get_proxy_flags (service),
 	                            "g-interface-info", _secret_gen_item_interface_info (),
 	                            "g-name", g_dbus_proxy_get_name (proxy),
 	                            "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -285,7 +286,7 @@ secret_item_new_for_dbus_path_sync (SecretService *service,
 
 	return g_initable_new (secret_service_get_item_gtype (service),
 	                       cancellable, error,
-	                       "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                       "g-flags", _secret_service_get_proxy_flags (service),
 	                       "g-interface-info", _secret_gen_item_interface_info (),
 	                       "g-name", g_dbus_proxy_get_name (proxy),
 	                       "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -296,6 +297,133 @@ secret_item_new_for_dbus_path_sync (SecretService *service,
 	                       NULL);
 }
 
+static GObject *
+proxy_new_for_properties (SecretService *service,
+                          GType type,
+                          GDBusInterfaceInfo *info,
+                          const gchar *interface_name,
+                          const gchar *object_path,
+                          guint flags,
+                          GVariant *properties)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (service);
+	GObject *object;
+	GVariantIter iter;
+	const gchar *name;
+	GVariant *value;
+
+	object = g_object_new (type,
+	                       "g-flags", _secret_service_get_proxy_flags (service) |
+	                                  G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+	                       "g-interface-info", info,
+	                       "g-name", g_dbus_proxy_get_name (proxy),
+	                       "g-connection", g_dbus_proxy_get_connection (proxy),
+	                       "g-object-path", object_path,
+	                       "g-interface-name", interface_name,
+	                       "service", service,
+	                       "flags", flags,
+	                       NULL);
+
+	/*
+	 * Already have the properties, so initializing won't call GetAll. Without
+	 * loading them the proxy doesn't watch for changes either, those come
+	 * through the service's subscription.
+	 */
+	g_variant_iter_init (&iter, properties);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+		g_dbus_proxy_set_cached_property (G_DBUS_PROXY (object), name, value);
+		g_variant_unref (value);
+	}
+
+	return object;
+}
+
+void
+_secret_collection_new_for_properties (SecretService *service,
+                                       const gchar *collection_path,
+                                       GVariant *properties,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+	GObject *object;
+
+	object = proxy_new_for_properties (service, secret_service_get_collection_gtype (service),
+	                                   _secret_gen_collection_interface_info (),
+	                                   SECRET_COLLECTION_INTERFACE, collection_path,
+	                                   SECRET_COLLECTION_NONE, properties);
+
+	/* Complete with secret_collection_new_for_dbus_path_finish() */
+	g_async_initable_init_async (G_ASYNC_INITABLE (object), G_PRIORITY_DEFAULT,
+	                             cancellable, callback, user_data);
+	g_object_unref (object);
+}
+
+SecretCollection *
+_secret_collection_new_for_properties_sync (SecretService *service,
+                                            const gchar *collection_path,
+                                            GVariant *properties,
+                                            GCancellable *cancellable,
+                                            GError **error)
+{
+	GObject *object;
+
+	object = proxy_new_for_properties (service, secret_service_get_collection_gtype (service),
+	                                   _secret_gen_collection_interface_info (),
+	                                   SECRET_COLLECTION_INTERFACE, collection_path,
+	                                   SECRET_COLLECTION_NONE, properties);
+
+	if (!g_initable_init (G_INITABLE (object), cancellable, error)) {
+		g_object_unref (object);
+		return NULL;
+	}
+
+	return SECRET_COLLECTION (object);
+}
+
+void
+_secret_item_new_for_properties (SecretService *service,
+                                 const gchar *item_path,
+                                 GVariant *properties,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+	GObject *object;
+
+	object = proxy_new_for_properties (service, secret_service_get_item_gtype (service),
+	                                   _secret_gen_item_interface_info (),
+	                                   SECRET_ITEM_INTERFACE, item_path,
+	                                   SECRET_ITEM_NONE, properties);
+
+	/* Complete with secret_item_new_for_dbus_path_finish() */
+	g_async_initable_init_async (G_ASYNC_INITABLE (object), G_PRIORITY_DEFAULT,
+	                             cancellable, callback, user_data);
+	g_object_unref (object);
+}
+
+SecretItem *
+_secret_item_new_for_properties_sync (SecretService *service,
+                                      const gchar *item_path,
+                                      GVariant *properties,
+                                      GCancellable *cancellable,
+                                      GError **error)
+{
+	GObject *object;
+
+	object = proxy_new_for_properties (service, secret_service_get_item_gtype (service),
+	                                   _secret_gen_item_interface_info (),
+	                                   SECRET_ITEM_INTERFACE, item_path,
+	                                   SECRET_ITEM_NONE, properties);
+
+	if (!g_initable_init (G_INITABLE (object), cancellable, error)) {
+		g_object_unref (object);
+		return NULL;
+	}
+
+	return SECRET_ITEM (object);
+}
+
 static void
 on_search_items_complete (GObject *source,
                           GAsyncResult *result,
@@ -822,6 +950,33 @@ secret_service_get_secret_for_dbus_path_finish (SecretService *self,
 	return _secret_service_decode_get_secrets_first (self, closure->out);
 }
 
+static GVariant *
+service_get_secrets_sync (SecretService *self,
+                          GVariant *in,
+                          GCancellable *cancellable,
+                          GError **error)
+{
+	const gchar *session;
+	GVariant *out;
+
+	g_variant_ref_sink (in);
+
+	if (!secret_service_ensure_session_sync (self, cancellable, error)) {
+		g_variant_unref (in);
+		return NULL;
+	}
+
+	session = secret_service_get_session_dbus_path (self);
+	out = g_dbus_proxy_call_sync (G_DBUS_PROXY (self), "GetSecrets",
+	                              g_variant_new ("(@aoo)", in, session),
+	                              G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+	                              cancellable, error);
+
+	_secret_util_strip_remote_error (error);
+	g_variant_unref (in);
+	return out;
+}
+
 /**
  * secret_service_get_secret_for_dbus_path_sync: (skip)
  * @self: the secret service
@@ -851,26 +1006,21 @@ secret_service_get_secret_for_dbus_path_sync (SecretService *self,
                                               GCancellable *cancellable,
                                               GError **error)
 {
-	SecretSync *sync;
 	SecretValue *value;
+	GVariant *out;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (item_path != NULL, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_get_secret_for_dbus_path (self, item_path, cancellable,
-	                                         _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	value = secret_service_get_secret_for_dbus_path_finish (self, sync->result, error);
+	out = service_get_secrets_sync (self, g_variant_new_objv (&item_path, 1),
+	                                cancellable, error);
+	if (out == NULL)
+		return NULL;
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	value = _secret_service_decode_get_secrets_first (self, out);
+	g_variant_unref (out);
 
 	return value;
 }
@@ -990,117 +1140,793 @@ secret_service_get_secrets_for_dbus_paths_sync (SecretService *self,
                                                 GCancellable *cancellable,
                                                 GError **error)
 {
-	SecretSync *sync;
 	GHashTable *secrets;
+	GVariant *out;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (item_paths != NULL, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
+	out = service_get_secrets_sync (self, g_variant_new_objv (item_paths, -1),
+	                                cancellable, error);
+	if (out == NULL)
+		return NULL;
 
-	secret_service_get_secrets_for_dbus_paths (self, item_paths, cancellable,
-	                                           _secret_sync_on_result, sync);
+	secrets = _secret_service_decode_get_secrets_all (self, out);
+	g_variant_unref (out);
 
-	g_main_loop_run (sync->loop);
+	return secrets;
+}
 
-	secrets = secret_service_get_secrets_for_dbus_paths_finish (self, sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+/* Serializes callers joining a lock or unlock call with them giving up on it */
+G_LOCK_DEFINE_STATIC (xlock_calls);
+
+typedef struct {
+	gint refs;
+	gchar *key;
+	GCancellable *cancellable;
+
+	/* Locked by xlock_calls */
+	GPtrArray *heads;
+	guint waiting;
+} XlockCall;
+
+typedef struct {
+	GCancellable *cancellable;
+	gulong cancelled_sig;
+	gint completed;
+	XlockCall *call;
+	SecretPrompt *prompt;
+	GPtrArray *xlocked;
+	gchar **paths;
+	GPtrArray *members;
+	GHashTable *requested;
+} XlockClosure;
+
+typedef struct {
+	gint refs;
+	SecretService *service;
+	GMainContext *context;
+
+	/* Locked by xlock_calls */
+	guint depth;
+	guint pending;
+	GSource *idle;
+	GPtrArray *members;
+} XlockSet;
+
+/* The set joined by the operation now making its unlock request, if any */
+static GPrivate xlock_set_entered = G_PRIVATE_INIT (NULL);
+
+static XlockCall *
+xlock_call_new (const gchar *key)
+{
+	XlockCall *call;
+
+	call = g_slice_new0 (XlockCall);
+	call->refs = 1;
+	call->key = g_strdup (key);
+	call->cancellable = g_cancellable_new ();
+	call->heads = g_ptr_array_new_with_free_func (g_object_unref);
+
+	return call;
+}
+
+static XlockCall *
+xlock_call_ref (XlockCall *call)
+{
+	g_atomic_int_inc (&call->refs);
+	return call;
+}
+
+static void
+xlock_call_unref (gpointer data)
+{
+	XlockCall *call = data;
+
+	if (!g_atomic_int_dec_and_test (&call->refs))
+		return;
+
+	g_free (call->key);
+	g_object_unref (call->cancellable);
+	if (call->heads)
+		g_ptr_array_unref (call->heads);
+	g_slice_free (XlockCall, call);
+}
+
+static void
+xlock_closure_free (gpointer data)
+{
+	XlockClosure *closure = data;
+	if (closure->cancelled_sig)
+		g_cancellable_disconnect (closure->cancellable, closure->cancelled_sig);
+	g_clear_object (&closure->cancellable);
+	if (closure->call)
+		xlock_call_unref (closure->call);
+	g_clear_object (&closure->prompt);
+	if (closure->xlocked)
+		g_ptr_array_unref (closure->xlocked);
+	g_strfreev (closure->paths);
+	if (closure->members)
+		g_ptr_array_unref (closure->members);
+	if (closure->requested)
+		g_hash_table_destroy (closure->requested);
+	g_slice_free (XlockClosure, closure);
+}
+
+static gint
+xlock_compare_paths (gconstpointer a,
+                     gconstpointer b)
+{
+	return strcmp (*(const gchar **)a, *(const gchar **)b);
+}
+
+static gchar *
+xlock_coalesce_key (const gchar *method,
+                    const gchar **paths)
+{
+	GPtrArray *sorted;
+	GString *key;
+	guint i;
+
+	/* The same set of paths, in any order, results in the same key */
+	sorted = g_ptr_array_new ();
+	for (i = 0; paths[i] != NULL; i++)
+		g_ptr_array_add (sorted, (gpointer)paths[i]);
+	g_ptr_array_sort (sorted, xlock_compare_paths);
+
+	key = g_string_new (method);
+	for (i = 0; i < sorted->len; i++) {
+		g_string_append_c (key, ' ');
+		g_string_append (key, sorted->pdata[i]);
+	}
+
+	g_ptr_array_free (sorted, TRUE);
+	return g_string_free (key, FALSE);
+}
+
+static gboolean
+xlock_was_requested (XlockClosure *closure,
+                     const gchar *path)
+{
+	guint i;
+
+	for (i = 0; closure->paths[i] != NULL; i++) {
+		if (g_str_equal (closure->paths[i], path))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Exactly one of delivery or cancellation gets to complete each caller */
+static gboolean
+xlock_claim (GSimpleAsyncResult *res)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	return g_atomic_int_compare_and_exchange (&closure->completed, 0, 1);
+}
+
+static gboolean
+xlock_is_claimed (GSimpleAsyncResult *res)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	return g_atomic_int_get (&closure->completed) != 0;
+}
+
+/*
+ * Called with xlock_calls held when a caller stops waiting. Returns a
+ * reference to the call when nobody is left waiting on it, which the
+ * caller should then cancel.
+ */
+static XlockCall *
+xlock_call_leave (SecretService *self,
+                  XlockCall *call)
+{
+	g_assert (call->waiting > 0);
+	if (--call->waiting > 0)
+		return NULL;
+
+	/* Nobody else may join a call that is about to be cancelled */
+	_secret_service_xlock_remove (self, call->key, call);
+	return xlock_call_ref (call);
+}
+
+static void
+on_xlock_cancelled (GCancellable *cancellable,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	XlockCall *cancel = NULL;
+	SecretService *self;
+	GError *error = NULL;
+
+	/* May run in any thread, the call carries on while others wait on it */
+	G_LOCK (xlock_calls);
+	if (xlock_claim (res)) {
+		g_cancellable_set_error_if_cancelled (cancellable, &error);
+		if (closure->call) {
+			self = SECRET_SERVICE (g_async_result_get_source_object (G_ASYNC_RESULT (res)));
+			cancel = xlock_call_leave (self, closure->call);
+			g_object_unref (self);
+		}
+	}
+	G_UNLOCK (xlock_calls);
+
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete_in_idle (res);
+	}
+
+	if (cancel != NULL) {
+		g_cancellable_cancel (cancel->cancellable);
+		xlock_call_unref (cancel);
+	}
+}
+
+static void
+xlock_complete_one (GSimpleAsyncResult *res,
+                    GSimpleAsyncResult *owner,
+                    const GError *error)
+{
+	if (error != NULL)
+		g_simple_async_result_set_from_error (res, error);
+
+	/* Anyone but the owner may belong to another thread or main context */
+	if (res == owner)
+		g_simple_async_result_complete (res);
+	else
+		g_simple_async_result_complete_in_idle (res);
+}
+
+static void
+xlock_deliver (GSimpleAsyncResult *res,
+               GSimpleAsyncResult *owner,
+               GPtrArray *xlocked,
+               const GError *error)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GSimpleAsyncResult *member;
+	XlockClosure *other;
+	GPtrArray *members;
+	const gchar *path;
+	guint i, j;
+
+	if (closure->members == NULL) {
+		if (!xlock_claim (res))
+			return;
+		for (j = 0; error == NULL && j < xlocked->len; j++)
+			g_ptr_array_add (closure->xlocked, g_strdup (xlocked->pdata[j]));
+		xlock_complete_one (res, owner, error);
+		return;
+	}
+
+	/* The members hold a reference to this result, so drop them first */
+	members = closure->members;
+	closure->members = NULL;
+
+	/*
+	 * Each member of an unlock set sees the paths it asked for. Paths that
+	 * nobody asked for, such as the collection of a requested item, are
+	 * reported to everyone.
+	 */
+	for (i = 0; i < members->len; i++) {
+		member = members->pdata[i];
+		if (!xlock_claim (member))
+			continue;
+		other = g_simple_async_result_get_op_res_gpointer (member);
+		for (j = 0; error == NULL && j < xlocked->len; j++) {
+			path = xlocked->pdata[j];
+			if (xlock_was_requested (other, path) ||
+			    !g_hash_table_contains (closure->requested, path))
+				g_ptr_array_add (other->xlocked, g_strdup (path));
+		}
+		xlock_complete_one (member, owner, error);
+	}
+
+	g_ptr_array_unref (members);
+}
+
+static GPtrArray *
+xlock_call_finish (SecretService *self,
+                   XlockCall *call)
+{
+	GPtrArray *heads;
+
+	G_LOCK (xlock_calls);
+	_secret_service_xlock_remove (self, call->key, call);
+	heads = call->heads;
+	call->heads = NULL;
+	G_UNLOCK (xlock_calls);
+
+	return heads;
+}
+
+static void
+xlock_complete (GSimpleAsyncResult *res,
+                GError *error)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self;
+	GPtrArray *heads;
+	GPtrArray *xlocked;
+	guint i;
+
+	self = SECRET_SERVICE (g_async_result_get_source_object (G_ASYNC_RESULT (res)));
+	heads = xlock_call_finish (self, closure->call);
+	g_object_unref (self);
+
+	xlocked = closure->xlocked;
+	closure->xlocked = g_ptr_array_new_with_free_func (g_free);
+
+	/* Everyone who joined this call while it was in flight gets the same outcome */
+	for (i = 0; heads != NULL && i < heads->len; i++)
+		xlock_deliver (heads->pdata[i], res, xlocked, error);
+
+	g_clear_error (&error);
+	g_ptr_array_unref (xlocked);
+	if (heads != NULL)
+		g_ptr_array_unref (heads);
+}
+
+static void
+on_xlock_prompted (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	GVariantIter iter;
+	GVariant *retval;
+	gchar *path;
+
+	retval = secret_service_prompt_finish (self, result, &error);
+
+	if (retval != NULL) {
+		g_variant_iter_init (&iter, retval);
+		while (g_variant_iter_loop (&iter, "o", &path))
+			g_ptr_array_add (closure->xlocked, g_strdup (path));
+		g_variant_unref (retval);
+	}
+
+	xlock_complete (res, error);
+	g_object_unref (res);
+}
+
+static void xlock_begin (SecretService *self,
+                         GSimpleAsyncResult *res,
+                         const gchar *method,
+                         const gchar **paths);
+
+/*
+ * When the combined Unlock call of a set fails, such as when one member asked
+ * for a path that no longer exists, the error may well belong to only one of
+ * them. So each member that is still waiting gets its own Unlock call.
+ */
+static gboolean
+xlock_split_set (SecretService *self,
+                 GSimpleAsyncResult *res,
+                 const GError *error)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GSimpleAsyncResult *member;
+	XlockClosure *other;
+	GPtrArray *members;
+	GPtrArray *heads;
+	GPtrArray *empty;
+	guint i;
+
+	if (closure->members == NULL || closure->members->len < 2 ||
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return FALSE;
+
+	members = closure->members;
+	closure->members = NULL;
+
+	/* Anyone who joined the combined call asked for all of its paths */
+	heads = xlock_call_finish (self, closure->call);
+	empty = g_ptr_array_new ();
+	for (i = 0; heads != NULL && i < heads->len; i++) {
+		if (heads->pdata[i] != res)
+			xlock_deliver (heads->pdata[i], res, empty, error);
+	}
+	g_ptr_array_unref (empty);
+	if (heads != NULL)
+		g_ptr_array_unref (heads);
+
+	for (i = 0; i < members->len; i++) {
+		member = members->pdata[i];
+		other = g_simple_async_result_get_op_res_gpointer (member);
+
+		G_LOCK (xlock_calls);
+		if (other->call)
+			xlock_call_unref (other->call);
+		other->call = NULL;
+		G_UNLOCK (xlock_calls);
+
+		if (!xlock_is_claimed (member))
+			xlock_begin (self, member, "Unlock", (const gchar **)other->paths);
+	}
+
+	g_ptr_array_unref (members);
+	return TRUE;
+}
+
+static void
+on_xlock_called (GObject *source,
+                 GAsyncResult *result,
+                 gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	const gchar *prompt = NULL;
+	gchar **xlocked = NULL;
+	GError *error = NULL;
+	GVariant *retval;
+	guint i;
+
+	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
+	if (error != NULL) {
+		if (xlock_split_set (self, res, error))
+			g_error_free (error);
+		else
+			xlock_complete (res, error);
+
+	} else {
+		g_variant_get (retval, "(^ao&o)", &xlocked, &prompt);
+
+		/* Paths that needed no prompt are done, even when others do */
+		for (i = 0; xlocked[i]; i++)
+			g_ptr_array_add (closure->xlocked, g_strdup (xlocked[i]));
+
+		if (_secret_util_empty_path (prompt)) {
+			xlock_complete (res, NULL);
+
+		} else {
+			closure->prompt = _secret_prompt_instance (self, prompt);
+			secret_service_prompt (self, closure->prompt, G_VARIANT_TYPE ("ao"),
+			                       closure->call->cancellable, on_xlock_prompted,
+			                       g_object_ref (res));
+		}
+
+		g_strfreev (xlocked);
+		g_variant_unref (retval);
+	}
+
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+/*
+ * Starts the call for @res, or has it wait on a call already in flight for
+ * the same paths. Everyone waiting counts towards the call, which is only
+ * cancelled once all of them have been cancelled.
+ */
+static void
+xlock_begin (SecretService *self,
+             GSimpleAsyncResult *res,
+             const gchar *method,
+             const gchar **paths)
+{
+	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GSimpleAsyncResult *member;
+	XlockClosure *other;
+	XlockCall *call = NULL;
+	GPtrArray *members = NULL;
+	gboolean start = FALSE;
+	guint waiting = 0;
+	gchar *key;
+	guint i;
+
+	key = xlock_coalesce_key (method, paths);
+
+	G_LOCK (xlock_calls);
+
+	if (closure->members == NULL) {
+		if (!xlock_is_claimed (res))
+			waiting = 1;
+	} else {
+		for (i = 0; i < closure->members->len; i++) {
+			if (!xlock_is_claimed (closure->members->pdata[i]))
+				waiting++;
+		}
+	}
+
+	if (waiting > 0) {
+		call = _secret_service_xlock_lookup (self, key);
+		if (call == NULL) {
+			call = xlock_call_new (key);
+			_secret_service_xlock_insert (self, key, call);
+			start = TRUE;
+		} else {
+			xlock_call_ref (call);
+		}
+
+		call->waiting += waiting;
+		g_ptr_array_add (call->heads, g_object_ref (res));
+
+		for (i = 0; closure->members != NULL && i < closure->members->len; i++) {
+			member = closure->members->pdata[i];
+			other = g_simple_async_result_get_op_res_gpointer (member);
+			if (member != res && !xlock_is_claimed (member))
+				other->call = xlock_call_ref (call);
+		}
+		closure->call = call;
+
+	/* Everyone was cancelled before the call could be made */
+	} else {
+		members = closure->members;
+		closure->members = NULL;
+	}
+
+	G_UNLOCK (xlock_calls);
+
+	if (start) {
+		g_dbus_proxy_call (G_DBUS_PROXY (self), method,
+		                   g_variant_new ("(@ao)", g_variant_new_objv (paths, -1)),
+		                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+		                   call->cancellable, on_xlock_called, g_object_ref (res));
+	}
+
+	if (members != NULL)
+		g_ptr_array_unref (members);
+	g_free (key);
+}
+
+static void
+xlock_set_commit (SecretService *self,
+                  GPtrArray *members)
+{
+	GSimpleAsyncResult *res = NULL;
+	XlockClosure *closure;
+	XlockClosure *other;
+	GPtrArray *paths;
+	gchar *path;
+	guint i, j;
+
+	for (i = 0; res == NULL && i < members->len; i++) {
+		if (!xlock_is_claimed (members->pdata[i]))
+			res = members->pdata[i];
+	}
+
+	/* Everyone in the set was cancelled */
+	if (res == NULL)
+		return;
+
+	/* One Unlock call, and so at most one prompt, for everything requested */
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	closure->members = g_ptr_array_ref (members);
+	closure->requested = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	paths = g_ptr_array_new ();
+	for (i = 0; i < members->len; i++) {
+		other = g_simple_async_result_get_op_res_gpointer (members->pdata[i]);
+		for (j = 0; other->paths[j] != NULL; j++) {
+			if (g_hash_table_contains (closure->requested, other->paths[j]))
+				continue;
+			path = g_strdup (other->paths[j]);
+			g_hash_table_add (closure->requested, path);
+			g_ptr_array_add (paths, path);
+		}
+	}
+	g_ptr_array_add (paths, NULL);
+
+	xlock_begin (self, res, "Unlock", (const gchar **)paths->pdata);
+
+	g_ptr_array_free (paths, TRUE);
+}
+
+static XlockSet *
+xlock_set_ref (XlockSet *set)
+{
+	g_atomic_int_inc (&set->refs);
+	return set;
+}
+
+static void
+xlock_set_unref (gpointer data)
+{
+	XlockSet *set = data;
+
+	if (g_atomic_int_dec_and_test (&set->refs)) {
+		g_object_unref (set->service);
+		g_main_context_unref (set->context);
+		if (set->members)
+			g_ptr_array_unref (set->members);
+		g_slice_free (XlockSet, set);
+	}
+}
+
+/* Called with xlock_calls held, returns the members once nothing holds them back */
+static GPtrArray *
+xlock_set_steal_ready (XlockSet *set)
+{
+	GPtrArray *members;
+
+	if (set->depth > 0 || set->pending > 0)
+		return NULL;
+
+	members = set->members;
+	set->members = NULL;
+	return members;
+}
+
+static void
+xlock_set_close (XlockSet *set,
+                 gboolean all)
+{
+	GPtrArray *members = NULL;
+	GSource *idle = NULL;
+	gboolean closed = FALSE;
+
+	G_LOCK (xlock_calls);
+	if (set->depth > 0) {
+		set->depth = all ? 0 : set->depth - 1;
+		if (set->depth == 0) {
+			_secret_service_unlock_set_remove (set->service, set->context);
+			idle = set->idle;
+			set->idle = NULL;
+			members = xlock_set_steal_ready (set);
+			closed = TRUE;
+		}
+	}
+	G_UNLOCK (xlock_calls);
+
+	if (members != NULL) {
+		xlock_set_commit (set->service, members);
+		g_ptr_array_unref (members);
+	}
+
+	if (idle != NULL) {
+		g_source_destroy (idle);
+		g_source_unref (idle);
+	}
+
+	/* The reference held while the set was open */
+	if (closed)
+		xlock_set_unref (set);
+}
+
+static gboolean
+on_xlock_set_idle (gpointer user_data)
+{
+	XlockSet *set = user_data;
+
+	g_warning ("an unlock set was still open when control returned to the main loop, "
+	           "call secret_service_end_unlock_set() before then");
+	xlock_set_close (set, TRUE);
+
+	return FALSE; /* don't call again */
+}
+
+void
+_secret_service_unlock_set_begin (SecretService *self)
+{
+	GMainContext *context;
+	XlockSet *set;
+
+	context = g_main_context_ref_thread_default ();
+
+	G_LOCK (xlock_calls);
+	set = _secret_service_unlock_set_lookup (self, context);
+	if (set == NULL) {
+		set = g_slice_new0 (XlockSet);
+		set->refs = 1;
+		set->service = g_object_ref (self);
+		set->context = g_main_context_ref (context);
+		set->members = g_ptr_array_new_with_free_func (g_object_unref);
+		_secret_service_unlock_set_insert (self, context, set);
+
+		/* Otherwise a set that is never ended would hold its members forever */
+		set->idle = g_idle_source_new ();
+		g_source_set_callback (set->idle, on_xlock_set_idle,
+		                       xlock_set_ref (set), xlock_set_unref);
+		g_source_attach (set->idle, context);
+	}
+	set->depth++;
+	G_UNLOCK (xlock_calls);
 
-	return secrets;
+	g_main_context_unref (context);
 }
 
+void
+_secret_service_unlock_set_end (SecretService *self)
+{
+	GMainContext *context;
+	XlockSet *set;
 
-typedef struct {
-	GCancellable *cancellable;
-	SecretPrompt *prompt;
-	GPtrArray *xlocked;
-} XlockClosure;
+	context = g_main_context_ref_thread_default ();
 
-static void
-xlock_closure_free (gpointer data)
-{
-	XlockClosure *closure = data;
-	g_clear_object (&closure->cancellable);
-	g_clear_object (&closure->prompt);
-	if (closure->xlocked)
-		g_ptr_array_unref (closure->xlocked);
-	g_slice_free (XlockClosure, closure);
+	G_LOCK (xlock_calls);
+	set = _secret_service_unlock_set_lookup (self, context);
+	if (set != NULL)
+		xlock_set_ref (set);
+	G_UNLOCK (xlock_calls);
+
+	g_main_context_unref (context);
+
+	if (set != NULL) {
+		xlock_set_close (set, FALSE);
+		xlock_set_unref (set);
+	}
 }
 
-static void
-on_xlock_prompted (GObject *source,
-                   GAsyncResult *result,
-                   gpointer user_data)
+/*
+ * An operation that may go on to unlock, such as a search with
+ * SECRET_SEARCH_UNLOCK, joins the set open in the thread default main
+ * context when it starts. The set is not sent until every operation that
+ * joined it has either made its unlock request between enter and leave,
+ * or left without one.
+ */
+gpointer
+_secret_service_unlock_set_join (SecretService *self)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
-	GError *error = NULL;
-	GVariantIter iter;
-	GVariant *retval;
-	gchar *path;
+	GMainContext *context;
+	XlockSet *set;
 
-	retval = secret_service_prompt_finish (self, result, &error);
-	if (error != NULL)
-		g_simple_async_result_take_error (res, error);
+	context = g_main_context_ref_thread_default ();
 
-	if (retval != NULL) {
-		g_variant_iter_init (&iter, retval);
-		while (g_variant_iter_loop (&iter, "o", &path))
-			g_ptr_array_add (closure->xlocked, g_strdup (path));
-		g_variant_unref (retval);
+	G_LOCK (xlock_calls);
+	set = _secret_service_unlock_set_lookup (self, context);
+	if (set != NULL) {
+		set->pending++;
+		xlock_set_ref (set);
 	}
+	G_UNLOCK (xlock_calls);
 
-	g_simple_async_result_complete (res);
-	g_object_unref (res);
+	g_main_context_unref (context);
+	return set;
 }
 
-static void
-on_xlock_called (GObject *source,
-                 GAsyncResult *result,
-                 gpointer user_data)
+void
+_secret_service_unlock_set_enter (gpointer set)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	XlockClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
-	const gchar *prompt = NULL;
-	gchar **xlocked = NULL;
-	GError *error = NULL;
-	GVariant *retval;
-	guint i;
+	if (set != NULL)
+		g_private_set (&xlock_set_entered, set);
+}
 
-	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
-	if (error != NULL) {
-		g_simple_async_result_take_error (res, error);
-		g_simple_async_result_complete (res);
+void
+_secret_service_unlock_set_leave (gpointer data)
+{
+	XlockSet *set = data;
+	GPtrArray *members;
 
-	} else {
-		g_variant_get (retval, "(^ao&o)", &xlocked, &prompt);
+	if (set == NULL)
+		return;
 
-		if (_secret_util_empty_path (prompt)) {
-			for (i = 0; xlocked[i]; i++)
-				g_ptr_array_add (closure->xlocked, g_strdup (xlocked[i]));
-			g_simple_async_result_complete (res);
+	if (g_private_get (&xlock_set_entered) == set)
+		g_private_set (&xlock_set_entered, NULL);
 
-		} else {
-			closure->prompt = _secret_prompt_instance (self, prompt);
-			secret_service_prompt (self, closure->prompt, G_VARIANT_TYPE ("ao"),
-			                       closure->cancellable, on_xlock_prompted, g_object_ref (res));
-		}
+	G_LOCK (xlock_calls);
+	g_assert (set->pending > 0);
+	set->pending--;
+	members = xlock_set_steal_ready (set);
+	G_UNLOCK (xlock_calls);
 
-		g_strfreev (xlocked);
-		g_variant_unref (retval);
+	if (members != NULL) {
+		xlock_set_commit (set->service, members);
+		g_ptr_array_unref (members);
 	}
 
-	g_object_unref (self);
-	g_object_unref (res);
+	xlock_set_unref (set);
 }
 
+/*
+ * Concurrent callers asking to lock or unlock the same set of paths share a
+ * single D-Bus call, and therefore at most a single prompt. Each caller
+ * completes early if its own cancellable is cancelled, and the call itself
+ * is only cancelled once nobody is left waiting on it.
+ *
+ * Unlock requests made while an unlock set is open in the thread default
+ * main context, or by an operation that joined the set, are held back and
+ * sent together as one Unlock call once the set is ended and every operation
+ * that joined it is accounted for. See secret_service_begin_unlock_set().
+ */
 void
 _secret_service_xlock_paths_async (SecretService *self,
                                    const gchar *method,
@@ -1111,18 +1937,37 @@ _secret_service_xlock_paths_async (SecretService *self,
 {
 	GSimpleAsyncResult *res;
 	XlockClosure *closure;
+	GMainContext *context;
+	XlockSet *set = NULL;
 
 	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
 	                                 _secret_service_xlock_paths_async);
 	closure = g_slice_new0 (XlockClosure);
-	closure->cancellable = cancellable ? g_object_ref (cancellable) : cancellable;
 	closure->xlocked = g_ptr_array_new_with_free_func (g_free);
+	closure->paths = g_strdupv ((gchar **)paths);
 	g_simple_async_result_set_op_res_gpointer (res, closure, xlock_closure_free);
 
-	g_dbus_proxy_call (G_DBUS_PROXY (self), method,
-	                   g_variant_new ("(@ao)", g_variant_new_objv (paths, -1)),
-	                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
-	                   cancellable, on_xlock_called, g_object_ref (res));
+	if (cancellable) {
+		closure->cancellable = g_object_ref (cancellable);
+		closure->cancelled_sig = g_cancellable_connect (cancellable,
+		                                                G_CALLBACK (on_xlock_cancelled),
+		                                                res, NULL);
+	}
+
+	if (g_str_equal (method, "Unlock")) {
+		context = g_main_context_ref_thread_default ();
+		G_LOCK (xlock_calls);
+		set = g_private_get (&xlock_set_entered);
+		if (set == NULL || set->service != self)
+			set = _secret_service_unlock_set_lookup (self, context);
+		if (set != NULL)
+			g_ptr_array_add (set->members, g_object_ref (res));
+		G_UNLOCK (xlock_calls);
+		g_main_context_unref (context);
+	}
+
+	if (set == NULL)
+		xlock_begin (self, res, method, paths);
 
 	g_object_unref (res);
 }
@@ -1521,6 +2366,53 @@ _secret_service_delete_path (SecretService *self,
 	g_object_unref (res);
 }
 
+/* Only runs a main loop if the service asks for a prompt */
+gboolean
+_secret_service_delete_path_sync (SecretService *self,
+                                  const gchar *object_path,
+                                  gboolean is_an_item,
+                                  GCancellable *cancellable,
+                                  GError **error)
+{
+	const gchar *prompt_path;
+	GVariant *retval;
+	GVariant *prompted;
+	GError *lerror = NULL;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (object_path != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+	                                      g_dbus_proxy_get_name (G_DBUS_PROXY (self)), object_path,
+	                                      is_an_item ? SECRET_ITEM_INTERFACE : SECRET_COLLECTION_INTERFACE,
+	                                      "Delete", g_variant_new ("()"), G_VARIANT_TYPE ("(o)"),
+	                                      G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+	                                      cancellable, error);
+	if (retval == NULL) {
+		_secret_util_strip_remote_error (error);
+		return FALSE;
+	}
+
+	g_variant_get (retval, "(&o)", &prompt_path);
+	if (!_secret_util_empty_path (prompt_path)) {
+		prompted = secret_service_prompt_at_dbus_path_sync (self, prompt_path, cancellable,
+		                                                    NULL, &lerror);
+		if (prompted != NULL)
+			g_variant_unref (prompted);
+	}
+
+	g_variant_unref (retval);
+
+	if (lerror != NULL) {
+		g_propagate_error (error, lerror);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 gboolean
 _secret_service_delete_path_finish (SecretService *self,
                                     GAsyncResult *result,
@@ -1624,28 +2516,12 @@ secret_service_delete_item_dbus_path_sync (SecretService *self,
                                            GCancellable *cancellable,
                                            GError **error)
 {
-	SecretSync *sync;
-	gboolean result;
-
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (item_path != NULL, FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_delete_item_dbus_path (self, item_path, cancellable,
-	                                      _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	result = secret_service_delete_item_dbus_path_finish (self, sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
-
-	return result;
+	return _secret_service_delete_path_sync (self, item_path, TRUE, cancellable, error);
 }
 
 typedef struct {
@@ -2145,11 +3021,21 @@ secret_service_create_item_dbus_path_finish (SecretService *self,
 	return path;
 }
 
-void
+gchar *
 _secret_service_create_item_dbus_path_finish_raw (GAsyncResult *result,
                                                   GError **error)
 {
-	g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error);
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (result);
+	ItemClosure *closure;
+	gchar *path;
+
+	if (g_simple_async_result_propagate_error (res, error))
+		return NULL;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	path = closure->item_path;
+	closure->item_path = NULL;
+	return path;
 }
 
 /**
@@ -2197,7 +3083,13 @@ secret_service_create_item_dbus_path_sync (SecretService *self,
                                            GCancellable *cancellable,
                                            GError **error)
 {
-	SecretSync *sync;
+	const gchar *prompt_path = NULL;
+	const gchar *item_path = NULL;
+	SecretSession *session;
+	GVariant *prompted;
+	GVariant *params;
+	GVariant *retval;
+	GDBusProxy *proxy;
 	gchar *path;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
@@ -2206,22 +3098,98 @@ secret_service_create_item_dbus_path_sync (SecretService *self,
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
+	if (!secret_service_ensure_session_sync (self, cancellable, error))
+		return NULL;
 
-	secret_service_create_item_dbus_path (self, collection_path, properties, value, flags,
-	                                      cancellable, _secret_sync_on_result, sync);
+	session = _secret_service_get_session (self);
+	params = g_variant_new ("(@a{sv}@(oayays)b)",
+	                        _secret_util_variant_for_properties (properties),
+	                        _secret_session_encode_secret (session, value),
+	                        (flags & SECRET_ITEM_CREATE_REPLACE) ? TRUE : FALSE);
 
-	g_main_loop_run (sync->loop);
+	proxy = G_DBUS_PROXY (self);
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (proxy),
+	                                      g_dbus_proxy_get_name (proxy),
+	                                      collection_path, SECRET_COLLECTION_INTERFACE,
+	                                      "CreateItem", params, G_VARIANT_TYPE ("(oo)"),
+	                                      G_DBUS_CALL_FLAGS_NONE, -1,
+	                                      cancellable, error);
+	if (retval == NULL) {
+		_secret_util_strip_remote_error (error);
+		return NULL;
+	}
 
-	path = secret_service_create_item_dbus_path_finish (self, sync->result, error);
+	g_variant_get (retval, "(&o&o)", &item_path, &prompt_path);
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	/* Only a prompt needs a main loop */
+	if (_secret_util_empty_path (prompt_path)) {
+		path = g_strdup (item_path);
+	} else {
+		path = NULL;
+		prompted = secret_service_prompt_at_dbus_path_sync (self, prompt_path, cancellable,
+		                                                    G_VARIANT_TYPE ("o"), error);
+		if (prompted != NULL) {
+			path = g_variant_dup_string (prompted, NULL);
+			g_variant_unref (prompted);
+		}
+	}
 
+	g_variant_unref (retval);
 	return path;
 }
 
+typedef struct {
+	gchar *alias;
+	gchar *collection_path;
+} AliasClosure;
+
+static void
+alias_closure_free (gpointer data)
+{
+	AliasClosure *closure = data;
+	g_free (closure->alias);
+	g_free (closure->collection_path);
+	g_slice_free (AliasClosure, closure);
+}
+
+static gchar *
+alias_collection_path (GVariant *retval)
+{
+	gchar *collection_path;
+
+	g_variant_get (retval, "(o)", &collection_path);
+	if (g_str_equal (collection_path, "/")) {
+		g_free (collection_path);
+		collection_path = NULL;
+	}
+
+	return collection_path;
+}
+
+static void
+on_read_alias (GObject *source,
+               GAsyncResult *result,
+               gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	AliasClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (self), result, &error);
+	if (error == NULL) {
+		closure->collection_path = alias_collection_path (retval);
+		_secret_service_cache_alias (self, closure->alias, closure->collection_path);
+		g_variant_unref (retval);
+	} else {
+		g_simple_async_result_take_error (res, error);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
 /**
  * secret_service_read_alias_dbus_path: (skip)
  * @self: a secret service object
@@ -2234,6 +3202,9 @@ secret_service_create_item_dbus_path_sync (SecretService *self,
  * well known collections, such as 'default'. This method looks up the
  * dbus object path of the well known collection.
  *
+ * The answer is remembered until the collections of the service change, so
+ * looking up the same alias again does not contact the service.
+ *
  * This method will return immediately and complete asynchronously.
  *
  * Stability: Unstable
@@ -2245,14 +3216,30 @@ secret_service_read_alias_dbus_path (SecretService *self,
                                      GAsyncReadyCallback callback,
                                      gpointer user_data)
 {
+	GSimpleAsyncResult *res;
+	AliasClosure *closure;
+
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (alias != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-	g_dbus_proxy_call (G_DBUS_PROXY (self), "ReadAlias",
-	                   g_variant_new ("(s)", alias),
-	                   G_DBUS_CALL_FLAGS_NONE, -1,
-	                   cancellable, callback, user_data);
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_service_read_alias_dbus_path);
+	closure = g_slice_new0 (AliasClosure);
+	closure->alias = g_strdup (alias);
+	g_simple_async_result_set_op_res_gpointer (res, closure, alias_closure_free);
+
+	if (_secret_service_lookup_alias (self, alias, &closure->collection_path, NULL)) {
+		g_simple_async_result_complete_in_idle (res);
+
+	} else {
+		g_dbus_proxy_call (G_DBUS_PROXY (self), "ReadAlias",
+		                   g_variant_new ("(s)", alias),
+		                   G_DBUS_CALL_FLAGS_NONE, -1,
+		                   cancellable, on_read_alias, g_object_ref (res));
+	}
+
+	g_object_unref (res);
 }
 
 /**
@@ -2274,23 +3261,22 @@ secret_service_read_alias_dbus_path_finish (SecretService *self,
                                             GAsyncResult *result,
                                             GError **error)
 {
+	GSimpleAsyncResult *res;
+	AliasClosure *closure;
 	gchar *collection_path;
-	GVariant *retval;
 
-	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (self), result, error);
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_service_read_alias_dbus_path), NULL);
 
-	_secret_util_strip_remote_error (error);
-	if (retval == NULL)
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
 		return NULL;
 
-	g_variant_get (retval, "(o)", &collection_path);
-	g_variant_unref (retval);
-
-	if (g_str_equal (collection_path, "/")) {
-		g_free (collection_path);
-		collection_path = NULL;
-	}
-
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	collection_path = closure->collection_path;
+	closure->collection_path = NULL;
 	return collection_path;
 }
 
@@ -2318,29 +3304,56 @@ secret_service_read_alias_dbus_path_sync (SecretService *self,
                                           GCancellable *cancellable,
                                           GError **error)
 {
-	SecretSync *sync;
 	gchar *collection_path;
+	GVariant *retval;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (alias != NULL, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
+	if (_secret_service_lookup_alias (self, alias, &collection_path, NULL))
+		return collection_path;
 
-	secret_service_read_alias_dbus_path (self, alias, cancellable, _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
+	retval = g_dbus_proxy_call_sync (G_DBUS_PROXY (self), "ReadAlias",
+	                                 g_variant_new ("(s)", alias),
+	                                 G_DBUS_CALL_FLAGS_NONE, -1,
+	                                 cancellable, error);
 
-	collection_path = secret_service_read_alias_dbus_path_finish (self, sync->result, error);
+	_secret_util_strip_remote_error (error);
+	if (retval == NULL)
+		return NULL;
 
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	collection_path = alias_collection_path (retval);
+	_secret_service_cache_alias (self, alias, collection_path);
+	g_variant_unref (retval);
 
 	return collection_path;
 }
 
+static void
+on_set_alias (GObject *source,
+              GAsyncResult *result,
+              gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	AliasClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (self), result, &error);
+	if (error == NULL) {
+		_secret_service_cache_alias (self, closure->alias, closure->collection_path);
+		g_variant_unref (retval);
+	} else {
+		g_simple_async_result_take_error (res, error);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
 /**
  * secret_service_set_alias_to_dbus_path: (skip)
  * @self: a secret service object
@@ -2366,6 +3379,9 @@ secret_service_set_alias_to_dbus_path (SecretService *self,
                                        GAsyncReadyCallback callback,
                                        gpointer user_data)
 {
+	GSimpleAsyncResult *res;
+	AliasClosure *closure;
+
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (alias != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
@@ -2375,10 +3391,20 @@ secret_service_set_alias_to_dbus_path (SecretService *self,
 	else
 		g_return_if_fail (g_variant_is_object_path (collection_path));
 
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_service_set_alias_to_dbus_path);
+	closure = g_slice_new0 (AliasClosure);
+	closure->alias = g_strdup (alias);
+	if (!g_str_equal (collection_path, "/"))
+		closure->collection_path = g_strdup (collection_path);
+	g_simple_async_result_set_op_res_gpointer (res, closure, alias_closure_free);
+
 	g_dbus_proxy_call (G_DBUS_PROXY (self), "SetAlias",
 	                   g_variant_new ("(so)", alias, collection_path),
 	                   G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
-	                   callback, user_data);
+	                   on_set_alias, g_object_ref (res));
+
+	g_object_unref (res);
 }
 
 /**
@@ -2398,18 +3424,14 @@ secret_service_set_alias_to_dbus_path_finish (SecretService *self,
                                               GAsyncResult *result,
                                               GError **error)
 {
-	GVariant *retval;
-
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_service_set_alias_to_dbus_path), FALSE);
 
-	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (self), result, error);
-
-	_secret_util_strip_remote_error (error);
-	if (retval == NULL)
+	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
 		return FALSE;
 
-	g_variant_unref (retval);
 	return TRUE;
 }
 
@@ -16,8 +16,10 @@
 #define __SECRET_PRIVATE_H__
 
 #include <gio/gio.h>
+#include <gio/gunixfdlist.h>
 
 #include "secret-item.h"
+#include "secret-item-info.h"
 #include "secret-service.h"
 #include "secret-value.h"
 
@@ -27,10 +29,13 @@ typedef struct {
 	GAsyncResult *result;
 	GMainContext *context;
 	GMainLoop *loop;
+	gboolean cached;
 } SecretSync;
 
 typedef struct _SecretSession SecretSession;
 
+typedef struct _SecretAttributes SecretAttributes;
+
 #define              SECRET_ALIAS_PREFIX                      "/org/freedesktop/secrets/aliases/"
 
 #define              SECRET_SERVICE_PATH                      "/org/freedesktop/secrets"
@@ -42,6 +47,11 @@ typedef struct _SecretSession SecretSession;
 #define              SECRET_PROMPT_INTERFACE                  "org.freedesktop.Secret.Prompt"
 #define              SECRET_SERVICE_INTERFACE                 "org.freedesktop.Secret.Service"
 
+#define              SECRET_ITEM_FD_INTERFACE                 "org.gnome.libsecret.Item.Fd"
+
+/* Secrets at least this large are passed in memory files when possible */
+#define              SECRET_FD_TRANSFER_THRESHOLD             (64 * 1024)
+
 #define              SECRET_SIGNAL_COLLECTION_CREATED "CollectionCreated"
 #define              SECRET_SIGNAL_COLLECTION_CHANGED "CollectionChanged"
 #define              SECRET_SIGNAL_COLLECTION_DELETED "CollectionDeleted"
@@ -52,6 +62,8 @@ typedef struct _SecretSession SecretSession;
 
 #define              SECRET_PROPERTIES_INTERFACE              "org.freedesktop.DBus.Properties"
 
+#define              SECRET_OBJECT_MANAGER_INTERFACE          "org.freedesktop.DBus.ObjectManager"
+
 SecretSync *         _secret_sync_new                         (void);
 
 void                 _secret_sync_free                        (gpointer data);
@@ -79,10 +91,33 @@ gint                 _secret_util_array_index_of              (GVariant *array,
 
 GType                _secret_list_get_type                    (void) G_GNUC_CONST;
 
-GVariant *           _secret_attributes_to_variant            (GHashTable *attributes,
+GType                _secret_attributes_get_type              (void) G_GNUC_CONST;
+
+SecretAttributes *   _secret_attributes_new_for_table         (GHashTable *attributes,
                                                                const gchar *schema_name);
 
-GHashTable *         _secret_attributes_for_variant           (GVariant *variant);
+SecretAttributes *   _secret_attributes_new_for_variant       (GVariant *variant);
+
+SecretAttributes *   _secret_attributes_ref                   (SecretAttributes *attrs);
+
+void                 _secret_attributes_unref                 (gpointer attrs);
+
+guint                _secret_attributes_get_length            (SecretAttributes *attrs);
+
+const gchar *        _secret_attributes_lookup                (SecretAttributes *attrs,
+                                                               const gchar *name);
+
+guint                _secret_attributes_hash                  (gconstpointer attrs);
+
+gboolean             _secret_attributes_equal                 (gconstpointer one,
+                                                               gconstpointer two);
+
+GVariant *           _secret_attributes_get_variant           (SecretAttributes *attrs);
+
+GHashTable *         _secret_attributes_to_table              (SecretAttributes *attrs);
+
+GVariant *           _secret_attributes_to_variant            (GHashTable *attributes,
+                                                               const gchar *schema_name);
 
 GHashTable *         _secret_attributes_copy                  (GHashTable *attributes);
 
@@ -104,6 +139,12 @@ gboolean             _secret_util_get_properties_finish       (GDBusProxy *proxy
                                                                GAsyncResult *result,
                                                                GError **error);
 
+gboolean             _secret_util_want_properties             (GDBusProxy *proxy);
+
+gboolean             _secret_util_get_properties_sync         (GDBusProxy *proxy,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
 void                 _secret_util_set_property                (GDBusProxy *proxy,
                                                                const gchar *property,
                                                                GVariant *value,
@@ -130,6 +171,25 @@ SecretSession *      _secret_service_get_session              (SecretService *se
 void                 _secret_service_take_session             (SecretService *self,
                                                                SecretSession *session);
 
+gboolean             _secret_service_get_fd_transfer          (SecretService *self);
+
+void                 _secret_service_disable_fd_transfer      (SecretService *self);
+
+gboolean             _secret_service_lookup_alias             (SecretService *self,
+                                                               const gchar *alias,
+                                                               gchar **collection_path,
+                                                               gboolean *locked);
+
+void                 _secret_service_cache_alias              (SecretService *self,
+                                                               const gchar *alias,
+                                                               const gchar *collection_path);
+
+void                 _secret_service_set_alias_locked         (SecretService *self,
+                                                               const gchar *alias,
+                                                               gboolean locked);
+
+void                 _secret_service_forget_aliases           (SecretService *self);
+
 void                 _secret_service_delete_path              (SecretService *self,
                                                                const gchar *object_path,
                                                                gboolean is_an_item,
@@ -141,6 +201,12 @@ gboolean             _secret_service_delete_path_finish       (SecretService *se
                                                                GAsyncResult *result,
                                                                GError **error);
 
+gboolean             _secret_service_delete_path_sync         (SecretService *self,
+                                                               const gchar *object_path,
+                                                               gboolean is_an_item,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
 void                 _secret_service_search_for_paths_variant (SecretService *self,
                                                                GVariant *attributes,
                                                                GCancellable *cancellable,
@@ -150,9 +216,33 @@ void                 _secret_service_search_for_paths_variant (SecretService *se
 SecretItem *         _secret_service_find_item_instance       (SecretService *self,
                                                                const gchar *item_path);
 
+void                 _secret_service_register_proxy           (SecretService *self,
+                                                               GDBusProxy *proxy);
+
+void                 _secret_service_unregister_proxy         (SecretService *self,
+                                                               const gchar *object_path);
+
+GDBusProxyFlags      _secret_service_get_proxy_flags          (SecretService *self);
+
+SecretItem *         _secret_service_lookup_item              (SecretService *self,
+                                                               const gchar *item_path);
+
 SecretCollection *   _secret_service_find_collection_instance (SecretService *self,
                                                                const gchar *collection_path);
 
+void                 _secret_service_get_managed_objects      (SecretService *self,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+GHashTable *         _secret_service_get_managed_objects_finish (SecretService *self,
+                                                                 GAsyncResult *result,
+                                                                 GError **error);
+
+GHashTable *         _secret_service_get_managed_objects_sync (SecretService *self,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
 SecretValue *        _secret_service_decode_get_secrets_first (SecretService *self,
                                                                GVariant *out);
 
@@ -171,7 +261,38 @@ gint                 _secret_service_xlock_paths_finish       (SecretService *se
                                                                gchar ***xlocked,
                                                                GError **error);
 
-void                 _secret_service_create_item_dbus_path_finish_raw  (GAsyncResult *result,
+gpointer             _secret_service_xlock_lookup             (SecretService *self,
+                                                               const gchar *key);
+
+void                 _secret_service_xlock_insert             (SecretService *self,
+                                                               const gchar *key,
+                                                               gpointer call);
+
+void                 _secret_service_xlock_remove             (SecretService *self,
+                                                               const gchar *key,
+                                                               gpointer call);
+
+gpointer             _secret_service_unlock_set_lookup        (SecretService *self,
+                                                               GMainContext *context);
+
+void                 _secret_service_unlock_set_insert        (SecretService *self,
+                                                               GMainContext *context,
+                                                               gpointer set);
+
+void                 _secret_service_unlock_set_remove        (SecretService *self,
+                                                               GMainContext *context);
+
+void                 _secret_service_unlock_set_begin         (SecretService *self);
+
+void                 _secret_service_unlock_set_end           (SecretService *self);
+
+gpointer             _secret_service_unlock_set_join          (SecretService *self);
+
+void                 _secret_service_unlock_set_enter         (gpointer set);
+
+void                 _secret_service_unlock_set_leave         (gpointer set);
+
+gchar *              _secret_service_create_item_dbus_path_finish_raw  (GAsyncResult *result,
                                                                         GError **error);
 
 GHashTable *         _secret_collection_properties_new        (const gchar *label);
@@ -179,10 +300,58 @@ GHashTable *         _secret_collection_properties_new        (const gchar *labe
 SecretItem *         _secret_collection_find_item_instance    (SecretCollection *self,
                                                                const gchar *item_path);
 
+void                 _secret_collection_load_items_with_objects (SecretCollection *self,
+                                                                 GHashTable *objects,
+                                                                 GCancellable *cancellable,
+                                                                 GAsyncReadyCallback callback,
+                                                                 gpointer user_data);
+
+gboolean             _secret_collection_load_items_with_objects_sync (SecretCollection *self,
+                                                                      GHashTable *objects,
+                                                                      GCancellable *cancellable,
+                                                                      GError **error);
+
+void                 _secret_collection_new_for_properties    (SecretService *service,
+                                                               const gchar *collection_path,
+                                                               GVariant *properties,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+SecretCollection *   _secret_collection_new_for_properties_sync (SecretService *service,
+                                                                 const gchar *collection_path,
+                                                                 GVariant *properties,
+                                                                 GCancellable *cancellable,
+                                                                 GError **error);
+
+void                 _secret_item_new_for_properties          (SecretService *service,
+                                                               const gchar *item_path,
+                                                               GVariant *properties,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+SecretItem *         _secret_item_new_for_properties_sync     (SecretService *service,
+                                                               const gchar *item_path,
+                                                               GVariant *properties,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
+SecretItemInfoList * _secret_item_info_list_new               (guint reserve);
+
+void                 _secret_item_info_list_add               (SecretItemInfoList *list,
+                                                               const gchar *path,
+                                                               GVariant *properties);
+
+SecretItemInfoList * _secret_item_info_list_seal              (SecretItemInfoList *list);
+
 gchar *              _secret_value_unref_to_password          (SecretValue *value);
 
 gchar *              _secret_value_unref_to_string            (SecretValue *value);
 
+gboolean             _secret_value_equal                      (SecretValue *one,
+                                                               SecretValue *two);
+
 void                 _secret_session_free                     (gpointer data);
 
 const gchar *        _secret_session_get_algorithms           (SecretSession *session);
@@ -203,9 +372,22 @@ GVariant *           _secret_session_encode_secret            (SecretSession *se
 SecretValue *        _secret_session_decode_secret            (SecretSession *session,
                                                                GVariant *encoded);
 
+gboolean             _secret_session_can_transfer_fds         (void);
+
+GVariant *           _secret_session_encode_secret_fd         (SecretSession *session,
+                                                               SecretValue *value,
+                                                               GUnixFDList *fds,
+                                                               GError **error);
+
+SecretValue *        _secret_session_decode_secret_fd         (SecretSession *session,
+                                                               GVariant *encoded,
+                                                               GUnixFDList *fds);
+
 void                 _secret_item_set_cached_secret           (SecretItem *self,
                                                                SecretValue *value);
 
+SecretAttributes *   _secret_item_ref_attributes              (SecretItem *self);
+
 const SecretSchema * _secret_schema_ref_if_nonstatic          (const SecretSchema *schema);
 
 void                 _secret_schema_unref_if_nonstatic        (const SecretSchema *schema);
@@ -477,11 +477,14 @@ secret_prompt_perform (SecretPrompt *self,
 	                                                      g_object_ref (res),
 	                                                      g_object_unref);
 
-	closure->watch = g_bus_watch_name_on_connection (closure->connection, owner_name,
-	                                                 G_BUS_NAME_WATCHER_FLAGS_NONE, NULL,
-	                                                 on_prompt_vanished,
-	                                                 g_object_ref (res),
-	                                                 g_object_unref);
+	/* No names to watch on a peer to peer connection */
+	if (owner_name != NULL) {
+		closure->watch = g_bus_watch_name_on_connection (closure->connection, owner_name,
+		                                                 G_BUS_NAME_WATCHER_FLAGS_NONE, NULL,
+		                                                 on_prompt_vanished,
+		                                                 g_object_ref (res),
+		                                                 g_object_unref);
+	}
 
 	if (closure->async_cancellable) {
 		closure->cancelled_sig = g_cancellable_connect (closure->async_cancellable,
@@ -28,6 +28,8 @@
 
 #include "egg/egg-secure-memory.h"
 
+#include <string.h>
+
 /**
  * SECTION:secret-service
  * @title: SecretService
@@ -101,6 +103,13 @@
  *                               while initializing the #SecretService
  * @SECRET_SERVICE_LOAD_COLLECTIONS: load collections while initializing the
  *                                   #SecretService
+ * @SECRET_SERVICE_SHARED_SIGNALS: listen for changes to all collections and
+ *                                 items with a single match rule, rather than
+ *                                 one per proxy. Only affects collection and item
+ *                                 proxies created afterwards.
+ * @SECRET_SERVICE_FD_TRANSFER: pass large secrets in sealed memory file
+ *                              descriptors, when both the D-Bus connection
+ *                              and the service support it
  *
  * Flags which determine which parts of the #SecretService proxy are initialized
  * during a secret_service_get() or secret_service_open() operation.
@@ -116,6 +125,50 @@ enum {
 	PROP_COLLECTIONS
 };
 
+typedef struct {
+	const gchar *method;
+	gint64 started;
+} CallPending;
+
+typedef struct {
+	guint64 calls;
+	guint64 errors;
+	gint64 total_time;
+	gint64 max_time;
+	guint64 histogram[SECRET_SERVICE_CALL_HISTOGRAM_SIZE];
+} CallStats;
+
+/*
+ * The connection filter that collects call statistics runs in the D-Bus
+ * worker thread, and may still be running after it has been removed. So
+ * the statistics live apart from the service, and the filter holds its
+ * own reference to them.
+ */
+typedef struct {
+	gint refs;
+	GWeakRef service;
+
+	/* Set before the filter is added, no change afterwards */
+	gchar *name;
+
+	/* Locked by mutex */
+	GMutex mutex;
+	GHashTable *pending;
+	GHashTable *stats;
+	gint64 swept;
+	SecretServiceCallFunc func;
+	gpointer func_data;
+	GDestroyNotify func_destroy;
+	GMainContext *func_context;
+} CallTracker;
+
+typedef struct {
+	CallTracker *tracker;
+	const gchar *method;
+	gint64 elapsed;
+	gboolean failed;
+} CallDone;
+
 struct _SecretServicePrivate {
 	/* No change between construct and finalize */
 	GCancellable *cancellable;
@@ -125,6 +178,34 @@ struct _SecretServicePrivate {
 	GMutex mutex;
 	gpointer session;
 	GHashTable *collections;
+	GHashTable *xlocks;
+	GHashTable *unlock_sets;
+	GHashTable *proxies;
+	GHashTable *aliases;
+	gboolean share_signals;
+	guint shared_signals;
+	gboolean no_object_manager;
+	gboolean fd_transfer;
+	GPtrArray *session_waiters;
+	guint session_negotiations;
+
+	/* Shared with the D-Bus worker thread */
+	CallTracker *calls;
+	guint call_filter;
+	gulong call_closed_sig;
+};
+
+typedef struct {
+	gchar *collection_path;
+	gboolean locked;
+} AliasInfo;
+
+enum {
+	DEBUG_TIMING = 1 << 0,
+};
+
+static const GDebugKey debug_keys[] = {
+	{ "timing", DEBUG_TIMING },
 };
 
 G_LOCK_DEFINE (service_instance);
@@ -222,6 +303,298 @@ service_cache_instance (SecretService *instance)
 		g_bus_unwatch_name (watch);
 }
 
+static guint
+service_debug_flags (void)
+{
+	static gsize initialized = 0;
+	static guint flags = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		flags = g_parse_debug_string (g_getenv ("SECRET_DEBUG"), debug_keys,
+		                              G_N_ELEMENTS (debug_keys));
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return flags;
+}
+
+/* Calls which never get a reply are forgotten after this long */
+#define CALL_PENDING_EXPIRY (5 * 60 * G_USEC_PER_SEC)
+
+static void
+call_pending_free (gpointer data)
+{
+	g_slice_free (CallPending, data);
+}
+
+static void
+call_stats_free (gpointer data)
+{
+	g_slice_free (CallStats, data);
+}
+
+static CallTracker *
+call_tracker_new (SecretService *service)
+{
+	CallTracker *tracker;
+
+	tracker = g_slice_new0 (CallTracker);
+	tracker->refs = 1;
+	g_weak_ref_init (&tracker->service, service);
+	g_mutex_init (&tracker->mutex);
+	tracker->pending = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                          NULL, call_pending_free);
+	tracker->stats = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                        NULL, call_stats_free);
+	return tracker;
+}
+
+static CallTracker *
+call_tracker_ref (CallTracker *tracker)
+{
+	g_atomic_int_inc (&tracker->refs);
+	return tracker;
+}
+
+static void
+call_tracker_unref (gpointer data)
+{
+	CallTracker *tracker = data;
+
+	if (!g_atomic_int_dec_and_test (&tracker->refs))
+		return;
+
+	if (tracker->func_destroy)
+		(tracker->func_destroy) (tracker->func_data);
+	if (tracker->func_context)
+		g_main_context_unref (tracker->func_context);
+	g_weak_ref_clear (&tracker->service);
+	g_free (tracker->name);
+	g_hash_table_destroy (tracker->pending);
+	g_hash_table_destroy (tracker->stats);
+	g_mutex_clear (&tracker->mutex);
+	g_slice_free (CallTracker, tracker);
+}
+
+/* Called with the tracker mutex held */
+static void
+call_tracker_expire (CallTracker *tracker,
+                     gint64 now)
+{
+	GHashTableIter iter;
+	CallPending *pending;
+
+	if (now - tracker->swept < CALL_PENDING_EXPIRY)
+		return;
+
+	tracker->swept = now;
+	g_hash_table_iter_init (&iter, tracker->pending);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&pending)) {
+		if (now - pending->started > CALL_PENDING_EXPIRY)
+			g_hash_table_iter_remove (&iter);
+	}
+}
+
+static guint
+call_histogram_bucket (gint64 elapsed)
+{
+	gint64 msecs = elapsed / 1000;
+	guint bucket;
+
+	/* Bucket zero is under a millisecond, then doubling from there */
+	if (msecs <= 0)
+		return 0;
+	bucket = g_bit_storage (msecs);
+	return MIN (bucket, SECRET_SERVICE_CALL_HISTOGRAM_SIZE - 1);
+}
+
+static void
+call_done_free (gpointer data)
+{
+	CallDone *done = data;
+	call_tracker_unref (done->tracker);
+	g_slice_free (CallDone, done);
+}
+
+/* Runs in the main context the call function was set from */
+static gboolean
+on_call_done (gpointer user_data)
+{
+	CallDone *done = user_data;
+	CallTracker *tracker = done->tracker;
+	SecretServiceCallFunc func;
+	gpointer func_data;
+	SecretService *self;
+
+	self = g_weak_ref_get (&tracker->service);
+	if (self == NULL)
+		return FALSE;
+
+	g_mutex_lock (&tracker->mutex);
+	func = tracker->func;
+	func_data = tracker->func_data;
+	g_mutex_unlock (&tracker->mutex);
+
+	if (func != NULL)
+		(func) (self, done->method, done->elapsed, done->failed, func_data);
+
+	g_object_unref (self);
+	return FALSE;
+}
+
+static void
+call_tracker_completed (CallTracker *tracker,
+                        guint32 serial,
+                        gboolean failed)
+{
+	GMainContext *context = NULL;
+	const gchar *method = NULL;
+	CallPending *pending;
+	CallStats *stats;
+	CallDone *done;
+	gint64 elapsed = 0;
+
+	g_mutex_lock (&tracker->mutex);
+
+	pending = g_hash_table_lookup (tracker->pending, GUINT_TO_POINTER (serial));
+	if (pending != NULL) {
+		method = pending->method;
+		elapsed = g_get_monotonic_time () - pending->started;
+		g_hash_table_remove (tracker->pending, GUINT_TO_POINTER (serial));
+
+		stats = g_hash_table_lookup (tracker->stats, method);
+		if (stats == NULL) {
+			stats = g_slice_new0 (CallStats);
+			g_hash_table_insert (tracker->stats, (gpointer)method, stats);
+		}
+
+		stats->calls++;
+		if (failed)
+			stats->errors++;
+		stats->total_time += elapsed;
+		stats->max_time = MAX (stats->max_time, elapsed);
+		stats->histogram[call_histogram_bucket (elapsed)]++;
+
+		if (tracker->func != NULL)
+			context = g_main_context_ref (tracker->func_context);
+	}
+
+	g_mutex_unlock (&tracker->mutex);
+
+	if (method == NULL)
+		return;
+
+	if (service_debug_flags () & DEBUG_TIMING)
+		g_message ("%s took %" G_GINT64_FORMAT " usec%s", method, elapsed,
+		           failed ? " and failed" : "");
+
+	/*
+	 * Nothing here may hold the service, or its last reference could be
+	 * dropped in this thread. So the function is run in its main context.
+	 */
+	if (context != NULL) {
+		done = g_slice_new (CallDone);
+		done->tracker = call_tracker_ref (tracker);
+		done->method = method;
+		done->elapsed = elapsed;
+		done->failed = failed;
+		g_main_context_invoke_full (context, G_PRIORITY_DEFAULT,
+		                            on_call_done, done, call_done_free);
+		g_main_context_unref (context);
+	}
+}
+
+/* Runs in the D-Bus worker thread for every message on the connection */
+static GDBusMessage *
+on_service_call_filter (GDBusConnection *connection,
+                        GDBusMessage *message,
+                        gboolean incoming,
+                        gpointer user_data)
+{
+	CallTracker *tracker = user_data;
+	CallPending *pending;
+
+	switch (g_dbus_message_get_message_type (message)) {
+	case G_DBUS_MESSAGE_TYPE_METHOD_CALL:
+		if (incoming || g_dbus_message_get_flags (message) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED)
+			break;
+		if (g_strcmp0 (g_dbus_message_get_destination (message), tracker->name) != 0)
+			break;
+		pending = g_slice_new (CallPending);
+		pending->method = g_intern_string (g_dbus_message_get_member (message));
+		pending->started = g_get_monotonic_time ();
+		g_mutex_lock (&tracker->mutex);
+		call_tracker_expire (tracker, pending->started);
+		g_hash_table_replace (tracker->pending,
+		                      GUINT_TO_POINTER (g_dbus_message_get_serial (message)),
+		                      pending);
+		g_mutex_unlock (&tracker->mutex);
+		break;
+	case G_DBUS_MESSAGE_TYPE_METHOD_RETURN:
+	case G_DBUS_MESSAGE_TYPE_ERROR:
+		if (incoming)
+			call_tracker_completed (tracker, g_dbus_message_get_reply_serial (message),
+			                        g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_ERROR);
+		break;
+	default:
+		break;
+	}
+
+	return message;
+}
+
+static void
+on_service_connection_closed (GDBusConnection *connection,
+                              gboolean remote_peer_vanished,
+                              GError *error,
+                              gpointer user_data)
+{
+	CallTracker *tracker = user_data;
+
+	/* No replies will come for the calls still pending */
+	g_mutex_lock (&tracker->mutex);
+	g_hash_table_remove_all (tracker->pending);
+	g_mutex_unlock (&tracker->mutex);
+}
+
+static void
+service_add_call_filter (SecretService *self)
+{
+	GDBusConnection *connection;
+	CallTracker *tracker;
+
+	if (self->pv->call_filter != 0)
+		return;
+
+	tracker = self->pv->calls;
+	tracker->name = g_strdup (g_dbus_proxy_get_name (G_DBUS_PROXY (self)));
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+	self->pv->call_filter = g_dbus_connection_add_filter (connection, on_service_call_filter,
+	                                                      call_tracker_ref (tracker),
+	                                                      call_tracker_unref);
+	self->pv->call_closed_sig = g_signal_connect_data (connection, "closed",
+	                                                   G_CALLBACK (on_service_connection_closed),
+	                                                   call_tracker_ref (tracker),
+	                                                   (GClosureNotify)call_tracker_unref, 0);
+}
+
+static void
+proxy_weak_ref_free (gpointer data)
+{
+	GWeakRef *ref = data;
+	g_weak_ref_clear (ref);
+	g_slice_free (GWeakRef, ref);
+}
+
+static void
+alias_info_free (gpointer data)
+{
+	AliasInfo *info = data;
+	g_free (info->collection_path);
+	g_slice_free (AliasInfo, info);
+}
+
 static void
 secret_service_init (SecretService *self)
 {
@@ -230,6 +603,16 @@ secret_service_init (SecretService *self)
 
 	g_mutex_init (&self->pv->mutex);
 	self->pv->cancellable = g_cancellable_new ();
+	self->pv->xlocks = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->pv->unlock_sets = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                               (GDestroyNotify)g_main_context_unref,
+	                                               NULL);
+	self->pv->proxies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                           proxy_weak_ref_free);
+	self->pv->aliases = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                           alias_info_free);
+
+	self->pv->calls = call_tracker_new (self);
 }
 
 static void
@@ -271,13 +654,195 @@ secret_service_set_property (GObject *obj,
 	}
 }
 
+static void
+service_match_rule (SecretService *self,
+                    const gchar *method)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	GDBusConnection *connection;
+	gchar *rule;
+
+	connection = g_dbus_proxy_get_connection (proxy);
+
+	/* No bus daemon to talk to on a peer to peer connection */
+	if (g_dbus_connection_get_unique_name (connection) == NULL)
+		return;
+
+	rule = g_strdup_printf ("type='signal',sender='%s',path_namespace='%s'",
+	                        g_dbus_proxy_get_name (proxy),
+	                        g_dbus_proxy_get_object_path (proxy));
+
+	g_dbus_connection_call (connection, "org.freedesktop.DBus", "/org/freedesktop/DBus",
+	                        "org.freedesktop.DBus", method, g_variant_new ("(s)", rule),
+	                        NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+
+	g_free (rule);
+}
+
+static void
+proxy_apply_properties_changed (GDBusProxy *proxy,
+                                GVariant *parameters)
+{
+	const gchar *interface_name;
+	const gchar **invalidated;
+	GVariantIter iter;
+	GVariant *changed;
+	const gchar *name;
+	GVariant *value;
+	guint i;
+
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+		return;
+
+	g_variant_get (parameters, "(&s@a{sv}^a&s)", &interface_name, &changed, &invalidated);
+
+	/* The same thing GDBusProxy would have done with its own subscription */
+	if (g_str_equal (interface_name, g_dbus_proxy_get_interface_name (proxy))) {
+		g_variant_iter_init (&iter, changed);
+		while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+			g_dbus_proxy_set_cached_property (proxy, name, value);
+			g_variant_unref (value);
+		}
+		for (i = 0; invalidated[i] != NULL; i++)
+			g_dbus_proxy_set_cached_property (proxy, invalidated[i], NULL);
+		g_signal_emit_by_name (proxy, "g-properties-changed", changed, invalidated);
+	}
+
+	g_variant_unref (changed);
+	g_free (invalidated);
+}
+
+static GDBusProxy *    service_lookup_proxy    (SecretService *self,
+                                                const gchar *object_path);
+
+static void
+on_shared_signal (GDBusConnection *connection,
+                  const gchar *sender_name,
+                  const gchar *object_path,
+                  const gchar *interface_name,
+                  const gchar *signal_name,
+                  GVariant *parameters,
+                  gpointer user_data)
+{
+	SecretService *self;
+	GDBusProxy *proxy;
+
+	self = g_weak_ref_get (user_data);
+	if (self == NULL)
+		return;
+
+	proxy = service_lookup_proxy (self, object_path);
+
+	/*
+	 * Only deliver what the proxy doesn't get through a subscription of its
+	 * own. A proxy that didn't load its properties doesn't watch for changes
+	 * to them either, and one created before sharing was turned on still has
+	 * its own subscription to the interface signals.
+	 */
+	if (proxy != NULL) {
+		if (g_str_equal (interface_name, SECRET_PROPERTIES_INTERFACE)) {
+			if (g_str_equal (signal_name, "PropertiesChanged") &&
+			    g_dbus_proxy_get_flags (proxy) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+				proxy_apply_properties_changed (proxy, parameters);
+		} else if (g_str_equal (interface_name, g_dbus_proxy_get_interface_name (proxy))) {
+			if (g_dbus_proxy_get_flags (proxy) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS)
+				g_signal_emit_by_name (proxy, "g-signal", sender_name, signal_name, parameters);
+		}
+	}
+
+	if (proxy != NULL)
+		g_object_unref (proxy);
+	g_object_unref (self);
+}
+
+static void
+service_subscribe_shared (SecretService *self)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	gboolean subscribed = FALSE;
+	GWeakRef *ref;
+
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->shared_signals == 0) {
+		ref = g_slice_new (GWeakRef);
+		g_weak_ref_init (ref, self);
+		self->pv->shared_signals = g_dbus_connection_signal_subscribe (g_dbus_proxy_get_connection (proxy),
+		                                                               g_dbus_proxy_get_name (proxy),
+		                                                               NULL, NULL, NULL, NULL,
+		                                                               G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+		                                                               on_shared_signal, ref,
+		                                                               proxy_weak_ref_free);
+		subscribed = TRUE;
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	/* One rule covering every object below the service */
+	if (subscribed)
+		service_match_rule (self, "AddMatch");
+}
+
+static void
+service_share_signals (SecretService *self)
+{
+	g_mutex_lock (&self->pv->mutex);
+	self->pv->share_signals = TRUE;
+	g_mutex_unlock (&self->pv->mutex);
+
+	service_subscribe_shared (self);
+}
+
+GDBusProxyFlags
+_secret_service_get_proxy_flags (SecretService *self)
+{
+	GDBusProxyFlags flags = G_DBUS_PROXY_FLAGS_NONE;
+
+	if (self == NULL)
+		return flags;
+
+	/*
+	 * Without these the proxy adds match rules of its own. Its properties
+	 * get loaded when it is initialized instead.
+	 */
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->share_signals)
+		flags |= G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+		         G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES;
+	g_mutex_unlock (&self->pv->mutex);
+
+	return flags;
+}
+
 static void
 secret_service_dispose (GObject *obj)
 {
 	SecretService *self = SECRET_SERVICE (obj);
+	guint shared_signals;
 
 	g_cancellable_cancel (self->pv->cancellable);
 
+	g_mutex_lock (&self->pv->mutex);
+	shared_signals = self->pv->shared_signals;
+	self->pv->shared_signals = 0;
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (shared_signals != 0) {
+		g_dbus_connection_signal_unsubscribe (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+		                                      shared_signals);
+		service_match_rule (self, "RemoveMatch");
+	}
+
+	if (self->pv->call_filter != 0) {
+		g_dbus_connection_remove_filter (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+		                                 self->pv->call_filter);
+		self->pv->call_filter = 0;
+	}
+
+	if (self->pv->call_closed_sig != 0) {
+		g_signal_handler_disconnect (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+		                             self->pv->call_closed_sig);
+		self->pv->call_closed_sig = 0;
+	}
+
 	G_OBJECT_CLASS (secret_service_parent_class)->dispose (obj);
 }
 
@@ -289,9 +854,16 @@ secret_service_finalize (GObject *obj)
 	_secret_session_free (self->pv->session);
 	if (self->pv->collections)
 		g_hash_table_destroy (self->pv->collections);
+	g_hash_table_destroy (self->pv->xlocks);
+	g_hash_table_destroy (self->pv->unlock_sets);
+	g_hash_table_destroy (self->pv->proxies);
+	g_hash_table_destroy (self->pv->aliases);
 	g_clear_object (&self->pv->cancellable);
 	g_mutex_clear (&self->pv->mutex);
 
+	secret_service_set_call_func (self, NULL, NULL, NULL);
+	call_tracker_unref (self->pv->calls);
+
 	G_OBJECT_CLASS (secret_service_parent_class)->finalize (obj);
 }
 
@@ -375,6 +947,7 @@ handle_property_changed (SecretService *self,
 	g_variant_ref_sink (value);
 
 	if (g_str_equal (property_name, "Collections")) {
+		_secret_service_forget_aliases (self);
 
 		g_mutex_lock (&self->pv->mutex);
 		perform = self->pv->collections != NULL;
@@ -416,7 +989,9 @@ secret_service_signal (GDBusProxy *proxy,
 	SecretCollection *collection;
 	const gchar *collection_path;
 	GVariantBuilder builder;
+	GHashTableIter aliases;
 	gboolean found = FALSE;
+	AliasInfo *alias;
 	GVariantIter iter;
 	GVariant *value;
 	GVariant *paths;
@@ -471,6 +1046,13 @@ secret_service_signal (GDBusProxy *proxy,
 
 		g_mutex_lock (&self->pv->mutex);
 
+		/* It may have been locked or unlocked, no longer assume either */
+		g_hash_table_iter_init (&aliases, self->pv->aliases);
+		while (g_hash_table_iter_next (&aliases, NULL, (gpointer *)&alias)) {
+			if (g_strcmp0 (alias->collection_path, collection_path) == 0)
+				alias->locked = FALSE;
+		}
+
 		if (self->pv->collections)
 			collection = g_hash_table_lookup (self->pv->collections, collection_path);
 		else
@@ -576,12 +1158,35 @@ init_closure_free (gpointer data)
 	g_slice_free (InitClosure, closure);
 }
 
+static void
+service_enable_fd_transfer (SecretService *self)
+{
+	GDBusConnection *connection;
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+	if (!(g_dbus_connection_get_capabilities (connection) & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
+		return;
+	if (!_secret_session_can_transfer_fds ())
+		return;
+
+	g_mutex_lock (&self->pv->mutex);
+	self->pv->fd_transfer = TRUE;
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 static gboolean
 service_ensure_for_flags_sync (SecretService *self,
                                SecretServiceFlags flags,
                                GCancellable *cancellable,
                                GError **error)
 {
+	/* Before any collections or items are loaded below */
+	if (flags & SECRET_SERVICE_SHARED_SIGNALS)
+		service_share_signals (self);
+
+	if (flags & SECRET_SERVICE_FD_TRANSFER)
+		service_enable_fd_transfer (self);
+
 	if (flags & SECRET_SERVICE_OPEN_SESSION)
 		if (!secret_service_ensure_session_sync (self, cancellable, error))
 			return FALSE;
@@ -628,7 +1233,7 @@ on_ensure_session (GObject *source,
 		                                 on_load_collections, g_object_ref (res));
 
 	} else {
-		g_simple_async_result_complete_in_idle (res);
+		g_simple_async_result_complete (res);
 	}
 
 	g_object_unref (res);
@@ -637,13 +1242,22 @@ on_ensure_session (GObject *source,
 static void
 service_ensure_for_flags_async (SecretService *self,
                                 SecretServiceFlags flags,
-                                GSimpleAsyncResult *res)
+                                GSimpleAsyncResult *res,
+                                gboolean in_callback)
 {
 	InitClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 
 	closure->flags = flags;
 
-	if (closure->flags & SECRET_SERVICE_OPEN_SESSION)
+	if (closure->flags & SECRET_SERVICE_SHARED_SIGNALS)
+		service_share_signals (self);
+
+	if (closure->flags & SECRET_SERVICE_FD_TRANSFER)
+		service_enable_fd_transfer (self);
+
+	/* An open session needs no round trip through secret_service_ensure_session() */
+	if (closure->flags & SECRET_SERVICE_OPEN_SESSION &&
+	    _secret_service_get_session (self) == NULL)
 		secret_service_ensure_session (self, closure->cancellable,
 		                               on_ensure_session, g_object_ref (res));
 
@@ -651,6 +1265,9 @@ service_ensure_for_flags_async (SecretService *self,
 		secret_service_load_collections (self, closure->cancellable,
 		                                 on_load_collections, g_object_ref (res));
 
+	else if (in_callback)
+		g_simple_async_result_complete (res);
+
 	else
 		g_simple_async_result_complete_in_idle (res);
 }
@@ -666,6 +1283,7 @@ secret_service_initable_init (GInitable *initable,
 		return FALSE;
 
 	self = SECRET_SERVICE (initable);
+	service_add_call_filter (self);
 	return service_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error);
 }
 
@@ -691,7 +1309,8 @@ on_init_base (GObject *source,
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 	} else {
-		service_ensure_for_flags_async (self, self->pv->init_flags, res);
+		service_add_call_filter (self);
+		service_ensure_for_flags_async (self, self->pv->init_flags, res, TRUE);
 	}
 
 	g_object_unref (res);
@@ -805,7 +1424,7 @@ secret_service_get (SecretServiceFlags flags,
 		closure->flags = flags;
 		g_simple_async_result_set_op_res_gpointer (res, closure, init_closure_free);
 
-		service_ensure_for_flags_async (service, flags, res);
+		service_ensure_for_flags_async (service, flags, res, FALSE);
 
 		g_object_unref (service);
 		g_object_unref (res);
@@ -1057,33 +1676,154 @@ secret_service_open_sync (GType service_gtype,
 	                       NULL);
 }
 
+static const gchar *
+connection_bus_name (GDBusConnection *connection,
+                     const gchar *service_bus_name)
+{
+	/* Peer to peer connections have no bus names */
+	if (service_bus_name == NULL && g_dbus_connection_get_unique_name (connection) != NULL)
+		service_bus_name = get_default_bus_name ();
+	return service_bus_name;
+}
+
 /**
- * secret_service_get_flags:
- * @self: the secret service proxy
+ * secret_service_open_for_connection:
+ * @service_gtype: the GType of the new secret service
+ * @connection: the D-Bus connection to use
+ * @service_bus_name: (allow-none): the D-Bus service name of the secret service
+ * @flags: flags for which service functionality to ensure is initialized
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
  *
- * Get the flags representing what features of the #SecretService proxy
- * have been initialized.
+ * Create a new #SecretService proxy for the Secret Service, which talks to
+ * it over @connection instead of the session bus.
  *
- * Use secret_service_ensure_session() or secret_service_load_collections()
- * to initialize further features and change the flags.
+ * @connection may be a peer to peer connection directly to the secret
+ * service, for example one made with g_dbus_connection_new_for_address().
+ * This avoids having each message relayed by the bus daemon. In that case
+ * @service_bus_name should be %NULL. For a message bus connection, if
+ * @service_bus_name is %NULL then the default is used.
  *
- * Returns: the flags for features initialized
+ * The @service_gtype argument should be set to %SECRET_TYPE_SERVICE or the type
+ * of a derived class.
+ *
+ * If @flags contains any flags of which parts of the secret service to
+ * ensure are initialized, then those will be initialized before returning.
+ *
+ * Use secret_service_open_finish() to get the result.
+ *
+ * This method will return immediately and complete asynchronously.
  */
-SecretServiceFlags
-secret_service_get_flags (SecretService *self)
+void
+secret_service_open_for_connection (GType service_gtype,
+                                    GDBusConnection *connection,
+                                    const gchar *service_bus_name,
+                                    SecretServiceFlags flags,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
 {
-	SecretServiceFlags flags = 0;
-
-	g_return_val_if_fail (SECRET_IS_SERVICE (self), SECRET_SERVICE_NONE);
-
-	g_mutex_lock (&self->pv->mutex);
+	g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (g_type_is_a (service_gtype, SECRET_TYPE_SERVICE));
 
-	if (self->pv->session)
-		flags |= SECRET_SERVICE_OPEN_SESSION;
-	if (self->pv->collections)
-		flags |= SECRET_SERVICE_LOAD_COLLECTIONS;
+	g_async_initable_new_async (service_gtype, G_PRIORITY_DEFAULT,
+	                            cancellable, callback, user_data,
+	                            "g-flags", G_DBUS_PROXY_FLAGS_NONE,
+	                            "g-interface-info", _secret_gen_service_interface_info (),
+	                            "g-name", connection_bus_name (connection, service_bus_name),
+	                            "g-connection", connection,
+	                            "g-object-path", SECRET_SERVICE_PATH,
+	                            "g-interface-name", SECRET_SERVICE_INTERFACE,
+	                            "flags", flags,
+	                            NULL);
+}
 
-	g_mutex_unlock (&self->pv->mutex);
+/**
+ * secret_service_open_for_connection_sync:
+ * @service_gtype: the GType of the new secret service
+ * @connection: the D-Bus connection to use
+ * @service_bus_name: (allow-none): the D-Bus service name of the secret service
+ * @flags: flags for which service functionality to ensure is initialized
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Create a new #SecretService proxy for the Secret Service, which talks to
+ * it over @connection instead of the session bus.
+ *
+ * @connection may be a peer to peer connection directly to the secret
+ * service, for example one made with g_dbus_connection_new_for_address_sync().
+ * This avoids having each message relayed by the bus daemon. In that case
+ * @service_bus_name should be %NULL. For a message bus connection, if
+ * @service_bus_name is %NULL then the default is used.
+ *
+ * The @service_gtype argument should be set to %SECRET_TYPE_SERVICE or a the
+ * type of a derived class.
+ *
+ * If @flags contains any flags of which parts of the secret service to
+ * ensure are initialized, then those will be initialized before returning.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: (transfer full): a new reference to a #SecretService proxy, which
+ *          should be released with g_object_unref().
+ */
+SecretService *
+secret_service_open_for_connection_sync (GType service_gtype,
+                                         GDBusConnection *connection,
+                                         const gchar *service_bus_name,
+                                         SecretServiceFlags flags,
+                                         GCancellable *cancellable,
+                                         GError **error)
+{
+	g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (g_type_is_a (service_gtype, SECRET_TYPE_SERVICE), NULL);
+
+	return g_initable_new (service_gtype, cancellable, error,
+	                       "g-flags", G_DBUS_PROXY_FLAGS_NONE,
+	                       "g-interface-info", _secret_gen_service_interface_info (),
+	                       "g-name", connection_bus_name (connection, service_bus_name),
+	                       "g-connection", connection,
+	                       "g-object-path", SECRET_SERVICE_PATH,
+	                       "g-interface-name", SECRET_SERVICE_INTERFACE,
+	                       "flags", flags,
+	                       NULL);
+}
+
+/**
+ * secret_service_get_flags:
+ * @self: the secret service proxy
+ *
+ * Get the flags representing what features of the #SecretService proxy
+ * have been initialized.
+ *
+ * Use secret_service_ensure_session() or secret_service_load_collections()
+ * to initialize further features and change the flags.
+ *
+ * Returns: the flags for features initialized
+ */
+SecretServiceFlags
+secret_service_get_flags (SecretService *self)
+{
+	SecretServiceFlags flags = 0;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), SECRET_SERVICE_NONE);
+
+	g_mutex_lock (&self->pv->mutex);
+
+	if (self->pv->session)
+		flags |= SECRET_SERVICE_OPEN_SESSION;
+	if (self->pv->collections)
+		flags |= SECRET_SERVICE_LOAD_COLLECTIONS;
+	if (self->pv->share_signals)
+		flags |= SECRET_SERVICE_SHARED_SIGNALS;
+	if (self->pv->fd_transfer)
+		flags |= SECRET_SERVICE_FD_TRANSFER;
+
+	g_mutex_unlock (&self->pv->mutex);
 
 	return flags;
 }
@@ -1125,6 +1865,191 @@ secret_service_get_collections (SecretService *self)
 	return collections;
 }
 
+/**
+ * secret_service_set_call_func:
+ * @self: the secret service proxy
+ * @func: (allow-none): called when each D-Bus method call to the service completes
+ * @user_data: data to pass to @func
+ * @destroy: (allow-none): called to free @user_data
+ *
+ * Set a function which is called each time a D-Bus method call to the
+ * secret service completes, with the name of the method, how long it
+ * took in microseconds, and whether it failed. This replaces any
+ * function set previously. As with secret_service_get_call_stats() this
+ * includes all calls to the secret service on the proxy's connection.
+ *
+ * @func is called in the thread default main context of the caller of
+ * this function, shortly after each call completes.
+ *
+ * Setting the <literal>SECRET_DEBUG</literal> environment variable to
+ * <literal>timing</literal> logs the same information as a message.
+ */
+void
+secret_service_set_call_func (SecretService *self,
+                              SecretServiceCallFunc func,
+                              gpointer user_data,
+                              GDestroyNotify destroy)
+{
+	GDestroyNotify old_destroy;
+	GMainContext *old_context;
+	gpointer old_data;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->calls->mutex);
+	old_destroy = self->pv->calls->func_destroy;
+	old_data = self->pv->calls->func_data;
+	old_context = self->pv->calls->func_context;
+	self->pv->calls->func = func;
+	self->pv->calls->func_data = user_data;
+	self->pv->calls->func_destroy = destroy;
+	self->pv->calls->func_context = func ? g_main_context_ref_thread_default () : NULL;
+	g_mutex_unlock (&self->pv->calls->mutex);
+
+	if (old_destroy)
+		(old_destroy) (old_data);
+	if (old_context)
+		g_main_context_unref (old_context);
+}
+
+/**
+ * secret_service_get_call_methods:
+ * @self: the secret service proxy
+ *
+ * Get the names of the D-Bus methods which have been called on the
+ * secret service, and for which secret_service_get_call_stats() has
+ * statistics.
+ *
+ * Returns: (transfer full): a %NULL terminated array of method names,
+ *          to be freed with g_strfreev()
+ */
+gchar **
+secret_service_get_call_methods (SecretService *self)
+{
+	GHashTableIter iter;
+	GPtrArray *methods;
+	gpointer method;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+
+	methods = g_ptr_array_new ();
+
+	g_mutex_lock (&self->pv->calls->mutex);
+	g_hash_table_iter_init (&iter, self->pv->calls->stats);
+	while (g_hash_table_iter_next (&iter, &method, NULL))
+		g_ptr_array_add (methods, g_strdup (method));
+	g_mutex_unlock (&self->pv->calls->mutex);
+
+	g_ptr_array_add (methods, NULL);
+	return (gchar **)g_ptr_array_free (methods, FALSE);
+}
+
+/**
+ * secret_service_get_call_stats:
+ * @self: the secret service proxy
+ * @method: the name of a D-Bus method, such as <literal>SearchItems</literal>
+ * @errors: (out) (allow-none): location to place the number of failed calls
+ * @total_time: (out) (allow-none): location to place the total time taken
+ *              by the calls, in microseconds
+ * @max_time: (out) (allow-none): location to place the time taken by the
+ *            slowest call, in microseconds
+ * @histogram: (out caller-allocates) (array fixed-size=16) (allow-none):
+ *             location to place %SECRET_SERVICE_CALL_HISTOGRAM_SIZE counts
+ *
+ * Get statistics about the calls to a D-Bus method of the secret service.
+ * These are collected from the time the #SecretService proxy is initialized.
+ *
+ * Calls are counted per D-Bus connection rather than per proxy: every
+ * method call sent on the proxy's connection to the secret service's bus
+ * name is included, even when made by another #SecretService proxy or
+ * other code sharing that connection.
+ *
+ * The first bucket of @histogram counts calls which took less than a
+ * millisecond. Each following bucket counts the calls which took up to
+ * twice as long as the previous one, and the last bucket counts all
+ * slower calls.
+ *
+ * Returns: the number of completed calls to the method
+ */
+guint64
+secret_service_get_call_stats (SecretService *self,
+                               const gchar *method,
+                               guint64 *errors,
+                               gint64 *total_time,
+                               gint64 *max_time,
+                               guint64 *histogram)
+{
+	CallStats empty = { 0, };
+	CallStats *stats;
+	guint64 calls;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), 0);
+	g_return_val_if_fail (method != NULL, 0);
+
+	g_mutex_lock (&self->pv->calls->mutex);
+
+	stats = g_hash_table_lookup (self->pv->calls->stats, method);
+	if (stats == NULL)
+		stats = &empty;
+
+	calls = stats->calls;
+	if (errors)
+		*errors = stats->errors;
+	if (total_time)
+		*total_time = stats->total_time;
+	if (max_time)
+		*max_time = stats->max_time;
+	if (histogram)
+		memcpy (histogram, stats->histogram, sizeof (stats->histogram));
+
+	g_mutex_unlock (&self->pv->calls->mutex);
+
+	return calls;
+}
+
+/**
+ * secret_service_reset_call_stats:
+ * @self: the secret service proxy
+ *
+ * Forget the statistics collected about calls to the secret service.
+ */
+void
+secret_service_reset_call_stats (SecretService *self)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->calls->mutex);
+	g_hash_table_remove_all (self->pv->calls->stats);
+	g_mutex_unlock (&self->pv->calls->mutex);
+}
+
+/**
+ * secret_service_get_session_negotiations:
+ * @self: the secret service proxy
+ *
+ * Get the number of times a session has been negotiated with the secret
+ * service by this proxy. Concurrent callers of secret_service_ensure_session()
+ * share one negotiation, so this is normally one once a session is open.
+ *
+ * This is provided for instrumentation, together with
+ * secret_service_get_call_stats().
+ *
+ * Returns: the number of session negotiations that have completed successfully
+ */
+guint
+secret_service_get_session_negotiations (SecretService *self)
+{
+	guint count;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), 0);
+
+	g_mutex_lock (&self->pv->mutex);
+	count = self->pv->session_negotiations;
+	g_mutex_unlock (&self->pv->mutex);
+
+	return count;
+}
+
 SecretItem *
 _secret_service_find_item_instance (SecretService *self,
                                     const gchar *item_path)
@@ -1140,7 +2065,7 @@ _secret_service_find_item_instance (SecretService *self,
 	g_free (collection_path);
 
 	if (collection == NULL)
-		return NULL;
+		return _secret_service_lookup_item (self, item_path);
 
 	item = _secret_collection_find_item_instance (collection, item_path);
 	g_object_unref (collection);
@@ -1148,6 +2073,82 @@ _secret_service_find_item_instance (SecretService *self,
 	return item;
 }
 
+void
+_secret_service_register_proxy (SecretService *self,
+                                GDBusProxy *proxy)
+{
+	const gchar *object_path;
+	GWeakRef *ref;
+
+	object_path = g_dbus_proxy_get_object_path (proxy);
+
+	/* The newest live proxy for a path wins */
+	g_mutex_lock (&self->pv->mutex);
+	ref = g_hash_table_lookup (self->pv->proxies, object_path);
+	if (ref == NULL) {
+		ref = g_slice_new (GWeakRef);
+		g_weak_ref_init (ref, proxy);
+		g_hash_table_insert (self->pv->proxies, g_strdup (object_path), ref);
+	} else {
+		g_weak_ref_set (ref, proxy);
+	}
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_unregister_proxy (SecretService *self,
+                                  const gchar *object_path)
+{
+	GDBusProxy *proxy;
+	GWeakRef *ref;
+
+	g_mutex_lock (&self->pv->mutex);
+	ref = g_hash_table_lookup (self->pv->proxies, object_path);
+	if (ref != NULL) {
+		/* Only drop the entry if no other proxy took it over */
+		proxy = g_weak_ref_get (ref);
+		if (proxy == NULL)
+			g_hash_table_remove (self->pv->proxies, object_path);
+	} else {
+		proxy = NULL;
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (proxy != NULL)
+		g_object_unref (proxy);
+}
+
+static GDBusProxy *
+service_lookup_proxy (SecretService *self,
+                      const gchar *object_path)
+{
+	GDBusProxy *proxy = NULL;
+	GWeakRef *ref;
+
+	g_mutex_lock (&self->pv->mutex);
+	ref = g_hash_table_lookup (self->pv->proxies, object_path);
+	if (ref != NULL)
+		proxy = g_weak_ref_get (ref);
+	g_mutex_unlock (&self->pv->mutex);
+
+	return proxy;
+}
+
+SecretItem *
+_secret_service_lookup_item (SecretService *self,
+                             const gchar *item_path)
+{
+	GDBusProxy *proxy;
+
+	proxy = service_lookup_proxy (self, item_path);
+	if (proxy != NULL && !SECRET_IS_ITEM (proxy)) {
+		g_object_unref (proxy);
+		proxy = NULL;
+	}
+
+	return (SecretItem *)proxy;
+}
+
 SecretCollection *
 _secret_service_find_collection_instance (SecretService *self,
                                           const gchar *collection_path)
@@ -1165,6 +2166,85 @@ _secret_service_find_collection_instance (SecretService *self,
 	return collection;
 }
 
+gboolean
+_secret_service_lookup_alias (SecretService *self,
+                              const gchar *alias,
+                              gchar **collection_path,
+                              gboolean *locked)
+{
+	AliasInfo *info;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (alias != NULL, FALSE);
+
+	g_mutex_lock (&self->pv->mutex);
+	info = g_hash_table_lookup (self->pv->aliases, alias);
+	if (info != NULL) {
+		if (collection_path)
+			*collection_path = g_strdup (info->collection_path);
+		if (locked)
+			*locked = info->locked;
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	return info != NULL;
+}
+
+void
+_secret_service_cache_alias (SecretService *self,
+                             const gchar *alias,
+                             const gchar *collection_path)
+{
+	SecretCollection *collection = NULL;
+	AliasInfo *info;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (alias != NULL);
+
+	if (collection_path != NULL)
+		collection = _secret_service_find_collection_instance (self, collection_path);
+
+	info = g_slice_new0 (AliasInfo);
+	info->collection_path = g_strdup (collection_path);
+
+	/* A loaded collection knows whether it is locked, otherwise assume not */
+	if (collection != NULL) {
+		info->locked = secret_collection_get_locked (collection);
+		g_object_unref (collection);
+	}
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_replace (self->pv->aliases, g_strdup (alias), info);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_set_alias_locked (SecretService *self,
+                                  const gchar *alias,
+                                  gboolean locked)
+{
+	AliasInfo *info;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (alias != NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	info = g_hash_table_lookup (self->pv->aliases, alias);
+	if (info != NULL && info->collection_path != NULL)
+		info->locked = locked;
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_forget_aliases (SecretService *self)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_remove_all (self->pv->aliases);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 SecretSession *
 _secret_service_get_session (SecretService *self)
 {
@@ -1194,6 +2274,102 @@ _secret_service_take_session (SecretService *self,
 	g_mutex_unlock (&self->pv->mutex);
 }
 
+/*
+ * The lock and unlock calls in flight, keyed by their method and paths, so
+ * that later requests for the same paths can wait on them. The callers in
+ * secret-paths.c own the calls, and serialize lookups against their own
+ * bookkeeping.
+ */
+gpointer
+_secret_service_xlock_lookup (SecretService *self,
+                              const gchar *key)
+{
+	gpointer call;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (key != NULL, NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	call = g_hash_table_lookup (self->pv->xlocks, key);
+	g_mutex_unlock (&self->pv->mutex);
+
+	return call;
+}
+
+void
+_secret_service_xlock_insert (SecretService *self,
+                              const gchar *key,
+                              gpointer call)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (key != NULL);
+	g_return_if_fail (call != NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_replace (self->pv->xlocks, g_strdup (key), call);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_xlock_remove (SecretService *self,
+                              const gchar *key,
+                              gpointer call)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (key != NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	if (g_hash_table_lookup (self->pv->xlocks, key) == call)
+		g_hash_table_remove (self->pv->xlocks, key);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+/*
+ * The unlock sets opened with secret_service_begin_unlock_set(), one per
+ * thread default main context. Owned by the callers in secret-paths.c.
+ */
+gpointer
+_secret_service_unlock_set_lookup (SecretService *self,
+                                   GMainContext *context)
+{
+	gpointer set;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (context != NULL, NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	set = g_hash_table_lookup (self->pv->unlock_sets, context);
+	g_mutex_unlock (&self->pv->mutex);
+
+	return set;
+}
+
+void
+_secret_service_unlock_set_insert (SecretService *self,
+                                   GMainContext *context,
+                                   gpointer set)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (context != NULL);
+	g_return_if_fail (set != NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_replace (self->pv->unlock_sets, g_main_context_ref (context), set);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_unlock_set_remove (SecretService *self,
+                                   GMainContext *context)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (context != NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_remove (self->pv->unlock_sets, context);
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 /**
  * secret_service_get_session_algorithms:
  * @self: the secret service proxy
@@ -1254,6 +2430,83 @@ secret_service_get_session_dbus_path (SecretService *self)
 	return path;
 }
 
+typedef struct {
+	GCancellable *cancellable;
+	gulong cancelled_sig;
+	gint completed;
+} SessionWaiter;
+
+static void
+session_waiter_free (gpointer data)
+{
+	SessionWaiter *waiter = data;
+	if (waiter->cancelled_sig)
+		g_cancellable_disconnect (waiter->cancellable, waiter->cancelled_sig);
+	g_clear_object (&waiter->cancellable);
+	g_slice_free (SessionWaiter, waiter);
+}
+
+/* Exactly one of the negotiation or cancellation gets to complete each waiter */
+static gboolean
+session_waiter_claim (GSimpleAsyncResult *res)
+{
+	SessionWaiter *waiter = g_simple_async_result_get_op_res_gpointer (res);
+	return g_atomic_int_compare_and_exchange (&waiter->completed, 0, 1);
+}
+
+static void
+on_session_waiter_cancelled (GCancellable *cancellable,
+                             gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	GError *error = NULL;
+
+	/* May run in any thread, the negotiation carries on for everyone else */
+	if (session_waiter_claim (res) && g_cancellable_set_error_if_cancelled (cancellable, &error)) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete_in_idle (res);
+	}
+}
+
+static void
+on_ensure_session_opened (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	SecretService *self = SECRET_SERVICE (source);
+	GSimpleAsyncResult *res;
+	GPtrArray *waiters;
+	GError *error = NULL;
+	guint i;
+
+	_secret_session_open_finish (result, &error);
+
+	g_mutex_lock (&self->pv->mutex);
+	waiters = self->pv->session_waiters;
+	self->pv->session_waiters = NULL;
+	if (error == NULL)
+		self->pv->session_negotiations++;
+	g_mutex_unlock (&self->pv->mutex);
+
+	for (i = 0; i < waiters->len; i++) {
+		res = waiters->pdata[i];
+		if (!session_waiter_claim (res))
+			continue;
+		if (error != NULL)
+			g_simple_async_result_set_from_error (res, error);
+
+		/* The first waiter started the negotiation in this main context */
+		if (i == 0)
+			g_simple_async_result_complete (res);
+		else
+			g_simple_async_result_complete_in_idle (res);
+	}
+
+	g_ptr_array_unref (waiters);
+	g_clear_error (&error);
+	g_object_unref (user_data);
+}
+
 /**
  * secret_service_ensure_session:
  * @self: the secret service
@@ -1269,6 +2522,9 @@ secret_service_get_session_dbus_path (SecretService *self)
  * to secret_service_get() in order to ensure that a session has been established
  * by the time you get the #SecretService proxy.
  *
+ * If a session is already being established, then this operation waits for
+ * that to complete rather than negotiating another one.
+ *
  * This method will return immediately and complete asynchronously.
  */
 void
@@ -1278,24 +2534,49 @@ secret_service_ensure_session (SecretService *self,
                                gpointer user_data)
 {
 	GSimpleAsyncResult *res;
-	SecretSession *session;
+	SessionWaiter *waiter;
+	gboolean negotiate = FALSE;
+	gboolean complete = FALSE;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_service_ensure_session);
+	waiter = g_slice_new0 (SessionWaiter);
+	g_simple_async_result_set_op_res_gpointer (res, waiter, session_waiter_free);
+
 	g_mutex_lock (&self->pv->mutex);
-	session = self->pv->session;
+	if (self->pv->session != NULL) {
+		complete = TRUE;
+	} else {
+		if (self->pv->session_waiters == NULL) {
+			self->pv->session_waiters = g_ptr_array_new_with_free_func (g_object_unref);
+			negotiate = TRUE;
+		}
+		g_ptr_array_add (self->pv->session_waiters, g_object_ref (res));
+	}
 	g_mutex_unlock (&self->pv->mutex);
 
-	if (session == NULL) {
-		_secret_session_open (self, cancellable, callback, user_data);
+	/* A waiter that is cancelled stops waiting, without disturbing the others */
+	if (!complete && cancellable) {
+		waiter->cancellable = g_object_ref (cancellable);
+		waiter->cancelled_sig = g_cancellable_connect (cancellable,
+		                                               G_CALLBACK (on_session_waiter_cancelled),
+		                                               res, NULL);
+	}
 
-	} else {
-		res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
-		                                 secret_service_ensure_session);
+	/*
+	 * The negotiation is shared by all waiters, so it is not tied to any one
+	 * caller's cancellable, but to the lifetime of the service.
+	 */
+	if (negotiate)
+		_secret_session_open (self, self->pv->cancellable,
+		                      on_ensure_session_opened, g_object_ref (self));
+	else if (complete)
 		g_simple_async_result_complete_in_idle (res);
-		g_object_unref (res);
-	}
+
+	g_object_unref (res);
 }
 
 /**
@@ -1316,17 +2597,41 @@ secret_service_ensure_session_finish (SecretService *self,
 {
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_service_ensure_session), FALSE);
 
-	if (!g_simple_async_result_is_valid (result, G_OBJECT (self),
-	                                     secret_service_ensure_session)) {
-		if (!_secret_session_open_finish (result, error))
-			return FALSE;
-	}
+	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
+		return FALSE;
 
 	g_return_val_if_fail (self->pv->session != NULL, FALSE);
 	return TRUE;
 }
 
+gboolean
+_secret_service_get_fd_transfer (SecretService *self)
+{
+	gboolean fd_transfer;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
+
+	g_mutex_lock (&self->pv->mutex);
+	fd_transfer = self->pv->fd_transfer;
+	g_mutex_unlock (&self->pv->mutex);
+
+	return fd_transfer;
+}
+
+/* Called when the service turns out not to implement the fd interface */
+void
+_secret_service_disable_fd_transfer (SecretService *self)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->mutex);
+	self->pv->fd_transfer = FALSE;
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 /**
  * secret_service_ensure_session_sync:
  * @self: the secret service
@@ -1358,6 +2663,10 @@ secret_service_ensure_session_sync (SecretService *self,
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	/* Nothing to wait for once the session is open */
+	if (_secret_service_get_session (self) != NULL)
+		return TRUE;
+
 	sync = _secret_sync_new ();
 	g_main_context_push_thread_default (sync->context);
 
@@ -1414,9 +2723,188 @@ service_update_collections (SecretService *self,
 	g_object_notify (G_OBJECT (self), "collections");
 }
 
+static GHashTable *
+managed_objects_table_new (GVariant *retval)
+{
+	GHashTable *objects;
+	GVariant *interfaces;
+	GVariant *properties;
+	GVariant *array;
+	GVariantIter iter;
+	const gchar *path;
+
+	objects = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                 (GDestroyNotify)g_variant_unref);
+
+	array = g_variant_get_child_value (retval, 0);
+	g_variant_iter_init (&iter, array);
+	while (g_variant_iter_next (&iter, "{&o@a{sa{sv}}}", &path, &interfaces)) {
+		properties = g_variant_lookup_value (interfaces, SECRET_COLLECTION_INTERFACE,
+		                                     G_VARIANT_TYPE ("a{sv}"));
+		if (properties == NULL)
+			properties = g_variant_lookup_value (interfaces, SECRET_ITEM_INTERFACE,
+			                                     G_VARIANT_TYPE ("a{sv}"));
+		if (properties != NULL)
+			g_hash_table_insert (objects, g_strdup (path), properties);
+		g_variant_unref (interfaces);
+	}
+
+	g_variant_unref (array);
+	return objects;
+}
+
+static gboolean
+service_object_manager_unsupported (SecretService *self,
+                                    GError **error)
+{
+	if (!g_error_matches (*error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD) &&
+	    !g_error_matches (*error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED))
+		return FALSE;
+
+	/* Don't try again, callers load each object by itself instead */
+	g_mutex_lock (&self->pv->mutex);
+	self->pv->no_object_manager = TRUE;
+	g_mutex_unlock (&self->pv->mutex);
+
+	g_clear_error (error);
+	return TRUE;
+}
+
+static void
+on_get_managed_objects (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (retval != NULL) {
+		g_simple_async_result_set_op_res_gpointer (res, managed_objects_table_new (retval),
+		                                           (GDestroyNotify)g_hash_table_unref);
+		g_variant_unref (retval);
+
+	} else if (!service_object_manager_unsupported (self, &error)) {
+		g_simple_async_result_take_error (res, error);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+/*
+ * Get the properties of all the collections and items in the service with
+ * a single ObjectManager call. Completes with a NULL table if the service
+ * doesn't support that, in which case callers load each object by itself.
+ * Proxies seeded from the result don't watch their own properties, the
+ * service delivers PropertiesChanged to them instead.
+ */
+void
+_secret_service_get_managed_objects (SecretService *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	GSimpleAsyncResult *res;
+	gboolean supported;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 _secret_service_get_managed_objects);
+
+	g_mutex_lock (&self->pv->mutex);
+	supported = !self->pv->no_object_manager;
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (supported) {
+		/* Proxies seeded from the reply get property changes through this */
+		service_subscribe_shared (self);
+
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy),
+		                        g_dbus_proxy_get_object_path (proxy),
+		                        SECRET_OBJECT_MANAGER_INTERFACE, "GetManagedObjects",
+		                        NULL, G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
+		                        on_get_managed_objects, g_object_ref (res));
+	} else {
+		g_simple_async_result_complete_in_idle (res);
+	}
+
+	g_object_unref (res);
+}
+
+GHashTable *
+_secret_service_get_managed_objects_finish (SecretService *self,
+                                            GAsyncResult *result,
+                                            GError **error)
+{
+	GSimpleAsyncResult *res;
+	GHashTable *objects;
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      _secret_service_get_managed_objects), NULL);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return NULL;
+
+	objects = g_simple_async_result_get_op_res_gpointer (res);
+	return objects ? g_hash_table_ref (objects) : NULL;
+}
+
+GHashTable *
+_secret_service_get_managed_objects_sync (SecretService *self,
+                                          GCancellable *cancellable,
+                                          GError **error)
+{
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+	GError *lerror = NULL;
+	GHashTable *objects;
+	gboolean supported;
+	GVariant *retval;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	supported = !self->pv->no_object_manager;
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (!supported)
+		return NULL;
+
+	/* Proxies seeded from the reply get property changes through this */
+	service_subscribe_shared (self);
+
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (proxy),
+	                                      g_dbus_proxy_get_name (proxy),
+	                                      g_dbus_proxy_get_object_path (proxy),
+	                                      SECRET_OBJECT_MANAGER_INTERFACE, "GetManagedObjects",
+	                                      NULL, G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+	                                      G_DBUS_CALL_FLAGS_NONE, -1, cancellable, &lerror);
+	if (retval == NULL) {
+		if (!service_object_manager_unsupported (self, &lerror)) {
+			_secret_util_strip_remote_error (&lerror);
+			g_propagate_error (error, lerror);
+		}
+		return NULL;
+	}
+
+	objects = managed_objects_table_new (retval);
+	g_variant_unref (retval);
+	return objects;
+}
+
 typedef struct {
 	GCancellable *cancellable;
 	GHashTable *collections;
+	GHashTable *objects;
 	gint collections_loading;
 } EnsureClosure;
 
@@ -1433,25 +2921,22 @@ ensure_closure_free (gpointer data)
 	EnsureClosure *closure = data;
 	g_clear_object (&closure->cancellable);
 	g_hash_table_unref (closure->collections);
+	if (closure->objects)
+		g_hash_table_unref (closure->objects);
 	g_slice_free (EnsureClosure, closure);
 }
 
 static void
-on_ensure_collection (GObject *source,
-                      GAsyncResult *result,
-                      gpointer user_data)
+ensure_collection_done (SecretService *self,
+                        GSimpleAsyncResult *res,
+                        SecretCollection *collection,
+                        GError *error)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
 	EnsureClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretCollection *collection;
 	const gchar *path;
-	GError *error = NULL;
 
 	closure->collections_loading--;
 
-	collection = secret_collection_new_for_dbus_path_finish (result, &error);
-
 	if (error != NULL)
 		g_simple_async_result_take_error (res, error);
 
@@ -1464,11 +2949,163 @@ on_ensure_collection (GObject *source,
 		service_update_collections (self, closure->collections);
 		g_simple_async_result_complete (res);
 	}
+}
+
+static void
+on_ensure_collection (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	SecretCollection *collection;
+	GError *error = NULL;
+
+	collection = secret_collection_new_for_dbus_path_finish (result, &error);
+	ensure_collection_done (self, res, collection, error);
+
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+static void
+on_ensure_collection_items (GObject *source,
+                            GAsyncResult *result,
+                            gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	SecretCollection *collection = SECRET_COLLECTION (source);
+	GError *error = NULL;
+
+	if (secret_collection_load_items_finish (collection, result, &error))
+		ensure_collection_done (self, res, g_object_ref (collection), NULL);
+	else
+		ensure_collection_done (self, res, NULL, error);
+
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+static void
+on_ensure_collection_properties (GObject *source,
+                                 GAsyncResult *result,
+                                 gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	EnsureClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretCollection *collection;
+	GError *error = NULL;
+
+	collection = secret_collection_new_for_dbus_path_finish (result, &error);
+
+	/* Load the items from the same set of managed objects */
+	if (collection != NULL) {
+		_secret_collection_load_items_with_objects (collection, closure->objects,
+		                                            closure->cancellable,
+		                                            on_ensure_collection_items,
+		                                            g_object_ref (res));
+		g_object_unref (collection);
+	} else {
+		ensure_collection_done (self, res, NULL, error);
+	}
 
 	g_object_unref (self);
 	g_object_unref (res);
 }
 
+static void
+collections_load_paths (SecretService *self,
+                        GVariant *paths,
+                        GSimpleAsyncResult *res,
+                        gboolean in_callback)
+{
+	EnsureClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretCollection *collection;
+	GVariant *properties;
+	const gchar *path;
+	GVariantIter iter;
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_loop (&iter, "&o", &path)) {
+		collection = service_lookup_collection (self, path);
+
+		/* No such collection yet create a new one */
+		if (collection == NULL) {
+			properties = closure->objects ? g_hash_table_lookup (closure->objects, path) : NULL;
+			if (properties != NULL)
+				_secret_collection_new_for_properties (self, path, properties, closure->cancellable,
+				                                       on_ensure_collection_properties,
+				                                       g_object_ref (res));
+			else
+				secret_collection_new_for_dbus_path (self, path, SECRET_COLLECTION_LOAD_ITEMS,
+				                                     closure->cancellable, on_ensure_collection,
+				                                     g_object_ref (res));
+			closure->collections_loading++;
+		} else {
+			g_hash_table_insert (closure->collections, g_strdup (path), collection);
+		}
+	}
+
+	if (closure->collections_loading == 0) {
+		service_update_collections (self, closure->collections);
+		if (in_callback)
+			g_simple_async_result_complete (res);
+		else
+			g_simple_async_result_complete_in_idle (res);
+	}
+}
+
+static void
+on_ensure_objects (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (source);
+	EnsureClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	GVariant *paths;
+
+	closure->objects = _secret_service_get_managed_objects_finish (self, result, &error);
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
+
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	} else if (paths != NULL) {
+		collections_load_paths (self, paths, res, TRUE);
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	if (paths != NULL)
+		g_variant_unref (paths);
+	g_object_unref (res);
+}
+
+static guint
+service_count_missing_collections (SecretService *self,
+                                   GVariant *paths)
+{
+	SecretCollection *collection;
+	const gchar *path;
+	GVariantIter iter;
+	guint missing = 0;
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_loop (&iter, "&o", &path)) {
+		collection = service_lookup_collection (self, path);
+		if (collection == NULL)
+			missing++;
+		else
+			g_object_unref (collection);
+	}
+
+	return missing;
+}
+
 /**
  * secret_service_load_collections:
  * @self: the secret service
@@ -1493,11 +3130,8 @@ secret_service_load_collections (SecretService *self,
                                  gpointer user_data)
 {
 	EnsureClosure *closure;
-	SecretCollection *collection;
 	GSimpleAsyncResult *res;
-	const gchar *path;
 	GVariant *paths;
-	GVariantIter iter;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
@@ -1512,24 +3146,15 @@ secret_service_load_collections (SecretService *self,
 	closure->collections = collections_table_new ();
 	g_simple_async_result_set_op_res_gpointer (res, closure, ensure_closure_free);
 
-	g_variant_iter_init (&iter, paths);
-	while (g_variant_iter_loop (&iter, "&o", &path)) {
-		collection = service_lookup_collection (self, path);
-
-		/* No such collection yet create a new one */
-		if (collection == NULL) {
-			secret_collection_new_for_dbus_path (self, path, SECRET_COLLECTION_LOAD_ITEMS,
-			                                     cancellable, on_ensure_collection, g_object_ref (res));
-			closure->collections_loading++;
-		} else {
-			g_hash_table_insert (closure->collections, g_strdup (path), collection);
-		}
-	}
-
-	if (closure->collections_loading == 0) {
-		service_update_collections (self, closure->collections);
-		g_simple_async_result_complete_in_idle (res);
-	}
+	/*
+	 * Each missing collection is loaded along with all of its items, which
+	 * is most of what GetManagedObjects returns, so get them in one go.
+	 */
+	if (service_count_missing_collections (self, paths) > 0)
+		_secret_service_get_managed_objects (self, cancellable, on_ensure_objects,
+		                                     g_object_ref (res));
+	else
+		collections_load_paths (self, paths, res, FALSE);
 
 	g_variant_unref (paths);
 	g_object_unref (res);
@@ -1588,6 +3213,9 @@ secret_service_load_collections_sync (SecretService *self,
 {
 	SecretCollection *collection;
 	GHashTable *collections;
+	GHashTable *objects = NULL;
+	GVariant *properties;
+	GError *lerror = NULL;
 	GVariant *paths;
 	GVariantIter iter;
 	const gchar *path;
@@ -1600,6 +3228,19 @@ secret_service_load_collections_sync (SecretService *self,
 	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
 	g_return_val_if_fail (paths != NULL, FALSE);
 
+	/*
+	 * Each missing collection is loaded along with all of its items, which
+	 * is most of what GetManagedObjects returns, so get them in one go.
+	 */
+	if (service_count_missing_collections (self, paths) > 0) {
+		objects = _secret_service_get_managed_objects_sync (self, cancellable, &lerror);
+		if (lerror != NULL) {
+			g_propagate_error (error, lerror);
+			g_variant_unref (paths);
+			return FALSE;
+		}
+	}
+
 	collections = collections_table_new ();
 
 	g_variant_iter_init (&iter, paths);
@@ -1608,9 +3249,19 @@ secret_service_load_collections_sync (SecretService *self,
 
 		/* No such collection yet create a new one */
 		if (collection == NULL) {
-			collection = secret_collection_new_for_dbus_path_sync (self, path,
-			                                                       SECRET_COLLECTION_LOAD_ITEMS,
-			                                                       cancellable, error);
+			properties = objects ? g_hash_table_lookup (objects, path) : NULL;
+			if (properties != NULL) {
+				collection = _secret_collection_new_for_properties_sync (self, path, properties,
+				                                                         cancellable, error);
+				if (collection != NULL &&
+				    !_secret_collection_load_items_with_objects_sync (collection, objects,
+				                                                      cancellable, error))
+					g_clear_object (&collection);
+			} else {
+				collection = secret_collection_new_for_dbus_path_sync (self, path,
+				                                                       SECRET_COLLECTION_LOAD_ITEMS,
+				                                                       cancellable, error);
+			}
 			if (collection == NULL) {
 				ret = FALSE;
 				break;
@@ -1623,6 +3274,8 @@ secret_service_load_collections_sync (SecretService *self,
 	if (ret)
 		service_update_collections (self, collections);
 
+	if (objects != NULL)
+		g_hash_table_unref (objects);
 	g_hash_table_unref (collections);
 	g_variant_unref (paths);
 	return ret;
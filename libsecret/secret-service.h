@@ -33,6 +33,8 @@ typedef enum {
 	SECRET_SERVICE_NONE = 0,
 	SECRET_SERVICE_OPEN_SESSION = 1 << 1,
 	SECRET_SERVICE_LOAD_COLLECTIONS = 1 << 2,
+	SECRET_SERVICE_SHARED_SIGNALS = 1 << 3,
+	SECRET_SERVICE_FD_TRANSFER = 1 << 4,
 } SecretServiceFlags;
 
 typedef enum {
@@ -42,6 +44,8 @@ typedef enum {
 	SECRET_SEARCH_LOAD_SECRETS = 1 << 3,
 } SecretSearchFlags;
 
+#define SECRET_SERVICE_CALL_HISTOGRAM_SIZE 16
+
 #define SECRET_TYPE_SERVICE            (secret_service_get_type ())
 #define SECRET_SERVICE(inst)           (G_TYPE_CHECK_INSTANCE_CAST ((inst), SECRET_TYPE_SERVICE, SecretService))
 #define SECRET_SERVICE_CLASS(class)    (G_TYPE_CHECK_CLASS_CAST ((class), SECRET_TYPE_SERVICE, SecretServiceClass))
@@ -54,6 +58,12 @@ typedef struct _SecretService        SecretService;
 typedef struct _SecretServiceClass   SecretServiceClass;
 typedef struct _SecretServicePrivate SecretServicePrivate;
 
+typedef void         (* SecretServiceCallFunc)                    (SecretService *self,
+                                                                   const gchar *method,
+                                                                   gint64 elapsed,
+                                                                   gboolean failed,
+                                                                   gpointer user_data);
+
 struct _SecretService {
 	GDBusProxy parent;
 
@@ -128,12 +138,45 @@ SecretService *      secret_service_open_sync                     (GType service
                                                                    GCancellable *cancellable,
                                                                    GError **error);
 
+void                 secret_service_open_for_connection           (GType service_gtype,
+                                                                   GDBusConnection *connection,
+                                                                   const gchar *service_bus_name,
+                                                                   SecretServiceFlags flags,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+SecretService *      secret_service_open_for_connection_sync      (GType service_gtype,
+                                                                   GDBusConnection *connection,
+                                                                   const gchar *service_bus_name,
+                                                                   SecretServiceFlags flags,
+                                                                   GCancellable *cancellable,
+                                                                   GError **error);
+
 SecretServiceFlags   secret_service_get_flags                     (SecretService *self);
 
 const gchar *        secret_service_get_session_algorithms        (SecretService *self);
 
 GList *              secret_service_get_collections               (SecretService *self);
 
+void                 secret_service_set_call_func                 (SecretService *self,
+                                                                   SecretServiceCallFunc func,
+                                                                   gpointer user_data,
+                                                                   GDestroyNotify destroy);
+
+gchar **             secret_service_get_call_methods              (SecretService *self);
+
+guint64              secret_service_get_call_stats                (SecretService *self,
+                                                                   const gchar *method,
+                                                                   guint64 *errors,
+                                                                   gint64 *total_time,
+                                                                   gint64 *max_time,
+                                                                   guint64 *histogram);
+
+void                 secret_service_reset_call_stats              (SecretService *self);
+
+guint                secret_service_get_session_negotiations      (SecretService *self);
+
 void                 secret_service_ensure_session                (SecretService *self,
                                                                    GCancellable *cancellable,
                                                                    GAsyncReadyCallback callback,
@@ -230,6 +273,10 @@ gint                 secret_service_unlock_sync                   (SecretService
                                                                    GList **unlocked,
                                                                    GError **error);
 
+void                 secret_service_begin_unlock_set              (SecretService *service);
+
+void                 secret_service_end_unlock_set                (SecretService *service);
+
 void                 secret_service_store                         (SecretService *service,
                                                                    const SecretSchema *schema,
                                                                    GHashTable *attributes,
@@ -253,6 +300,31 @@ gboolean             secret_service_store_sync                    (SecretService
                                                                    GCancellable *cancellable,
                                                                    GError **error);
 
+void                 secret_service_store_if_changed              (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   const gchar *collection,
+                                                                   const gchar *label,
+                                                                   SecretValue *value,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+gboolean             secret_service_store_if_changed_finish       (SecretService *service,
+                                                                   GAsyncResult *result,
+                                                                   gboolean *written,
+                                                                   GError **error);
+
+gboolean             secret_service_store_if_changed_sync         (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   const gchar *collection,
+                                                                   const gchar *label,
+                                                                   SecretValue *value,
+                                                                   GCancellable *cancellable,
+                                                                   gboolean *written,
+                                                                   GError **error);
+
 void                 secret_service_lookup                        (SecretService *service,
                                                                    const SecretSchema *schema,
                                                                    GHashTable *attributes,
@@ -287,6 +359,25 @@ gboolean             secret_service_clear_sync                    (SecretService
                                                                    GCancellable *cancellable,
                                                                    GError **error);
 
+void                 secret_service_clear_all                     (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   guint window,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+gint                 secret_service_clear_all_finish              (SecretService *service,
+                                                                   GAsyncResult *result,
+                                                                   GError **error);
+
+gint                 secret_service_clear_all_sync                (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   guint window,
+                                                                   GCancellable *cancellable,
+                                                                   GError **error);
+
 void                 secret_service_set_alias                     (SecretService *service,
                                                                    const gchar *alias,
                                                                    SecretCollection *collection,
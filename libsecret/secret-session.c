@@ -28,6 +28,20 @@
 
 #include <glib/gi18n-lib.h>
 
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+#if defined (HAVE_MEMFD_CREATE) && defined (F_ADD_SEALS)
+#define WITH_MEMFD 1
+#define MEMFD_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+#endif
+
 EGG_SECURE_DECLARE (secret_session);
 
 #define ALGORITHMS_AES    "dh-ietf1024-sha256-aes128-cbc-pkcs7"
@@ -65,11 +79,30 @@ _secret_session_free (gpointer data)
 
 #ifdef WITH_GCRYPT
 
+/*
+ * Setting SECRET_SESSION_SHORT_EXPONENT=1 uses private exponents twice the
+ * size of the group's security level, rather than the full size of the prime.
+ * This makes opening a session several times cheaper.
+ */
+static guint
+session_exponent_bits (void)
+{
+	static gsize initialized = 0;
+	static guint bits = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		if (g_strcmp0 (g_getenv ("SECRET_SESSION_SHORT_EXPONENT"), "1") == 0)
+			bits = egg_dh_short_exponent_bits ("ietf-ike-grp-modp-1024");
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return bits;
+}
+
 static GVariant *
 request_open_session_aes (SecretSession *session)
 {
 	gcry_error_t gcry;
-	gcry_mpi_t base;
 	unsigned char *buffer;
 	size_t n_buffer;
 	GVariant *argument;
@@ -82,21 +115,19 @@ request_open_session_aes (SecretSession *session)
 
 	/* Initialize our local parameters and values */
 	if (!egg_dh_default_params ("ietf-ike-grp-modp-1024",
-	                            &session->prime, &base))
+	                            &session->prime, NULL))
 		g_return_val_if_reached (NULL);
 
 #if 0
 	g_printerr ("\n lib prime: ");
 	gcry_mpi_dump (session->prime);
-	g_printerr ("\n  lib base: ");
-	gcry_mpi_dump (base);
 	g_printerr ("\n");
 #endif
 
-	if (!egg_dh_gen_pair (session->prime, base, 0,
-	                      &session->publi, &session->privat))
+	/* Usually pre-generated in the background */
+	if (!egg_dh_pool_take_pair ("ietf-ike-grp-modp-1024", session_exponent_bits (),
+	                            &session->publi, &session->privat))
 		g_return_val_if_reached (NULL);
-	gcry_mpi_release (base);
 
 	gcry = gcry_mpi_aprint (GCRYMPI_FMT_USG, &buffer, &n_buffer, session->publi);
 	g_return_val_if_fail (gcry == 0, NULL);
@@ -208,6 +239,7 @@ response_open_session_plain (SecretSession *session,
 typedef struct {
 	GCancellable *cancellable;
 	SecretSession *session;
+	GVariant *response;
 } OpenSessionClosure;
 
 static void
@@ -217,6 +249,8 @@ open_session_closure_free (gpointer data)
 	g_assert (closure);
 	g_clear_object (&closure->cancellable);
 	_secret_session_free (closure->session);
+	if (closure->response)
+		g_variant_unref (closure->response);
 	g_free (closure);
 }
 
@@ -257,6 +291,47 @@ on_service_open_session_plain (GObject *source,
 
 #ifdef WITH_GCRYPT
 
+/*
+ * The modular exponentiation and key derivation are slow enough on some
+ * devices to be noticeable, so they run in a worker thread, and only the
+ * D-Bus calls happen in the caller's main context.
+ */
+
+static void
+response_aes_thread (GTask *task,
+                     gpointer source_object,
+                     gpointer task_data,
+                     GCancellable *cancellable)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (task_data);
+	OpenSessionClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	g_task_return_boolean (task, response_open_session_aes (closure->session,
+	                                                        closure->response));
+}
+
+static void
+on_response_aes (GObject *source,
+                 GAsyncResult *result,
+                 gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	OpenSessionClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *service = SECRET_SERVICE (source);
+
+	if (g_task_propagate_boolean (G_TASK (result), NULL)) {
+		_secret_service_take_session (service, closure->session);
+		closure->session = NULL;
+
+	} else {
+		g_simple_async_result_set_error (res, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
+		                                 _("Couldn't communicate with the secret storage"));
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
 static void
 on_service_open_session_aes (GObject *source,
                              GAsyncResult *result,
@@ -267,22 +342,17 @@ on_service_open_session_aes (GObject *source,
 	SecretService *service = SECRET_SERVICE (source);
 	GError *error = NULL;
 	GVariant *response;
+	GTask *task;
 
 	response =  g_dbus_proxy_call_finish (G_DBUS_PROXY (service), result, &error);
 
 	/* A successful response, decode it */
 	if (response != NULL) {
-		if (response_open_session_aes (closure->session, response)) {
-			_secret_service_take_session (service, closure->session);
-			closure->session = NULL;
-
-		} else {
-			g_simple_async_result_set_error (res, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
-			                                 _("Couldn't communicate with the secret storage"));
-		}
-
-		g_simple_async_result_complete (res);
-		g_variant_unref (response);
+		closure->response = response;
+		task = g_task_new (service, NULL, on_response_aes, g_object_ref (res));
+		g_task_set_task_data (task, g_object_ref (res), g_object_unref);
+		g_task_run_in_thread (task, response_aes_thread);
+		g_object_unref (task);
 
 	} else {
 		/* AES session not supported, request a plain session */
@@ -304,6 +374,52 @@ on_service_open_session_aes (GObject *source,
 	g_object_unref (res);
 }
 
+static void
+request_aes_thread (GTask *task,
+                    gpointer source_object,
+                    gpointer task_data,
+                    GCancellable *cancellable)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (task_data);
+	OpenSessionClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GVariant *request;
+
+	request = request_open_session_aes (closure->session);
+	if (request == NULL) {
+		g_task_return_new_error (task, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
+		                         _("Couldn't communicate with the secret storage"));
+	} else {
+		g_task_return_pointer (task, g_variant_ref_sink (request),
+		                       (GDestroyNotify)g_variant_unref);
+	}
+}
+
+static void
+on_request_aes (GObject *source,
+                GAsyncResult *result,
+                gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	OpenSessionClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	GVariant *request;
+
+	request = g_task_propagate_pointer (G_TASK (result), &error);
+	if (request == NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else {
+		g_dbus_proxy_call (G_DBUS_PROXY (source), "OpenSession", request,
+		                   G_DBUS_CALL_FLAGS_NONE, -1,
+		                   closure->cancellable, on_service_open_session_aes,
+		                   g_object_ref (res));
+		g_variant_unref (request);
+	}
+
+	g_object_unref (res);
+}
+
 #endif /* WITH_GCRYPT */
 
 
@@ -315,25 +431,29 @@ _secret_session_open (SecretService *service,
 {
 	GSimpleAsyncResult *res;
 	OpenSessionClosure *closure;
+#ifdef WITH_GCRYPT
+	GTask *task;
+#endif
 
 	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
 	                                 _secret_session_open);
-	closure = g_new (OpenSessionClosure, 1);
+	closure = g_new0 (OpenSessionClosure, 1);
 	closure->cancellable = cancellable ? g_object_ref (cancellable) : cancellable;
 	closure->session = g_new0 (SecretSession, 1);
 	g_simple_async_result_set_op_res_gpointer (res, closure, open_session_closure_free);
 
-	g_dbus_proxy_call (G_DBUS_PROXY (service), "OpenSession",
 #ifdef WITH_GCRYPT
-	                   request_open_session_aes (closure->session),
-	                   G_DBUS_CALL_FLAGS_NONE, -1,
-	                   cancellable, on_service_open_session_aes,
+	task = g_task_new (service, cancellable, on_request_aes, g_object_ref (res));
+	g_task_set_task_data (task, g_object_ref (res), g_object_unref);
+	g_task_run_in_thread (task, request_aes_thread);
+	g_object_unref (task);
 #else
+	g_dbus_proxy_call (G_DBUS_PROXY (service), "OpenSession",
 	                   request_open_session_plain (closure->session),
 	                   G_DBUS_CALL_FLAGS_NONE, -1,
 	                   cancellable, on_service_open_session_plain,
-#endif
 	                   g_object_ref (res));
+#endif
 
 	g_object_unref (res);
 }
@@ -652,6 +772,378 @@ _secret_session_encode_secret (SecretSession *session,
 	return result;
 }
 
+gboolean
+_secret_session_can_transfer_fds (void)
+{
+#ifdef WITH_MEMFD
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+#ifdef WITH_MEMFD
+
+static gint
+memfd_new_mapped (gsize length,
+                  guchar **map,
+                  GError **error)
+{
+	int errn;
+	gint fd;
+
+	fd = memfd_create ("libsecret-secret", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0)
+		goto failure;
+
+	*map = NULL;
+	if (length == 0)
+		return fd;
+
+	if (ftruncate (fd, length) < 0)
+		goto failure;
+
+	*map = mmap (NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (*map != MAP_FAILED)
+		return fd;
+
+failure:
+	errn = errno;
+	g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errn),
+	             "Couldn't create memory file for secret: %s", g_strerror (errn));
+	if (fd >= 0)
+		close (fd);
+	return -1;
+}
+
+static gboolean
+memfd_seal_and_append (gint fd,
+                       guchar *map,
+                       gsize length,
+                       GUnixFDList *fds,
+                       gint *handle,
+                       GError **error)
+{
+	int errn;
+
+	/* Sealing for writes fails while the mapping is writable */
+	if (map != NULL)
+		munmap (map, length);
+
+	if (fcntl (fd, F_ADD_SEALS, MEMFD_SEALS) < 0) {
+		errn = errno;
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errn),
+		             "Couldn't seal memory file for secret: %s", g_strerror (errn));
+		close (fd);
+		return FALSE;
+	}
+
+	*handle = g_unix_fd_list_append (fds, fd, error);
+	close (fd);
+	return *handle >= 0;
+}
+
+#ifdef WITH_GCRYPT
+
+static gboolean
+service_encode_aes_secret_fd (SecretSession *session,
+                              SecretValue *value,
+                              GUnixFDList *fds,
+                              GVariantBuilder *builder,
+                              GError **error)
+{
+	gcry_cipher_hd_t cih = NULL;
+	gcry_error_t gcry;
+	guchar *block;
+	guchar *map;
+	gsize n_full, n_pad, n_map;
+	gconstpointer secret;
+	gsize n_secret;
+	gpointer iv;
+	gint handle;
+	gint fd;
+
+	g_variant_builder_add (builder, "o", session->path);
+
+	secret = secret_value_get (value, &n_secret);
+
+	/* Whole blocks are encrypted straight into the file, only the last padded one is copied */
+	n_full = (n_secret / 16) * 16;
+	n_pad = 16 - (n_secret - n_full);
+	n_map = n_full + 16;
+
+	fd = memfd_new_mapped (n_map, &map, error);
+	if (fd < 0)
+		return FALSE;
+
+	iv = g_malloc0 (16);
+	gcry_create_nonce (iv, 16);
+
+	gcry = gcry_cipher_open (&cih, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CBC, 0);
+	if (gcry == 0)
+		gcry = gcry_cipher_setiv (cih, iv, 16);
+	if (gcry == 0)
+		gcry = gcry_cipher_setkey (cih, session->key, session->n_key);
+	if (gcry == 0 && n_full > 0)
+		gcry = gcry_cipher_encrypt (cih, map, n_full, secret, n_full);
+	if (gcry == 0) {
+		block = egg_secure_alloc (16);
+		memcpy (block, (const guchar *)secret + n_full, 16 - n_pad);
+		memset (block + (16 - n_pad), n_pad, n_pad);
+		gcry = gcry_cipher_encrypt (cih, map + n_full, 16, block, 16);
+		egg_secure_free (block);
+	}
+
+	gcry_cipher_close (cih);
+
+	if (gcry != 0) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+		             "Couldn't encrypt secret: %s", gcry_strerror (gcry));
+		munmap (map, n_map);
+		close (fd);
+		g_free (iv);
+		return FALSE;
+	}
+
+	if (!memfd_seal_and_append (fd, map, n_map, fds, &handle, error)) {
+		g_free (iv);
+		return FALSE;
+	}
+
+	g_variant_builder_add_value (builder, g_variant_new_from_data (G_VARIANT_TYPE ("ay"),
+	                                                               iv, 16, TRUE, g_free, iv));
+	g_variant_builder_add (builder, "h", handle);
+	g_variant_builder_add (builder, "s", secret_value_get_content_type (value));
+	return TRUE;
+}
+
+static SecretValue *
+service_decode_aes_secret_fd (SecretSession *session,
+                              gconstpointer param,
+                              gsize n_param,
+                              const guchar *map,
+                              gsize n_map,
+                              const gchar *content_type)
+{
+	gcry_cipher_hd_t cih;
+	gcry_error_t gcry;
+	guchar *padded;
+	gsize n_padded;
+
+	if (n_param != 16) {
+		g_message ("received an encrypted secret structure with invalid parameter");
+		return NULL;
+	}
+
+	if (n_map == 0 || n_map % 16 != 0) {
+		g_message ("received an encrypted secret structure with bad secret length");
+		return NULL;
+	}
+
+	gcry = gcry_cipher_open (&cih, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CBC, 0);
+	if (gcry != 0) {
+		g_warning ("couldn't create AES cipher: %s", gcry_strerror (gcry));
+		return NULL;
+	}
+
+	/* Decrypt straight from the mapped file into secure memory */
+	n_padded = n_map;
+	padded = egg_secure_alloc (n_padded);
+
+	gcry = gcry_cipher_setiv (cih, param, n_param);
+	if (gcry == 0)
+		gcry = gcry_cipher_setkey (cih, session->key, session->n_key);
+	if (gcry == 0)
+		gcry = gcry_cipher_decrypt (cih, padded, n_padded, map, n_map);
+
+	gcry_cipher_close (cih);
+
+	if (gcry != 0) {
+		egg_secure_clear (padded, n_padded);
+		egg_secure_free (padded);
+		g_warning ("couldn't decrypt secret: %s", gcry_strerror (gcry));
+		return NULL;
+	}
+
+	if (!pkcs7_unpad_bytes_in_place (padded, &n_padded)) {
+		egg_secure_clear (padded, n_padded);
+		egg_secure_free (padded);
+		g_message ("received an invalid or unencryptable secret");
+		return NULL;
+	}
+
+	return secret_value_new_full ((gchar *)padded, n_padded, content_type, egg_secure_free);
+}
+
+#endif /* WITH_GCRYPT */
+
+static gboolean
+service_encode_plain_secret_fd (SecretSession *session,
+                                SecretValue *value,
+                                GUnixFDList *fds,
+                                GVariantBuilder *builder,
+                                GError **error)
+{
+	gconstpointer secret;
+	gsize n_secret;
+	guchar *map;
+	gint handle;
+	gint fd;
+
+	g_variant_builder_add (builder, "o", session->path);
+
+	secret = secret_value_get (value, &n_secret);
+
+	fd = memfd_new_mapped (n_secret, &map, error);
+	if (fd < 0)
+		return FALSE;
+	if (n_secret > 0)
+		memcpy (map, secret, n_secret);
+	if (!memfd_seal_and_append (fd, map, n_secret, fds, &handle, error))
+		return FALSE;
+
+	g_variant_builder_add_value (builder, g_variant_new_from_data (G_VARIANT_TYPE ("ay"),
+	                                                               "", 0, TRUE, NULL, NULL));
+	g_variant_builder_add (builder, "h", handle);
+	g_variant_builder_add (builder, "s", secret_value_get_content_type (value));
+	return TRUE;
+}
+
+#endif /* WITH_MEMFD */
+
+/*
+ * Like _secret_session_encode_secret() but returns a (oayhs) structure,
+ * where the handle refers to a sealed memory file in @fds which holds
+ * the encoded secret.
+ */
+GVariant *
+_secret_session_encode_secret_fd (SecretSession *session,
+                                  SecretValue *value,
+                                  GUnixFDList *fds,
+                                  GError **error)
+{
+#ifdef WITH_MEMFD
+	GVariantBuilder builder;
+	gboolean ret;
+
+	g_return_val_if_fail (session != NULL, NULL);
+	g_return_val_if_fail (value != NULL, NULL);
+	g_return_val_if_fail (G_IS_UNIX_FD_LIST (fds), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("(oayhs)"));
+
+#ifdef WITH_GCRYPT
+	if (session->key)
+		ret = service_encode_aes_secret_fd (session, value, fds, &builder, error);
+	else
+#endif
+		ret = service_encode_plain_secret_fd (session, value, fds, &builder, error);
+
+	if (ret)
+		return g_variant_builder_end (&builder);
+
+	g_variant_builder_clear (&builder);
+	return NULL;
+#else
+	g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+	                     "Passing secrets in memory files is not supported");
+	return NULL;
+#endif
+}
+
+/*
+ * Decode a (oayhs) structure as sent by _secret_session_encode_secret_fd().
+ * The memory file must be sealed, so that it can't change while we read it.
+ */
+SecretValue *
+_secret_session_decode_secret_fd (SecretSession *session,
+                                  GVariant *encoded,
+                                  GUnixFDList *fds)
+{
+#ifdef WITH_MEMFD
+	SecretValue *result = NULL;
+	gconstpointer param;
+	gchar *session_path;
+	gchar *content_type;
+	struct stat sb;
+	GVariant *vparam;
+	guchar *map = NULL;
+	gsize n_param;
+	gint handle;
+	gint seals;
+	gint fd;
+
+	g_return_val_if_fail (session != NULL, NULL);
+	g_return_val_if_fail (encoded != NULL, NULL);
+
+	g_variant_get_child (encoded, 0, "o", &session_path);
+	if (session_path == NULL || !g_str_equal (session_path, session->path)) {
+		g_message ("received a secret encoded with wrong session: %s != %s",
+		           session_path, session->path);
+		g_free (session_path);
+		return NULL;
+	}
+
+	g_variant_get_child (encoded, 2, "h", &handle);
+	if (fds == NULL || handle < 0 || handle >= g_unix_fd_list_get_length (fds)) {
+		g_message ("received a secret without a valid memory file");
+		g_free (session_path);
+		return NULL;
+	}
+
+	fd = g_unix_fd_list_get (fds, handle, NULL);
+	if (fd < 0) {
+		g_free (session_path);
+		return NULL;
+	}
+
+	seals = fcntl (fd, F_GET_SEALS);
+	if (seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) != (F_SEAL_SHRINK | F_SEAL_WRITE) ||
+	    fstat (fd, &sb) < 0) {
+		g_message ("received a secret in a memory file that isn't sealed");
+		g_free (session_path);
+		close (fd);
+		return NULL;
+	}
+
+	if (sb.st_size > 0) {
+		map = mmap (NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			g_message ("couldn't map memory file with secret: %s", g_strerror (errno));
+			g_free (session_path);
+			close (fd);
+			return NULL;
+		}
+	}
+
+	vparam = g_variant_get_child_value (encoded, 1);
+	param = g_variant_get_fixed_array (vparam, &n_param, sizeof (guchar));
+	g_variant_get_child (encoded, 3, "s", &content_type);
+
+#ifdef WITH_GCRYPT
+	if (session->key != NULL)
+		result = service_decode_aes_secret_fd (session, param, n_param,
+		                                       map, sb.st_size, content_type);
+	else
+#endif
+	if (n_param != 0)
+		g_message ("received a plain secret structure with invalid parameter");
+	else
+		result = secret_value_new ((const gchar *)map, sb.st_size, content_type);
+
+	if (map != NULL)
+		munmap (map, sb.st_size);
+	close (fd);
+
+	g_variant_unref (vparam);
+	g_free (content_type);
+	g_free (session_path);
+	return result;
+#else
+	return NULL;
+#endif
+}
+
 const gchar *
 _secret_session_get_algorithms (SecretSession *session)
 {
@@ -279,6 +279,45 @@ _secret_util_get_properties_finish (GDBusProxy *proxy,
 	return TRUE;
 }
 
+/*
+ * Proxies that share the service's signal subscription are created with
+ * G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES, so that they add no match rule
+ * of their own. They still need their properties loaded when initialized.
+ */
+gboolean
+_secret_util_want_properties (GDBusProxy *proxy)
+{
+	return (g_dbus_proxy_get_flags (proxy) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES) &&
+	       !_secret_util_have_cached_properties (proxy);
+}
+
+gboolean
+_secret_util_get_properties_sync (GDBusProxy *proxy,
+                                  GCancellable *cancellable,
+                                  GError **error)
+{
+	GVariant *retval;
+
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (proxy),
+	                                      g_dbus_proxy_get_name (proxy),
+	                                      g_dbus_proxy_get_object_path (proxy),
+	                                      "org.freedesktop.DBus.Properties", "GetAll",
+	                                      g_variant_new ("(s)", g_dbus_proxy_get_interface_name (proxy)),
+	                                      G_VARIANT_TYPE ("(a{sv})"),
+	                                      G_DBUS_CALL_FLAGS_NONE, -1,
+	                                      cancellable, error);
+
+	if (retval == NULL)
+		return FALSE;
+
+	process_get_all_reply (proxy, retval);
+	g_variant_unref (retval);
+	return TRUE;
+}
+
 typedef struct {
 	gchar *property;
 	GVariant *value;
@@ -430,15 +469,51 @@ _secret_util_have_cached_properties (GDBusProxy *proxy)
 	return names != NULL;
 }
 
+typedef struct {
+	GMainContext *context;
+	GMainLoop *loop;
+	gboolean in_use;
+} SyncCache;
+
+static void
+sync_cache_free (gpointer data)
+{
+	SyncCache *cache = data;
+
+	g_main_loop_unref (cache->loop);
+	g_main_context_unref (cache->context);
+	g_slice_free (SyncCache, cache);
+}
+
+/* One main context per thread, reused by all non-nested sync calls */
+static GPrivate sync_cache = G_PRIVATE_INIT (sync_cache_free);
+
 SecretSync *
 _secret_sync_new (void)
 {
 	SecretSync *sync;
+	SyncCache *cache;
 
 	sync = g_new0 (SecretSync, 1);
 
-	sync->context = g_main_context_new ();
-	sync->loop = g_main_loop_new (sync->context, FALSE);
+	cache = g_private_get (&sync_cache);
+	if (cache == NULL) {
+		cache = g_slice_new0 (SyncCache);
+		cache->context = g_main_context_new ();
+		cache->loop = g_main_loop_new (cache->context, FALSE);
+		g_private_set (&sync_cache, cache);
+	}
+
+	/* A sync call made while another is running on this thread gets its own */
+	if (cache->in_use) {
+		sync->context = g_main_context_new ();
+		sync->loop = g_main_loop_new (sync->context, FALSE);
+	} else {
+		cache->in_use = TRUE;
+		sync->cached = TRUE;
+		sync->context = g_main_context_ref (cache->context);
+		sync->loop = g_main_loop_ref (cache->loop);
+	}
 
 	return sync;
 }
@@ -447,12 +522,21 @@ void
 _secret_sync_free (gpointer data)
 {
 	SecretSync *sync = data;
+	SyncCache *cache;
 
+	/* Nothing from this call may be left to run during the next one */
 	while (g_main_context_iteration (sync->context, FALSE));
 
+	if (sync->cached) {
+		cache = g_private_get (&sync_cache);
+		g_assert (cache != NULL && cache->context == sync->context);
+		cache->in_use = FALSE;
+	}
+
 	g_clear_object (&sync->result);
 	g_main_loop_unref (sync->loop);
 	g_main_context_unref (sync->context);
+	g_free (sync);
 }
 
 void
@@ -319,3 +319,31 @@ _secret_value_unref_to_string (SecretValue *value)
 
 	return result;
 }
+
+gboolean
+_secret_value_equal (SecretValue *one,
+                     SecretValue *two)
+{
+	const guchar *a;
+	const guchar *b;
+	guchar diff = 0;
+	gsize i;
+
+	g_return_val_if_fail (one != NULL, FALSE);
+	g_return_val_if_fail (two != NULL, FALSE);
+
+	if (one == two)
+		return TRUE;
+	if (one->length != two->length)
+		return FALSE;
+	if (g_strcmp0 (one->content_type, two->content_type) != 0)
+		return FALSE;
+
+	/* Look at every byte, so the time taken says nothing of the contents */
+	a = one->secret;
+	b = two->secret;
+	for (i = 0; i < one->length; i++)
+		diff |= a[i] ^ b[i];
+
+	return diff == 0;
+}
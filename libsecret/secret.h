@@ -23,6 +23,7 @@
 #include <libsecret/secret-collection.h>
 #include <libsecret/secret-enum-types.h>
 #include <libsecret/secret-item.h>
+#include <libsecret/secret-item-info.h>
 #include <libsecret/secret-password.h>
 #include <libsecret/secret-prompt.h>
 #include <libsecret/secret-schema.h>
@@ -188,6 +188,135 @@ test_validate_libgnomekeyring (void)
 	g_hash_table_unref (attributes);
 }
 
+static void
+test_sorted_for_table (void)
+{
+	SecretAttributes *attrs;
+	GHashTable *attributes;
+	GVariant *variant;
+	gchar *printed;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_replace (attributes, "string", "four");
+	g_hash_table_replace (attributes, "xdg:schema", "org.other.Schema");
+	g_hash_table_replace (attributes, "even", "true");
+	g_hash_table_replace (attributes, "number", "4");
+
+	/* The schema name replaces any xdg:schema attribute */
+	attrs = _secret_attributes_new_for_table (attributes, "org.mock.Schema");
+	g_assert_cmpuint (_secret_attributes_get_length (attrs), ==, 4);
+	g_assert_cmpstr (_secret_attributes_lookup (attrs, "even"), ==, "true");
+	g_assert_cmpstr (_secret_attributes_lookup (attrs, "number"), ==, "4");
+	g_assert_cmpstr (_secret_attributes_lookup (attrs, "string"), ==, "four");
+	g_assert_cmpstr (_secret_attributes_lookup (attrs, "xdg:schema"), ==, "org.mock.Schema");
+	g_assert (_secret_attributes_lookup (attrs, "missing") == NULL);
+
+	variant = _secret_attributes_get_variant (attrs);
+	printed = g_variant_print (variant, FALSE);
+	g_assert_cmpstr (printed, ==, "{'even': 'true', 'number': '4', 'string': 'four', "
+	                              "'xdg:schema': 'org.mock.Schema'}");
+	g_variant_unref (g_variant_ref_sink (variant));
+	g_free (printed);
+
+	_secret_attributes_unref (attrs);
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_sorted_for_variant (void)
+{
+	SecretAttributes *attrs;
+	SecretAttributes *copy;
+	GHashTable *attributes;
+	GVariant *variant;
+
+	/* When a name is repeated, the last value wins */
+	variant = g_variant_new_parsed ("{'string': 'one', 'number': '1', 'string': 'two'}");
+	g_variant_ref_sink (variant);
+	attrs = _secret_attributes_new_for_variant (variant);
+	g_variant_unref (variant);
+
+	g_assert_cmpuint (_secret_attributes_get_length (attrs), ==, 2);
+	g_assert_cmpstr (_secret_attributes_lookup (attrs, "string"), ==, "two");
+
+	attributes = _secret_attributes_to_table (attrs);
+	g_assert_cmpuint (g_hash_table_size (attributes), ==, 2);
+	g_assert_cmpstr (g_hash_table_lookup (attributes, "number"), ==, "1");
+	g_assert_cmpstr (g_hash_table_lookup (attributes, "string"), ==, "two");
+
+	copy = g_boxed_copy (_secret_attributes_get_type (), attrs);
+	g_assert (copy == attrs);
+	g_boxed_free (_secret_attributes_get_type (), copy);
+
+	g_hash_table_unref (attributes);
+	_secret_attributes_unref (attrs);
+}
+
+static void
+test_sorted_equal (void)
+{
+	SecretAttributes *one, *two, *three;
+	GHashTable *attributes;
+	GVariant *variant;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_replace (attributes, "number", "1");
+	g_hash_table_replace (attributes, "string", "one");
+	one = _secret_attributes_new_for_table (attributes, NULL);
+
+	variant = g_variant_new_parsed ("{'string': 'one', 'number': '1'}");
+	g_variant_ref_sink (variant);
+	two = _secret_attributes_new_for_variant (variant);
+	g_variant_unref (variant);
+
+	g_hash_table_replace (attributes, "string", "two");
+	three = _secret_attributes_new_for_table (attributes, NULL);
+
+	g_assert (_secret_attributes_equal (one, two));
+	g_assert_cmpuint (_secret_attributes_hash (one), ==, _secret_attributes_hash (two));
+	g_assert (!_secret_attributes_equal (one, three));
+	g_assert (!_secret_attributes_equal (one, NULL));
+
+	_secret_attributes_unref (one);
+	_secret_attributes_unref (two);
+	_secret_attributes_unref (three);
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_sorted_shared (void)
+{
+	SecretAttributes *one, *two;
+	GHashTable *attributes;
+	GVariant *variant;
+	gpointer name;
+
+	variant = g_variant_new_parsed ("{'xdg:schema': 'org.mock.Schema', 'user': 'one'}");
+	one = _secret_attributes_new_for_variant (g_variant_ref_sink (variant));
+	g_variant_unref (variant);
+
+	variant = g_variant_new_parsed ("{'xdg:schema': 'org.mock.Schema', 'user': 'two'}");
+	two = _secret_attributes_new_for_variant (g_variant_ref_sink (variant));
+	g_variant_unref (variant);
+
+	/* Names and schema names are shared, other values are not */
+	g_assert (_secret_attributes_lookup (one, "xdg:schema") == _secret_attributes_lookup (two, "xdg:schema"));
+	g_assert (_secret_attributes_lookup (one, "user") != _secret_attributes_lookup (two, "user"));
+
+	/* The table belongs to the caller, who may replace its keys */
+	attributes = _secret_attributes_to_table (one);
+	g_assert (g_hash_table_lookup_extended (attributes, "user", &name, NULL));
+	g_hash_table_replace (attributes, g_strdup ("user"), g_strdup ("other"));
+	g_assert_cmpstr (g_hash_table_lookup (attributes, "user"), ==, "other");
+	g_hash_table_unref (attributes);
+
+	/* Still valid while the other set uses them */
+	_secret_attributes_unref (one);
+	g_assert_cmpstr (_secret_attributes_lookup (two, "xdg:schema"), ==, "org.mock.Schema");
+	g_assert_cmpstr (_secret_attributes_lookup (two, "user"), ==, "two");
+	_secret_attributes_unref (two);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -207,5 +336,10 @@ main (int argc, char **argv)
 	g_test_add_func ("/attributes/validate-schema-bad", test_validate_schema_bad);
 	g_test_add_func ("/attributes/validate-libgnomekeyring", test_validate_libgnomekeyring);
 
+	g_test_add_func ("/attributes/sorted-for-table", test_sorted_for_table);
+	g_test_add_func ("/attributes/sorted-for-variant", test_sorted_for_variant);
+	g_test_add_func ("/attributes/sorted-equal", test_sorted_equal);
+	g_test_add_func ("/attributes/sorted-shared", test_sorted_shared);
+
 	return g_test_run ();
 }
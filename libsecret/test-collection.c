@@ -29,6 +29,10 @@
 #include <errno.h>
 #include <stdlib.h>
 
+#ifdef HAVE_MALLINFO
+#include <malloc.h>
+#endif
+
 typedef struct {
 	SecretService *service;
 } Test;
@@ -383,6 +387,80 @@ test_properties (Test *test,
 	g_object_unref (collection);
 }
 
+static void
+test_managed_properties (Test *test,
+                         gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection = NULL;
+	SecretCollection *other;
+	SecretService *service;
+	GError *error = NULL;
+	SecretItem *item;
+	SecretItem *changer;
+	GList *collections, *l;
+	gboolean ret;
+	gchar *label;
+	guint sigs;
+
+	/* Collections and their items are all seeded from GetManagedObjects */
+	service = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_LOAD_COLLECTIONS,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+
+	collections = secret_service_get_collections (service);
+	for (l = collections; l != NULL; l = g_list_next (l)) {
+		if (g_str_equal (g_dbus_proxy_get_object_path (l->data), collection_path))
+			collection = g_object_ref (l->data);
+	}
+	g_list_free_full (collections, g_object_unref);
+
+	g_assert (collection != NULL);
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (collection)) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+	g_assert (!(g_dbus_proxy_get_flags (G_DBUS_PROXY (collection)) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS));
+
+	item = _secret_collection_find_item_instance (collection, collection_path "/1");
+	g_assert (item != NULL);
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (item)) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+
+	/* Change the labels through different, unrelated proxies */
+	other = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                  SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	sigs = 1;
+	g_signal_connect (collection, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	ret = secret_collection_set_label_sync (other, "Changed collection", NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	egg_test_wait ();
+
+	label = secret_collection_get_label (collection);
+	g_assert_cmpstr (label, ==, "Changed collection");
+	g_free (label);
+
+	changer = secret_item_new_for_dbus_path_sync (test->service, collection_path "/1",
+	                                              SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	sigs = 1;
+	g_signal_connect (item, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	ret = secret_item_set_label_sync (changer, "Changed item", NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	egg_test_wait ();
+
+	label = secret_item_get_label (item);
+	g_assert_cmpstr (label, ==, "Changed item");
+	g_free (label);
+
+	g_object_unref (changer);
+	g_object_unref (other);
+	g_object_unref (item);
+	g_object_unref (collection);
+	g_object_unref (service);
+}
+
 static void
 check_items_equal (GList *items,
                    ...)
@@ -444,6 +522,109 @@ test_items (Test *test,
 	g_object_unref (collection);
 }
 
+static void
+test_items_few (Test *test,
+                gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection;
+	GError *error = NULL;
+	gboolean ret;
+	GList *items;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	secret_service_reset_call_stats (test->service);
+
+	ret = secret_collection_load_items_sync (collection, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Only a few items, so no need to fetch the whole service */
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "GetManagedObjects",
+	                                                 NULL, NULL, NULL, NULL), ==, 0);
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "GetAll",
+	                                                 NULL, NULL, NULL, NULL), ==, 3);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/english/1",
+	                   "/org/freedesktop/secrets/collection/english/2",
+	                   "/org/freedesktop/secrets/collection/english/3",
+	                   NULL);
+	g_list_free_full (items, g_object_unref);
+
+	g_object_unref (collection);
+}
+
+static void
+test_items_signals (Test *test,
+                    gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection;
+	SecretItem *before, *after;
+	GHashTable *attributes;
+	SecretValue *value;
+	GError *error = NULL;
+	SecretItem *item;
+	GList *items;
+	guint sigs;
+	gboolean ret;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+	g_signal_connect (collection, "notify::items", G_CALLBACK (on_notify_stop), &sigs);
+
+	before = _secret_collection_find_item_instance (collection, collection_path "/1");
+	g_assert (before != NULL);
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "even", "true");
+	g_hash_table_insert (attributes, "string", "ten");
+	g_hash_table_insert (attributes, "number", "10");
+	value = secret_value_new ("Hoohah", -1, "text/plain");
+
+	/* The ItemCreated signal adds just the new item */
+	sigs = 1;
+	item = secret_item_create_sync (collection, &MOCK_SCHEMA, attributes, "Tunnel",
+	                                value, SECRET_ITEM_CREATE_NONE, NULL, &error);
+	g_assert_no_error (error);
+	egg_test_wait ();
+
+	items = secret_collection_get_items (collection);
+	g_assert_cmpuint (g_list_length (items), ==, 4);
+	g_assert (g_list_find (items, item) != NULL);
+	g_list_free_full (items, g_object_unref);
+
+	/* And the ItemDeleted signal removes just that one */
+	sigs = 1;
+	ret = secret_item_delete_sync (item, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	egg_test_wait ();
+
+	items = secret_collection_get_items (collection);
+	g_assert_cmpuint (g_list_length (items), ==, 3);
+	g_assert (g_list_find (items, item) == NULL);
+	g_list_free_full (items, g_object_unref);
+
+	/* Existing items were left untouched */
+	after = _secret_collection_find_item_instance (collection, collection_path "/1");
+	g_assert (after == before);
+
+	g_signal_handlers_disconnect_by_func (collection, on_notify_stop, &sigs);
+	g_hash_table_unref (attributes);
+	secret_value_unref (value);
+	g_object_unref (before);
+	g_object_unref (after);
+	g_object_unref (item);
+	g_object_unref (collection);
+}
+
 static void
 test_items_empty (Test *test,
                   gconstpointer unused)
@@ -500,6 +681,238 @@ test_items_empty_async (Test *test,
 	g_object_unref (collection);
 }
 
+static void
+test_item_infos_sync (Test *test,
+                      gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/2";
+	SecretCollection *collection;
+	const SecretItemInfo *info;
+	SecretItemInfoList *list;
+	GHashTable *attributes;
+	GError *error = NULL;
+	gboolean found = FALSE;
+	guint i;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	secret_service_reset_call_stats (test->service);
+
+	list = secret_collection_load_item_infos_sync (collection, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (list != NULL);
+	g_assert_cmpuint (secret_item_info_list_get_length (list), ==, 3);
+
+	/* All from one ObjectManager call */
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "GetManagedObjects",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "GetAll",
+	                                                 NULL, NULL, NULL, NULL), ==, 0);
+
+	for (i = 0; i < secret_item_info_list_get_length (list); i++) {
+		info = secret_item_info_list_get (list, i);
+		if (!g_str_equal (secret_item_info_get_path (info), item_path))
+			continue;
+
+		found = TRUE;
+		g_assert_cmpstr (secret_item_info_get_label (info), ==, "Item Two");
+		g_assert_cmpstr (secret_item_info_get_attribute (info, "string"), ==, "two");
+		g_assert_cmpstr (secret_item_info_get_attribute (info, "missing"), ==, NULL);
+		g_assert_cmpstr (secret_item_info_get_schema_name (info), ==, "org.mock.Schema");
+		g_assert (secret_item_info_get_locked (info) == FALSE);
+
+		attributes = secret_item_info_get_attributes (info);
+		g_assert_cmpuint (g_hash_table_size (attributes), ==, 4);
+		g_assert_cmpstr (g_hash_table_lookup (attributes, "even"), ==, "true");
+		g_hash_table_unref (attributes);
+	}
+
+	g_assert (found);
+
+	/* No item proxies should have been created */
+	g_assert (secret_collection_get_items (collection) == NULL);
+
+	secret_item_info_list_unref (list);
+	g_object_unref (collection);
+}
+
+static void
+test_item_infos_fallback (Test *test,
+                          gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection;
+	SecretItemInfoList *list;
+	GError *error = NULL;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	secret_service_reset_call_stats (test->service);
+
+	list = secret_collection_load_item_infos_sync (collection, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (list != NULL);
+	g_assert_cmpuint (secret_item_info_list_get_length (list), ==, 3);
+
+	/* No ObjectManager, so each item by itself */
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "GetAll",
+	                                                 NULL, NULL, NULL, NULL), ==, 3);
+
+	secret_item_info_list_unref (list);
+	g_object_unref (collection);
+}
+
+static void
+test_item_infos_async (Test *test,
+                       gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/empty";
+	SecretCollection *collection;
+	GAsyncResult *result = NULL;
+	SecretItemInfoList *list;
+	GError *error = NULL;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	secret_collection_load_item_infos (collection, NULL, on_async_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	list = secret_collection_load_item_infos_finish (collection, result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	g_assert (list != NULL);
+	g_assert_cmpuint (secret_item_info_list_get_length (list), ==, 0);
+
+	secret_item_info_list_unref (list);
+	g_object_unref (collection);
+}
+
+static void
+setup_bulk_perf (Test *test,
+                 gconstpointer data)
+{
+	g_setenv ("MOCK_BULK_ITEMS", "10000", TRUE);
+	setup (test, data);
+	g_unsetenv ("MOCK_BULK_ITEMS");
+}
+
+#ifdef HAVE_MALLINFO
+
+static gsize
+allocated_bytes (void)
+{
+	struct mallinfo info = mallinfo ();
+	return (gsize)info.uordblks + (gsize)info.hblkhd;
+}
+
+static GDBusProxy *
+plain_item_proxy (SecretService *service,
+                  const gchar *item_path,
+                  GVariant *properties)
+{
+	GDBusProxy *proxy;
+	GError *error = NULL;
+	GVariantIter iter;
+	const gchar *name;
+	GVariant *value;
+
+	proxy = g_dbus_proxy_new_sync (g_dbus_proxy_get_connection (G_DBUS_PROXY (service)),
+	                               _secret_service_get_proxy_flags (service) |
+	                               G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+	                               NULL, g_dbus_proxy_get_name (G_DBUS_PROXY (service)),
+	                               item_path, SECRET_ITEM_INTERFACE, NULL, &error);
+	g_assert_no_error (error);
+
+	g_variant_iter_init (&iter, properties);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+		g_dbus_proxy_set_cached_property (proxy, name, value);
+		g_variant_unref (value);
+	}
+
+	return proxy;
+}
+
+#endif /* HAVE_MALLINFO */
+
+static void
+test_perf_items_memory (Test *test,
+                        gconstpointer unused)
+{
+#ifdef HAVE_MALLINFO
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/bulk";
+	SecretCollection *collection;
+	GVariant *properties;
+	GError *error = NULL;
+	GHashTable *objects;
+	GPtrArray *proxies;
+	const gchar *path;
+	GVariantIter iter;
+	GVariant *paths;
+	GList *loaded;
+	gboolean ret;
+	gsize before;
+	gsize items;
+	gsize plain;
+	guint count;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	/*
+	 * What each loaded item used to amount to: a proxy with all of its
+	 * properties cached as they came from the service, attributes included.
+	 */
+	before = allocated_bytes ();
+	proxies = g_ptr_array_new_with_free_func (g_object_unref);
+	objects = _secret_service_get_managed_objects_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (objects != NULL);
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (collection), "Items");
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_next (&iter, "&o", &path)) {
+		properties = g_hash_table_lookup (objects, path);
+		g_assert (properties != NULL);
+		g_ptr_array_add (proxies, plain_item_proxy (test->service, path, properties));
+	}
+	g_variant_unref (paths);
+	g_hash_table_unref (objects);
+	plain = allocated_bytes () - before;
+	count = proxies->len;
+
+	/* The same items loaded as SecretItem proxies */
+	before = allocated_bytes ();
+	ret = secret_collection_load_items_sync (collection, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	items = allocated_bytes () - before;
+
+	loaded = secret_collection_get_items (collection);
+	g_assert_cmpuint (g_list_length (loaded), ==, count);
+	g_list_free_full (loaded, g_object_unref);
+
+	g_test_minimized_result ((gdouble)items / count, "loaded items: %.1f bytes each",
+	                         (gdouble)items / count);
+	g_test_message ("plain proxies: %.1f bytes each", (gdouble)plain / count);
+	g_assert_cmpuint (items, <, plain);
+
+	g_ptr_array_unref (proxies);
+	g_object_unref (collection);
+#else
+	g_test_skip ("mallinfo() is not available to measure memory use");
+#endif
+}
+
 static void
 test_set_label_sync (Test *test,
                      gconstpointer unused)
@@ -1007,7 +1420,13 @@ main (int argc, char **argv)
 	g_test_add ("/collection/create-sync", Test, "mock-service-normal.py", setup, test_create_sync, teardown);
 	g_test_add ("/collection/create-async", Test, "mock-service-normal.py", setup, test_create_async, teardown);
 	g_test_add ("/collection/properties", Test, "mock-service-normal.py", setup, test_properties, teardown);
+	g_test_add ("/collection/managed-properties", Test, "mock-service-normal.py", setup, test_managed_properties, teardown);
 	g_test_add ("/collection/items", Test, "mock-service-normal.py", setup, test_items, teardown);
+	g_test_add ("/collection/items-few", Test, "mock-service-normal.py", setup, test_items_few, teardown);
+	g_test_add ("/collection/items-signals", Test, "mock-service-normal.py", setup, test_items_signals, teardown);
+	g_test_add ("/collection/item-infos-sync", Test, "mock-service-normal.py", setup, test_item_infos_sync, teardown);
+	g_test_add ("/collection/item-infos-async", Test, "mock-service-normal.py", setup, test_item_infos_async, teardown);
+	g_test_add ("/collection/item-infos-fallback", Test, "mock-service-no-object-manager.py", setup, test_item_infos_fallback, teardown);
 	g_test_add ("/collection/items-empty", Test, "mock-service-normal.py", setup, test_items_empty, teardown);
 	g_test_add ("/collection/items-empty-async", Test, "mock-service-normal.py", setup, test_items_empty_async, teardown);
 	g_test_add ("/collection/set-label-sync", Test, "mock-service-normal.py", setup, test_set_label_sync, teardown);
@@ -1025,5 +1444,8 @@ main (int argc, char **argv)
 	g_test_add ("/collection/search-secrets-sync", Test, "mock-service-normal.py", setup, test_search_secrets_sync, teardown);
 	g_test_add ("/collection/search-secrets-async", Test, "mock-service-normal.py", setup, test_search_secrets_async, teardown);
 
+	if (g_test_perf ())
+		g_test_add ("/collection/perf/items-memory", Test, "mock-service-bulk.py", setup_bulk_perf, test_perf_items_memory, teardown);
+
 	return egg_tests_run_with_loop ();
 }
@@ -270,6 +270,9 @@ test_properties (Test *test,
 	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
 	g_assert_no_error (error);
 
+	/* Only the parsed attributes are kept */
+	g_assert (g_dbus_proxy_get_cached_property (G_DBUS_PROXY (item), "Attributes") == NULL);
+
 	g_assert (secret_item_get_locked (item) == FALSE);
 	g_assert_cmpuint (secret_item_get_created (item), <=, time (NULL));
 	g_assert_cmpuint (secret_item_get_modified (item), <=, time (NULL));
@@ -341,6 +344,103 @@ test_set_label_sync (Test *test,
 	g_object_unref (item);
 }
 
+static gint add_matches = 0;
+
+static GDBusMessage *
+on_filter_add_match (GDBusConnection *connection,
+                     GDBusMessage *message,
+                     gboolean incoming,
+                     gpointer user_data)
+{
+	if (!incoming &&
+	    g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_METHOD_CALL &&
+	    g_strcmp0 (g_dbus_message_get_member (message), "AddMatch") == 0)
+		g_atomic_int_inc (&add_matches);
+
+	return message;
+}
+
+static void
+on_properties_changed_count (GDBusProxy *proxy,
+                             GVariant *changed_properties,
+                             const gchar* const *invalidated_properties,
+                             gpointer user_data)
+{
+	guint *count = user_data;
+	(*count)++;
+}
+
+static void
+test_shared_signals (Test *test,
+                     gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GDBusConnection *connection;
+	SecretService *service;
+	GError *error = NULL;
+	SecretItem *shared;
+	SecretItem *other;
+	SecretItem *item;
+	guint changes = 0;
+	guint sigs = 1;
+	gboolean ret;
+	gchar *label;
+	guint filter;
+
+	service = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_SHARED_SIGNALS,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_assert (secret_service_get_flags (service) & SECRET_SERVICE_SHARED_SIGNALS);
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (service));
+	g_atomic_int_set (&add_matches, 0);
+	filter = g_dbus_connection_add_filter (connection, on_filter_add_match, NULL, NULL);
+
+	/* Proxies sharing the service's rule add none of their own */
+	shared = secret_item_new_for_dbus_path_sync (service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (shared)) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS);
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (shared)) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+
+	other = secret_item_new_for_dbus_path_sync (service, "/org/freedesktop/secrets/collection/english/2",
+	                                            SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	label = secret_item_get_label (shared);
+	g_assert_cmpstr (label, ==, "Item One");
+	g_free (label);
+
+	g_assert_cmpint (g_atomic_int_get (&add_matches), ==, 0);
+
+	/* Change the label through a different, unrelated proxy */
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	/* Which does have rules of its own */
+	g_assert_cmpint (g_atomic_int_get (&add_matches), >, 0);
+	g_dbus_connection_remove_filter (connection, filter);
+
+	g_signal_connect (shared, "g-properties-changed", G_CALLBACK (on_properties_changed_count), &changes);
+	g_signal_connect (shared, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	ret = secret_item_set_label_sync (item, "Another label", NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Arrives through the service's subscription, and only through that */
+	egg_test_wait ();
+	egg_test_wait_idle ();
+	g_assert_cmpuint (changes, ==, 1);
+
+	label = secret_item_get_label (shared);
+	g_assert_cmpstr (label, ==, "Another label");
+	g_free (label);
+
+	g_object_unref (item);
+	g_object_unref (other);
+	g_object_unref (shared);
+	g_object_unref (service);
+}
+
 static void
 test_set_label_async (Test *test,
                       gconstpointer unused)
@@ -463,6 +563,45 @@ test_set_attributes_sync (Test *test,
 	g_object_unref (item);
 }
 
+static void
+test_set_attributes_if_changed (Test *test,
+                                gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretItem *item;
+	gboolean written;
+	gboolean ret;
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "string", "five");
+	g_hash_table_insert (attributes, "number", "5");
+
+	ret = secret_item_set_attributes_if_changed_sync (item, &MOCK_SCHEMA, attributes, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	/* Same again, nothing written */
+	ret = secret_item_set_attributes_if_changed_sync (item, &MOCK_SCHEMA, attributes, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == FALSE);
+
+	g_hash_table_insert (attributes, "number", "6");
+	ret = secret_item_set_attributes_if_changed_sync (item, &MOCK_SCHEMA, attributes, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	g_hash_table_unref (attributes);
+	g_object_unref (item);
+}
+
 static void
 test_set_attributes_async (Test *test,
                            gconstpointer unused)
@@ -681,6 +820,116 @@ test_set_secret_sync (Test *test,
 	g_object_unref (item);
 }
 
+static void
+test_set_secret_if_changed (Test *test,
+                            gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GError *error = NULL;
+	SecretItem *item;
+	SecretValue *value;
+	gboolean written;
+	gboolean ret;
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	/* Secret not yet loaded, is loaded and compared */
+	value = secret_value_new ("111", -1, "text/plain");
+	ret = secret_item_set_secret_if_changed_sync (item, value, NULL, &written, &error);
+	secret_value_unref (value);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == FALSE);
+
+	value = secret_value_new ("Sinking", -1, "text/plain");
+	ret = secret_item_set_secret_if_changed_sync (item, value, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	ret = secret_item_set_secret_if_changed_sync (item, value, NULL, &written, &error);
+	secret_value_unref (value);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == FALSE);
+
+	/* A different content type is a change */
+	value = secret_value_new ("Sinking", -1, "strange/content-type");
+	ret = secret_item_set_secret_if_changed_sync (item, value, NULL, &written, &error);
+	secret_value_unref (value);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	g_object_unref (item);
+}
+
+static void
+test_secret_fd_sync (Test *test,
+                     gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GError *error = NULL;
+	SecretService *service;
+	SecretItem *item;
+	gconstpointer data;
+	SecretValue *value;
+	gchar *secret;
+	gboolean ret;
+	gsize length;
+	gsize i;
+
+	service = secret_service_get_sync (SECRET_SERVICE_FD_TRANSFER, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (service == test->service);
+
+	if (!(secret_service_get_flags (service) & SECRET_SERVICE_FD_TRANSFER)) {
+		g_test_skip ("passing secrets in memory files is not supported");
+		g_object_unref (service);
+		return;
+	}
+
+	/* Large enough to be passed in a memory file */
+	length = 70000;
+	secret = g_malloc (length);
+	for (i = 0; i < length; i++)
+		secret[i] = 'a' + (i % 26);
+	value = secret_value_new (secret, length, "strange/content-type");
+
+	item = secret_item_new_for_dbus_path_sync (service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	ret = secret_item_set_secret_sync (item, value, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	secret_value_unref (value);
+	g_object_unref (item);
+
+	/* The fd interface is still in use after setting the secret */
+	g_assert (secret_service_get_flags (service) & SECRET_SERVICE_FD_TRANSFER);
+
+	item = secret_item_new_for_dbus_path_sync (service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	ret = secret_item_load_secret_sync (item, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	value = secret_item_get_secret (item);
+	g_assert (value != NULL);
+
+	data = secret_value_get (value, &length);
+	egg_assert_cmpmem (data, length, ==, secret, 70000);
+	g_assert_cmpstr (secret_value_get_content_type (value), ==, "strange/content-type");
+	g_assert (secret_service_get_flags (service) & SECRET_SERVICE_FD_TRANSFER);
+
+	secret_value_unref (value);
+	g_object_unref (item);
+	g_object_unref (service);
+	g_free (secret);
+}
+
 static void
 test_secrets_sync (Test *test,
                    gconstpointer used)
@@ -866,12 +1115,16 @@ main (int argc, char **argv)
 	g_test_add ("/item/set-label-sync", Test, "mock-service-normal.py", setup, test_set_label_sync, teardown);
 	g_test_add ("/item/set-label-async", Test, "mock-service-normal.py", setup, test_set_label_async, teardown);
 	g_test_add ("/item/set-label-prop", Test, "mock-service-normal.py", setup, test_set_label_prop, teardown);
+	g_test_add ("/item/shared-signals", Test, "mock-service-normal.py", setup, test_shared_signals, teardown);
 	g_test_add ("/item/set-attributes-sync", Test, "mock-service-normal.py", setup, test_set_attributes_sync, teardown);
+	g_test_add ("/item/set-attributes-if-changed", Test, "mock-service-normal.py", setup, test_set_attributes_if_changed, teardown);
 	g_test_add ("/item/set-attributes-async", Test, "mock-service-normal.py", setup, test_set_attributes_async, teardown);
 	g_test_add ("/item/set-attributes-prop", Test, "mock-service-normal.py", setup, test_set_attributes_prop, teardown);
 	g_test_add ("/item/load-secret-sync", Test, "mock-service-normal.py", setup, test_load_secret_sync, teardown);
 	g_test_add ("/item/load-secret-async", Test, "mock-service-normal.py", setup, test_load_secret_async, teardown);
 	g_test_add ("/item/set-secret-sync", Test, "mock-service-normal.py", setup, test_set_secret_sync, teardown);
+	g_test_add ("/item/set-secret-if-changed", Test, "mock-service-normal.py", setup, test_set_secret_if_changed, teardown);
+	g_test_add ("/item/secret-fd-sync", Test, "mock-service-normal.py", setup, test_secret_fd_sync, teardown);
 	g_test_add ("/item/secrets-sync", Test, "mock-service-normal.py", setup, test_secrets_sync, teardown);
 	g_test_add ("/item/secrets-async", Test, "mock-service-normal.py", setup, test_secrets_async, teardown);
 	g_test_add ("/item/delete-sync", Test, "mock-service-normal.py", setup, test_delete_sync, teardown);
@@ -142,6 +142,47 @@ test_search_sync (Test *test,
 	g_list_free_full (items, g_object_unref);
 }
 
+static void
+test_search_reuses_items (Test *test,
+                          gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items, *again;
+	gpointer first;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (items != NULL);
+
+	/* While the first item is alive, the same proxy comes back */
+	again = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (again != NULL);
+	g_assert (again->data == items->data);
+	g_list_free_full (again, g_object_unref);
+
+	first = items->data;
+	g_object_add_weak_pointer (first, &first);
+	g_list_free_full (items, g_object_unref);
+	g_assert (first == NULL);
+
+	/* Once gone, a new one is created */
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (items != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_list_free_full (items, g_object_unref);
+
+	g_hash_table_unref (attributes);
+}
+
 static void
 test_search_async (Test *test,
                    gconstpointer used)
@@ -313,6 +354,56 @@ test_search_unlock_async (Test *test,
 	g_list_free_full (items, g_object_unref);
 }
 
+static void
+test_search_unlock_set (Test *test,
+                        gconstpointer used)
+{
+	GAsyncResult *first = NULL;
+	GAsyncResult *second = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+
+	/* Neither search knows what to unlock until after the set is ended */
+	secret_service_begin_unlock_set (test->service);
+	g_hash_table_insert (attributes, "number", "1");
+	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
+	                       SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK, NULL,
+	                       on_complete_get_result, &first);
+	g_hash_table_insert (attributes, "number", "2");
+	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
+	                       SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK, NULL,
+	                       on_complete_get_result, &second);
+	secret_service_end_unlock_set (test->service);
+	g_hash_table_unref (attributes);
+
+	while (first == NULL || second == NULL)
+		egg_test_wait ();
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Unlock",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	items = secret_service_search_finish (test->service, first, &error);
+	g_assert_no_error (error);
+	g_object_unref (first);
+
+	g_assert (items != NULL && items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_item_get_locked (items->next->data) == FALSE);
+	g_list_free_full (items, g_object_unref);
+
+	items = secret_service_search_finish (test->service, second, &error);
+	g_assert_no_error (error);
+	g_object_unref (second);
+
+	g_assert (items != NULL && items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/20");
+	g_assert (secret_item_get_locked (items->next->data) == FALSE);
+	g_list_free_full (items, g_object_unref);
+}
+
 static void
 test_search_secrets_sync (Test *test,
                           gconstpointer used)
@@ -574,6 +665,59 @@ test_clear_no_name (Test *test,
 	g_hash_table_unref (attributes);
 }
 
+static void
+test_clear_all_sync (Test *test,
+                     gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	gint count;
+
+	attributes = secret_attributes_build (&NO_NAME_SCHEMA,
+	                                      "string", "stale",
+	                                      NULL);
+
+	/* Every unlocked item, including the two that prompt */
+	count = secret_service_clear_all_sync (test->service, &NO_NAME_SCHEMA, attributes,
+	                                       4, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 52);
+
+	count = secret_service_clear_all_sync (test->service, &NO_NAME_SCHEMA, attributes,
+	                                       4, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 0);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_clear_all_async (Test *test,
+                      gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	GHashTable *attributes;
+	gint count;
+
+	attributes = secret_attributes_build (&NO_NAME_SCHEMA,
+	                                      "string", "stale",
+	                                      NULL);
+
+	secret_service_clear_all (test->service, &NO_NAME_SCHEMA, attributes, 0, NULL,
+	                          on_complete_get_result, &result);
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	count = secret_service_clear_all_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 52);
+
+	g_object_unref (result);
+}
+
 static void
 test_lookup_sync (Test *test,
                   gconstpointer used)
@@ -601,6 +745,200 @@ test_lookup_sync (Test *test,
 	secret_value_unref (value);
 }
 
+static void
+test_sync_context_reuse (void)
+{
+	GMainContext *context;
+	SecretSync *nested;
+	SecretSync *sync;
+
+	sync = _secret_sync_new ();
+	context = g_main_context_ref (sync->context);
+
+	/* A nested sync call must not share the context in use */
+	nested = _secret_sync_new ();
+	g_assert (nested->context != context);
+	_secret_sync_free (nested);
+	_secret_sync_free (sync);
+
+	/* But the next one on this thread does */
+	sync = _secret_sync_new ();
+	g_assert (sync->context == context);
+	_secret_sync_free (sync);
+
+	g_main_context_unref (context);
+}
+
+static void
+test_perf_sync_context (void)
+{
+	GMainContext *context;
+	SecretSync *sync;
+	GMainLoop *loop;
+	gdouble elapsed;
+	gint i;
+
+	/* What each sync call used to do */
+	g_test_timer_start ();
+	for (i = 0; i < 10000; i++) {
+		context = g_main_context_new ();
+		loop = g_main_loop_new (context, FALSE);
+		g_main_context_push_thread_default (context);
+		g_main_context_pop_thread_default (context);
+		while (g_main_context_iteration (context, FALSE));
+		g_main_loop_unref (loop);
+		g_main_context_unref (context);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed / 10000, "new sync context: %.3f usec", elapsed * 100);
+
+	g_test_timer_start ();
+	for (i = 0; i < 10000; i++) {
+		sync = _secret_sync_new ();
+		g_main_context_push_thread_default (sync->context);
+		g_main_context_pop_thread_default (sync->context);
+		_secret_sync_free (sync);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed / 10000, "cached sync context: %.3f usec", elapsed * 100);
+}
+
+static void
+test_perf_lookup_sync (Test *test,
+                       gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+	gdouble elapsed;
+	gint i;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
+	                                      NULL);
+
+	g_test_timer_start ();
+	for (i = 0; i < 200; i++) {
+		value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+		g_assert_no_error (error);
+		secret_value_unref (value);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed / 200, "sync lookup: %.3f ms", elapsed * 5);
+
+	g_hash_table_unref (attributes);
+}
+
+static gboolean
+on_busy_source (gpointer user_data)
+{
+	/* Stand in for an application doing some work in each iteration */
+	g_usleep (50);
+	return TRUE;
+}
+
+static void
+setup_bulk_perf (Test *test,
+                 gconstpointer data)
+{
+	g_setenv ("MOCK_BULK_ITEMS", "10000", TRUE);
+	setup (test, data);
+	g_unsetenv ("MOCK_BULK_ITEMS");
+}
+
+static void
+test_perf_clear_all (Test *test,
+                     gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	GHashTable *attributes;
+	gdouble elapsed;
+	gboolean ret;
+	gint count;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+
+	/* Half the items with secret_service_clear(), which sends every Delete at once */
+	g_hash_table_insert (attributes, "even", "true");
+	g_test_timer_start ();
+	secret_service_clear (test->service, NULL, attributes, NULL,
+	                      on_complete_get_result, &result);
+	egg_test_wait ();
+	ret = secret_service_clear_finish (test->service, result, &error);
+	elapsed = g_test_timer_elapsed ();
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_clear_object (&result);
+
+	g_test_minimized_result (elapsed / 5000, "clear all at once: %.3f ms per item",
+	                         elapsed * 1000 / 5000);
+
+	/* And the other half with a window of Delete calls in flight */
+	g_hash_table_insert (attributes, "even", "false");
+	g_test_timer_start ();
+	secret_service_clear_all (test->service, NULL, attributes, 0, NULL,
+	                          on_complete_get_result, &result);
+	egg_test_wait ();
+	count = secret_service_clear_all_finish (test->service, result, &error);
+	elapsed = g_test_timer_elapsed ();
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 5000);
+	g_clear_object (&result);
+
+	g_test_minimized_result (elapsed / count, "clear windowed: %.3f ms per item",
+	                         elapsed * 1000 / count);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_perf_lookup_async (Test *test,
+                        gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+	guint sources[20];
+	gdouble elapsed;
+	guint i;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
+	                                      NULL);
+
+	/* Every extra main loop iteration a lookup needs costs about a millisecond */
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		sources[i] = g_idle_add_full (G_PRIORITY_DEFAULT, on_busy_source, NULL, NULL);
+
+	g_test_timer_start ();
+	for (i = 0; i < 100; i++) {
+		secret_service_lookup (NULL, &MOCK_SCHEMA, attributes, NULL,
+		                       on_complete_get_result, &result);
+		egg_test_wait ();
+
+		value = secret_service_lookup_finish (NULL, result, &error);
+		g_assert_no_error (error);
+		secret_value_unref (value);
+		g_clear_object (&result);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	g_test_minimized_result (elapsed / 100, "async lookup on a busy main loop: %.3f ms", elapsed * 10);
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		g_source_remove (sources[i]);
+	g_hash_table_unref (attributes);
+}
+
 static void
 test_lookup_async (Test *test,
                    gconstpointer used)
@@ -765,6 +1103,57 @@ test_store_sync (Test *test,
 	g_strfreev (paths);
 }
 
+static void
+test_store_if_changed (Test *test,
+                       gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretValue *value = secret_value_new ("apassword", -1, "text/plain");
+	GHashTable *attributes;
+	GError *error = NULL;
+	gboolean written;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "seventeen",
+	                                      "number", 17,
+	                                      NULL);
+
+	ret = secret_service_store_if_changed_sync (test->service, &MOCK_SCHEMA, attributes, collection_path,
+	                                            "New Item Label", value, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	/* Exactly the same, nothing written */
+	ret = secret_service_store_if_changed_sync (test->service, &MOCK_SCHEMA, attributes, collection_path,
+	                                            "New Item Label", value, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == FALSE);
+
+	/* Label changed, so stored again */
+	ret = secret_service_store_if_changed_sync (test->service, &MOCK_SCHEMA, attributes, collection_path,
+	                                            "Another Label", value, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	secret_value_unref (value);
+
+	/* Secret changed, so stored again */
+	value = secret_value_new ("another", -1, "text/plain");
+	ret = secret_service_store_if_changed_sync (test->service, &MOCK_SCHEMA, attributes, collection_path,
+	                                            "Another Label", value, NULL, &written, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (written == TRUE);
+
+	secret_value_unref (value);
+	g_hash_table_unref (attributes);
+}
+
 static void
 test_store_replace (Test *test,
                     gconstpointer used)
@@ -965,10 +1354,12 @@ main (int argc, char **argv)
 
 	g_test_add ("/service/search-sync", Test, "mock-service-normal.py", setup, test_search_sync, teardown);
 	g_test_add ("/service/search-async", Test, "mock-service-normal.py", setup, test_search_async, teardown);
+	g_test_add ("/service/search-reuses-items", Test, "mock-service-normal.py", setup, test_search_reuses_items, teardown);
 	g_test_add ("/service/search-all-sync", Test, "mock-service-normal.py", setup, test_search_all_sync, teardown);
 	g_test_add ("/service/search-all-async", Test, "mock-service-normal.py", setup, test_search_all_async, teardown);
 	g_test_add ("/service/search-unlock-sync", Test, "mock-service-normal.py", setup, test_search_unlock_sync, teardown);
 	g_test_add ("/service/search-unlock-async", Test, "mock-service-normal.py", setup, test_search_unlock_async, teardown);
+	g_test_add ("/service/search-unlock-set", Test, "mock-service-normal.py", setup, test_search_unlock_set, teardown);
 	g_test_add ("/service/search-secrets-sync", Test, "mock-service-normal.py", setup, test_search_secrets_sync, teardown);
 	g_test_add ("/service/search-secrets-async", Test, "mock-service-normal.py", setup, test_search_secrets_async, teardown);
 
@@ -976,6 +1367,8 @@ main (int argc, char **argv)
 
 	g_test_add ("/service/unlock-sync", Test, "mock-service-lock.py", setup, test_unlock_sync, teardown);
 
+	g_test_add_func ("/service/sync-context-reuse", test_sync_context_reuse);
+
 	g_test_add ("/service/lookup-sync", Test, "mock-service-normal.py", setup, test_lookup_sync, teardown);
 	g_test_add ("/service/lookup-async", Test, "mock-service-normal.py", setup, test_lookup_async, teardown);
 	g_test_add ("/service/lookup-locked", Test, "mock-service-normal.py", setup, test_lookup_locked, teardown);
@@ -987,13 +1380,23 @@ main (int argc, char **argv)
 	g_test_add ("/service/clear-locked", Test, "mock-service-delete.py", setup, test_clear_locked, teardown);
 	g_test_add ("/service/clear-no-match", Test, "mock-service-delete.py", setup, test_clear_no_match, teardown);
 	g_test_add ("/service/clear-no-name", Test, "mock-service-delete.py", setup, test_clear_no_name, teardown);
+	g_test_add ("/service/clear-all-sync", Test, "mock-service-bulk.py", setup, test_clear_all_sync, teardown);
+	g_test_add ("/service/clear-all-async", Test, "mock-service-bulk.py", setup, test_clear_all_async, teardown);
 
 	g_test_add ("/service/store-sync", Test, "mock-service-normal.py", setup, test_store_sync, teardown);
+	g_test_add ("/service/store-if-changed", Test, "mock-service-normal.py", setup, test_store_if_changed, teardown);
 	g_test_add ("/service/store-async", Test, "mock-service-normal.py", setup, test_store_async, teardown);
 	g_test_add ("/service/store-replace", Test, "mock-service-normal.py", setup, test_store_replace, teardown);
 	g_test_add ("/service/store-no-default", Test, "mock-service-empty.py", setup, test_store_no_default, teardown);
 
 	g_test_add ("/service/set-alias-sync", Test, "mock-service-normal.py", setup, test_set_alias_sync, teardown);
 
+	if (g_test_perf ()) {
+		g_test_add_func ("/service/perf/sync-context", test_perf_sync_context);
+		g_test_add ("/service/perf/lookup-sync", Test, "mock-service-normal.py", setup, test_perf_lookup_sync, teardown);
+		g_test_add ("/service/perf/lookup-async", Test, "mock-service-normal.py", setup, test_perf_lookup_async, teardown);
+		g_test_add ("/service/perf/clear-all", Test, "mock-service-bulk.py", setup_bulk_perf, test_perf_clear_all, teardown);
+	}
+
 	return egg_tests_run_with_loop ();
 }
@@ -532,6 +532,265 @@ test_unlock_prompt_sync (Test *test,
 	g_strfreev (unlocked);
 }
 
+static void
+on_complete_count (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GPtrArray *results = user_data;
+	g_ptr_array_add (results, g_object_ref (result));
+	egg_test_wait_stop ();
+}
+
+static void
+test_unlock_coalesce (Test *test,
+                      gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockprompt";
+	const gchar *paths[] = {
+		collection_path,
+		NULL,
+	};
+
+	GError *error = NULL;
+	GPtrArray *results;
+	gchar **unlocked;
+	gint count;
+	guint i;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* Both of these should share one Unlock call and one prompt */
+	secret_service_unlock_dbus_paths (test->service, paths, NULL,
+	                                  on_complete_count, results);
+	secret_service_unlock_dbus_paths (test->service, paths, NULL,
+	                                  on_complete_count, results);
+	g_assert_cmpuint (results->len, ==, 0);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Unlock",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Prompt",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	for (i = 0; i < results->len; i++) {
+		unlocked = NULL;
+		count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[i],
+		                                                 &unlocked, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (count, ==, 1);
+		g_assert (unlocked != NULL);
+		g_assert_cmpstr (unlocked[0], ==, collection_path);
+		g_assert (unlocked[1] == NULL);
+		g_strfreev (unlocked);
+	}
+
+	g_ptr_array_unref (results);
+}
+
+static void
+test_lock_coalesce_cancel (Test *test,
+                           gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockone";
+	const gchar *paths[] = {
+		collection_path,
+		NULL,
+	};
+
+	GCancellable *cancellable;
+	GError *error = NULL;
+	GPtrArray *results;
+	gchar **locked;
+	gint count;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+	cancellable = g_cancellable_new ();
+
+	/* The second caller joins the first call, and then gives up on it */
+	secret_service_lock_dbus_paths (test->service, paths, NULL,
+	                                on_complete_count, results);
+	secret_service_lock_dbus_paths (test->service, paths, cancellable,
+	                                on_complete_count, results);
+	g_cancellable_cancel (cancellable);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Lock",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	/* The cancelled caller completes first, without waiting for the call */
+	count = secret_service_lock_dbus_paths_finish (test->service, results->pdata[0],
+	                                               NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_cmpint (count, ==, -1);
+	g_clear_error (&error);
+
+	locked = NULL;
+	count = secret_service_lock_dbus_paths_finish (test->service, results->pdata[1],
+	                                               &locked, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
+	g_assert_cmpstr (locked[0], ==, collection_path);
+	g_assert (locked[1] == NULL);
+	g_strfreev (locked);
+
+	g_object_unref (cancellable);
+	g_ptr_array_unref (results);
+}
+
+static void
+test_unlock_set (Test *test,
+                 gconstpointer used)
+{
+	const gchar *prompt_path = "/org/freedesktop/secrets/collection/lockprompt";
+	const gchar *spanish_path = "/org/freedesktop/secrets/collection/spanish";
+	const gchar *first[] = { prompt_path, NULL };
+	const gchar *second[] = { spanish_path, NULL };
+
+	GError *error = NULL;
+	GPtrArray *results;
+	gchar **unlocked;
+	gint count;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* Different collections, but still only one Unlock call */
+	secret_service_begin_unlock_set (test->service);
+	secret_service_unlock_dbus_paths (test->service, first, NULL,
+	                                  on_complete_count, results);
+	secret_service_unlock_dbus_paths (test->service, second, NULL,
+	                                  on_complete_count, results);
+	secret_service_end_unlock_set (test->service);
+	g_assert_cmpuint (results->len, ==, 0);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Unlock",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	/* Each caller only hears about what it asked for */
+	unlocked = NULL;
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[0],
+	                                                 &unlocked, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
+	g_assert_cmpstr (unlocked[0], ==, prompt_path);
+	g_strfreev (unlocked);
+
+	unlocked = NULL;
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[1],
+	                                                 &unlocked, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
+	g_assert_cmpstr (unlocked[0], ==, spanish_path);
+	g_strfreev (unlocked);
+
+	g_ptr_array_unref (results);
+}
+
+static void
+test_unlock_set_cancel (Test *test,
+                        gconstpointer used)
+{
+	const gchar *prompt_path = "/org/freedesktop/secrets/collection/lockprompt";
+	const gchar *spanish_path = "/org/freedesktop/secrets/collection/spanish";
+	const gchar *first[] = { prompt_path, NULL };
+	const gchar *second[] = { spanish_path, NULL };
+
+	GCancellable *cancellable;
+	GError *error = NULL;
+	GPtrArray *results;
+	gchar **unlocked;
+	gint count;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+	cancellable = g_cancellable_new ();
+
+	secret_service_begin_unlock_set (test->service);
+	secret_service_unlock_dbus_paths (test->service, first, cancellable,
+	                                  on_complete_count, results);
+	secret_service_unlock_dbus_paths (test->service, second, NULL,
+	                                  on_complete_count, results);
+	secret_service_end_unlock_set (test->service);
+
+	/* Only the first member gives up, the call carries on for the second */
+	g_cancellable_cancel (cancellable);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Unlock",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[0],
+	                                                 NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_cmpint (count, ==, -1);
+	g_clear_error (&error);
+
+	unlocked = NULL;
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[1],
+	                                                 &unlocked, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
+	g_assert_cmpstr (unlocked[0], ==, spanish_path);
+	g_strfreev (unlocked);
+
+	g_object_unref (cancellable);
+	g_ptr_array_unref (results);
+}
+
+static void
+test_unlock_set_stale (Test *test,
+                       gconstpointer used)
+{
+	const gchar *spanish_path = "/org/freedesktop/secrets/collection/spanish";
+	const gchar *first[] = { spanish_path, NULL };
+	const gchar *second[] = { "/org/freedesktop/stale", NULL };
+
+	GError *error = NULL;
+	GPtrArray *results;
+	gchar **unlocked;
+	gint count;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	secret_service_begin_unlock_set (test->service);
+	secret_service_unlock_dbus_paths (test->service, first, NULL,
+	                                  on_complete_count, results);
+	secret_service_unlock_dbus_paths (test->service, second, NULL,
+	                                  on_complete_count, results);
+	secret_service_end_unlock_set (test->service);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	/* The combined call fails, and then each member is tried on its own */
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "Unlock",
+	                                                 NULL, NULL, NULL, NULL), ==, 3);
+
+	unlocked = NULL;
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[0],
+	                                                 &unlocked, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
+	g_assert_cmpstr (unlocked[0], ==, spanish_path);
+	g_strfreev (unlocked);
+
+	count = secret_service_unlock_dbus_paths_finish (test->service, results->pdata[1],
+	                                                 NULL, &error);
+	g_assert (error != NULL);
+	g_assert_cmpint (count, ==, -1);
+	g_clear_error (&error);
+
+	g_ptr_array_unref (results);
+}
+
 static void
 test_collection_sync (Test *test,
                       gconstpointer used)
@@ -710,6 +969,53 @@ test_set_alias_path (Test *test,
 	g_assert (path == NULL);
 }
 
+static void
+test_read_alias_cached (Test *test,
+                        gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	gboolean ret;
+	gchar *path;
+
+	secret_service_reset_call_stats (test->service);
+
+	path = secret_service_read_alias_dbus_path_sync (test->service, "default", NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (path, ==, "/org/freedesktop/secrets/collection/english");
+	g_free (path);
+
+	/* Answered without asking the service again */
+	secret_service_read_alias_dbus_path (test->service, "default", NULL,
+	                                     on_complete_get_result, &result);
+	g_assert (result == NULL);
+	egg_test_wait ();
+
+	path = secret_service_read_alias_dbus_path_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (path, ==, "/org/freedesktop/secrets/collection/english");
+	g_object_unref (result);
+	g_free (path);
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "ReadAlias",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+
+	/* Setting the alias updates what is remembered */
+	ret = secret_service_set_alias_to_dbus_path_sync (test->service, "default",
+	                                                  "/org/freedesktop/secrets/collection/spanish",
+	                                                  NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	path = secret_service_read_alias_dbus_path_sync (test->service, "default", NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (path, ==, "/org/freedesktop/secrets/collection/spanish");
+	g_free (path);
+
+	g_assert_cmpuint (secret_service_get_call_stats (test->service, "ReadAlias",
+	                                                 NULL, NULL, NULL, NULL), ==, 1);
+}
+
 static void
 test_encode_decode_secret (Test *test,
                            gconstpointer unused)
@@ -764,6 +1070,11 @@ main (int argc, char **argv)
 
 	g_test_add ("/service/unlock-paths-sync", Test, "mock-service-lock.py", setup, test_unlock_paths_sync, teardown);
 	g_test_add ("/service/unlock-prompt-sync", Test, "mock-service-lock.py", setup, test_unlock_prompt_sync, teardown);
+	g_test_add ("/service/unlock-coalesce", Test, "mock-service-lock.py", setup, test_unlock_coalesce, teardown);
+	g_test_add ("/service/lock-coalesce-cancel", Test, "mock-service-lock.py", setup, test_lock_coalesce_cancel, teardown);
+	g_test_add ("/service/unlock-set", Test, "mock-service-lock.py", setup, test_unlock_set, teardown);
+	g_test_add ("/service/unlock-set-cancel", Test, "mock-service-lock.py", setup, test_unlock_set_cancel, teardown);
+	g_test_add ("/service/unlock-set-stale", Test, "mock-service-lock.py", setup, test_unlock_set_stale, teardown);
 
 	g_test_add ("/service/create-collection-sync", Test, "mock-service-normal.py", setup, test_collection_sync, teardown);
 	g_test_add ("/service/create-collection-async", Test, "mock-service-normal.py", setup, test_collection_async, teardown);
@@ -772,6 +1083,7 @@ main (int argc, char **argv)
 	g_test_add ("/service/create-item-async", Test, "mock-service-normal.py", setup, test_item_async, teardown);
 
 	g_test_add ("/service/set-alias-path", Test, "mock-service-normal.py", setup, test_set_alias_path, teardown);
+	g_test_add ("/service/read-alias-cached", Test, "mock-service-normal.py", setup, test_read_alias_cached, teardown);
 
 	g_test_add ("/service/encode-decode-secret", Test, "mock-service-normal.py", setup, test_encode_decode_secret, teardown);
 
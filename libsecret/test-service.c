@@ -582,6 +582,259 @@ test_ensure_async (Test *test,
 	g_assert (service == NULL);
 }
 
+static void
+check_loaded_collections (SecretService *service)
+{
+	SecretCollection *collection;
+	GList *collections;
+	GList *items;
+	GList *l;
+	gboolean found = FALSE;
+
+	g_assert (secret_service_get_flags (service) & SECRET_SERVICE_LOAD_COLLECTIONS);
+
+	collections = secret_service_get_collections (service);
+	g_assert_cmpuint (g_list_length (collections), ==, 5);
+
+	for (l = collections; l != NULL; l = g_list_next (l)) {
+		collection = l->data;
+		g_assert (secret_collection_get_flags (collection) & SECRET_COLLECTION_LOAD_ITEMS);
+
+		if (!g_str_equal (g_dbus_proxy_get_object_path (l->data),
+		                  "/org/freedesktop/secrets/collection/english"))
+			continue;
+
+		found = TRUE;
+		g_assert_cmpstr (secret_collection_get_label (collection), ==, "Collection One");
+		g_assert (secret_collection_get_locked (collection) == FALSE);
+
+		items = secret_collection_get_items (collection);
+		g_assert_cmpuint (g_list_length (items), ==, 3);
+		g_list_free_full (items, g_object_unref);
+	}
+
+	g_assert (found);
+	g_list_free_full (collections, g_object_unref);
+}
+
+static void
+test_load_collections_sync (Test *test,
+                            gconstpointer data)
+{
+	SecretService *service;
+	GError *error = NULL;
+	gboolean ret;
+
+	service = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_NONE,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_object_add_weak_pointer (G_OBJECT (service), (gpointer *)&service);
+
+	ret = secret_service_load_collections_sync (service, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	check_loaded_collections (service);
+
+	g_object_unref (service);
+	g_assert (service == NULL);
+}
+
+static void
+test_load_collections_async (Test *test,
+                             gconstpointer data)
+{
+	GAsyncResult *result = NULL;
+	SecretService *service;
+	GError *error = NULL;
+	gboolean ret;
+
+	service = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_NONE,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_object_add_weak_pointer (G_OBJECT (service), (gpointer *)&service);
+
+	secret_service_load_collections (service, NULL, on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	ret = secret_service_load_collections_finish (service, result, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_object_unref (result);
+
+	check_loaded_collections (service);
+
+	g_object_unref (service);
+	g_assert (service == NULL);
+}
+
+typedef struct {
+	GThread *thread;
+	GPtrArray *methods;
+	guint failed;
+} CallRecord;
+
+static void
+on_service_call (SecretService *service,
+                 const gchar *method,
+                 gint64 elapsed,
+                 gboolean failed,
+                 gpointer user_data)
+{
+	CallRecord *record = user_data;
+
+	g_assert (elapsed >= 0);
+	g_assert (record->thread == g_thread_self ());
+
+	g_ptr_array_add (record->methods, g_strdup (method));
+	if (failed)
+		record->failed++;
+}
+
+static void
+test_call_stats (Test *test,
+                 gconstpointer data)
+{
+	guint64 histogram[SECRET_SERVICE_CALL_HISTOGRAM_SIZE];
+	CallRecord record = { NULL, NULL, 0 };
+	SecretService *service;
+	GError *error = NULL;
+	GVariant *retval;
+	gchar **methods;
+	guint64 errors;
+	gint64 total_time;
+	gint64 max_time;
+	guint64 calls;
+	guint64 sum;
+	guint i;
+
+	service = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_OPEN_SESSION,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+
+	calls = secret_service_get_call_stats (service, "OpenSession", &errors,
+	                                       &total_time, &max_time, histogram);
+	g_assert_cmpuint (calls, ==, 1);
+	g_assert_cmpuint (errors, ==, 0);
+	g_assert_cmpint (max_time, ==, total_time);
+	for (i = 0, sum = 0; i < SECRET_SERVICE_CALL_HISTOGRAM_SIZE; i++)
+		sum += histogram[i];
+	g_assert_cmpuint (sum, ==, 1);
+
+	methods = secret_service_get_call_methods (service);
+	g_assert (methods != NULL);
+	g_assert (g_strv_length (methods) >= 1);
+	g_strfreev (methods);
+
+	record.thread = g_thread_self ();
+	record.methods = g_ptr_array_new_with_free_func (g_free);
+	secret_service_set_call_func (service, on_service_call, &record, NULL);
+
+	retval = g_dbus_proxy_call_sync (G_DBUS_PROXY (service), "SearchItems",
+	                                 g_variant_new ("(@a{ss})", g_variant_new_array (G_VARIANT_TYPE ("{ss}"), NULL, 0)),
+	                                 G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+
+	retval = g_dbus_proxy_call_sync (G_DBUS_PROXY (service), "NoSuchMethod", NULL,
+	                                 G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert (retval == NULL);
+	g_clear_error (&error);
+
+	/* The function runs in this thread's main context, not the D-Bus thread */
+	g_assert_cmpuint (record.methods->len, ==, 0);
+	while (record.methods->len < 2)
+		g_main_context_iteration (NULL, TRUE);
+	g_assert_cmpstr (record.methods->pdata[0], ==, "SearchItems");
+	g_assert_cmpstr (record.methods->pdata[1], ==, "NoSuchMethod");
+	g_assert_cmpuint (record.failed, ==, 1);
+
+	calls = secret_service_get_call_stats (service, "NoSuchMethod", &errors, NULL, NULL, NULL);
+	g_assert_cmpuint (calls, ==, 1);
+	g_assert_cmpuint (errors, ==, 1);
+
+	secret_service_reset_call_stats (service);
+	calls = secret_service_get_call_stats (service, "SearchItems", NULL, NULL, NULL, NULL);
+	g_assert_cmpuint (calls, ==, 0);
+
+	secret_service_set_call_func (service, NULL, NULL, NULL);
+	g_object_unref (service);
+
+	g_ptr_array_unref (record.methods);
+}
+
+static void
+test_open_for_connection_sync (Test *test,
+                               gconstpointer data)
+{
+	GDBusConnection *connection;
+	SecretService *service;
+	GError *error = NULL;
+
+	connection = g_dbus_connection_new_for_address_sync (mock_service_get_p2p_address (),
+	                                                     G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+	                                                     NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	service = secret_service_open_for_connection_sync (SECRET_TYPE_SERVICE, connection, NULL,
+	                                                   SECRET_SERVICE_LOAD_COLLECTIONS |
+	                                                   SECRET_SERVICE_OPEN_SESSION,
+	                                                   NULL, &error);
+	g_assert_no_error (error);
+	g_assert (SECRET_IS_SERVICE (service));
+	g_object_add_weak_pointer (G_OBJECT (service), (gpointer *)&service);
+
+	g_assert (g_dbus_proxy_get_connection (G_DBUS_PROXY (service)) == connection);
+	g_assert (g_dbus_proxy_get_name (G_DBUS_PROXY (service)) == NULL);
+	g_assert (secret_service_get_session_dbus_path (service) != NULL);
+	check_loaded_collections (service);
+
+	g_object_unref (service);
+	g_assert (service == NULL);
+
+	g_dbus_connection_close_sync (connection, NULL, NULL);
+	g_object_unref (connection);
+}
+
+static void
+test_open_for_connection_async (Test *test,
+                                gconstpointer data)
+{
+	GDBusConnection *connection;
+	GAsyncResult *result = NULL;
+	SecretService *service;
+	GError *error = NULL;
+
+	connection = g_dbus_connection_new_for_address_sync (mock_service_get_p2p_address (),
+	                                                     G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+	                                                     NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	secret_service_open_for_connection (SECRET_TYPE_SERVICE, connection, NULL,
+	                                    SECRET_SERVICE_LOAD_COLLECTIONS | SECRET_SERVICE_OPEN_SESSION,
+	                                    NULL, on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	service = secret_service_open_finish (result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+	g_object_add_weak_pointer (G_OBJECT (service), (gpointer *)&service);
+
+	g_assert (g_dbus_proxy_get_connection (G_DBUS_PROXY (service)) == connection);
+	g_assert (secret_service_get_session_dbus_path (service) != NULL);
+	check_loaded_collections (service);
+
+	g_object_unref (service);
+	g_assert (service == NULL);
+
+	g_dbus_connection_close_sync (connection, NULL, NULL);
+	g_object_unref (connection);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -606,5 +859,15 @@ main (int argc, char **argv)
 	g_test_add ("/service/ensure-sync", Test, "mock-service-normal.py", setup_mock, test_ensure_sync, teardown_mock);
 	g_test_add ("/service/ensure-async", Test, "mock-service-normal.py", setup_mock, test_ensure_async, teardown_mock);
 
+	g_test_add ("/service/load-collections-sync", Test, "mock-service-normal.py", setup_mock, test_load_collections_sync, teardown_mock);
+	g_test_add ("/service/load-collections-async", Test, "mock-service-normal.py", setup_mock, test_load_collections_async, teardown_mock);
+	g_test_add ("/service/load-collections-fallback-sync", Test, "mock-service-no-object-manager.py", setup_mock, test_load_collections_sync, teardown_mock);
+	g_test_add ("/service/load-collections-fallback-async", Test, "mock-service-no-object-manager.py", setup_mock, test_load_collections_async, teardown_mock);
+
+	g_test_add ("/service/open-for-connection-sync", Test, "mock-service-normal.py", setup_mock, test_open_for_connection_sync, teardown_mock);
+	g_test_add ("/service/open-for-connection-async", Test, "mock-service-normal.py", setup_mock, test_open_for_connection_async, teardown_mock);
+
+	g_test_add ("/service/call-stats", Test, "mock-service-normal.py", setup_mock, test_call_stats, teardown_mock);
+
 	return egg_tests_run_with_loop ();
 }
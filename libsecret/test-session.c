@@ -214,6 +214,121 @@ test_ensure_async_twice (Test *test,
 	g_free (path);
 }
 
+static void
+on_complete_count (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GPtrArray *results = user_data;
+	g_ptr_array_add (results, g_object_ref (result));
+	egg_test_wait_stop ();
+}
+
+static void
+test_ensure_async_concurrent (Test *test,
+                              gconstpointer unused)
+{
+	GPtrArray *results;
+	GError *error = NULL;
+	gboolean ret;
+	guint i;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = 0; i < 5; i++)
+		secret_service_ensure_session (test->service, NULL, on_complete_count, results);
+
+	while (results->len < 5)
+		egg_test_wait ();
+
+	for (i = 0; i < results->len; i++) {
+		ret = secret_service_ensure_session_finish (test->service, results->pdata[i], &error);
+		g_assert_no_error (error);
+		g_assert (ret == TRUE);
+	}
+
+	/* Only one session should have been negotiated */
+	g_assert_cmpuint (secret_service_get_session_negotiations (test->service), ==, 1);
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
+
+	g_ptr_array_unref (results);
+}
+
+static void
+test_ensure_async_cancel_waiter (Test *test,
+                                 gconstpointer unused)
+{
+	GCancellable *cancellable;
+	GPtrArray *results;
+	GError *error = NULL;
+	gboolean ret;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+	cancellable = g_cancellable_new ();
+
+	/* The second caller waits on the first negotiation, and then gives up */
+	secret_service_ensure_session (test->service, NULL, on_complete_count, results);
+	secret_service_ensure_session (test->service, cancellable, on_complete_count, results);
+	g_cancellable_cancel (cancellable);
+
+	while (results->len < 2)
+		egg_test_wait ();
+
+	/* The cancelled caller completes first, without waiting */
+	ret = secret_service_ensure_session_finish (test->service, results->pdata[0], &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert (ret == FALSE);
+	g_clear_error (&error);
+
+	ret = secret_service_ensure_session_finish (test->service, results->pdata[1], &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_assert_cmpuint (secret_service_get_session_negotiations (test->service), ==, 1);
+
+	g_object_unref (cancellable);
+	g_ptr_array_unref (results);
+}
+
+static gboolean
+on_tick (gpointer user_data)
+{
+	guint *ticks = user_data;
+	(*ticks)++;
+	return TRUE;
+}
+
+static void
+test_ensure_async_responsive (Test *test,
+                              gconstpointer unused)
+{
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	gboolean ret;
+	guint ticks = 0;
+	guint source;
+
+	/* Competes with the session setup at the same priority */
+	source = g_idle_add_full (G_PRIORITY_DEFAULT, on_tick, &ticks, NULL);
+
+	secret_service_ensure_session (test->service, NULL, on_complete_get_result, &result);
+	g_assert (result == NULL);
+	egg_test_wait ();
+
+	g_source_remove (source);
+
+	g_assert (G_IS_ASYNC_RESULT (result));
+	ret = secret_service_ensure_session_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+
+	/* The main loop kept running other sources while the session was set up */
+	g_assert_cmpuint (ticks, >, 0);
+
+	g_object_unref (result);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -229,6 +344,9 @@ main (int argc, char **argv)
 	g_test_add ("/session/ensure-async-aes", Test, "mock-service-normal.py", setup, test_ensure_async_aes, teardown);
 	g_test_add ("/session/ensure-async-plain", Test, "mock-service-only-plain.py", setup, test_ensure_async_plain, teardown);
 	g_test_add ("/session/ensure-async-twice", Test, "mock-service-only-plain.py", setup, test_ensure_async_twice, teardown);
+	g_test_add ("/session/ensure-async-responsive", Test, "mock-service-normal.py", setup, test_ensure_async_responsive, teardown);
+	g_test_add ("/session/ensure-async-concurrent", Test, "mock-service-normal.py", setup, test_ensure_async_concurrent, teardown);
+	g_test_add ("/session/ensure-async-cancel-waiter", Test, "mock-service-normal.py", setup, test_ensure_async_cancel_waiter, teardown);
 
 	return egg_tests_run_with_loop ();
 }